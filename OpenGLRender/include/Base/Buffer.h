@@ -24,13 +24,18 @@ class Buffer {
   }
 
   virtual inline size_t convertIndex(size_t x, size_t y) const {
-    return x + y * innerWidth_;
+    return layoutIndex(x, y, innerWidth_);
   }
 
-  /*virtual BufferLayout getLayout() const {
+  // 非虚的坐标转换，按布局模板化的采样代码可以直接内联寻址
+  static inline size_t layoutIndex(size_t x, size_t y, size_t innerWidth) {
+    return x + y * innerWidth;
+  }
+
+  virtual BufferLayout getLayout() const {
     return Layout_Linear;
-  }*/
-  
+  }
+
 
   //分配内存并初始化布局。
   void create(size_t w, size_t h, const uint8_t *data = nullptr) {
@@ -80,6 +85,10 @@ class Buffer {
     return height_;
   }
 
+  inline size_t getInnerWidth() const {
+    return innerWidth_;
+  }
+
   //返回坐标(x, y) 处数据的指针。
   inline T *get(size_t x, size_t y) {
     T *ptr = data_.get();
@@ -119,12 +128,43 @@ class Buffer {
     }
   }
 
-  //遍历缓冲区，将所有元素设为 val。
+  //将所有元素设为 val，整块填充使用非临时存储。
   inline void setAll(T val) const {
     T *ptr = data_.get();
     if (ptr != nullptr) {
-      for (int i = 0; i < dataSize_; i++) {
-        ptr[i] = val;
+      MemoryUtils::fill(ptr, dataSize_, val, true);
+      MemoryUtils::streamFence();
+    }
+  }
+
+  //将[x0, x1) x [y0, y1)范围内的元素设为 val，stream见MemoryUtils::fill。
+  void setRect(size_t x0, size_t y0, size_t x1, size_t y1, const T &val, bool stream) {
+    T *ptr = data_.get();
+    if (ptr == nullptr) {
+      return;
+    }
+    x1 = std::min(x1, width_);
+    y1 = std::min(y1, height_);
+    if (x0 >= x1 || y0 >= y1) {
+      return;
+    }
+    if (getLayout() == Layout_Linear) {
+      // 整行范围在内存中连续，一次填充
+      if (x0 == 0 && x1 == innerWidth_) {
+        MemoryUtils::fill(ptr + layoutIndex(0, y0, innerWidth_), (y1 - y0) * innerWidth_, val, stream);
+        y0 = y1;
+      }
+      for (size_t y = y0; y < y1; y++) {
+        MemoryUtils::fill(ptr + layoutIndex(x0, y, innerWidth_), x1 - x0, val, stream);
+      }
+      if (stream) {
+        MemoryUtils::streamFence();
+      }
+      return;
+    }
+    for (size_t y = y0; y < y1; y++) {
+      for (size_t x = x0; x < x1; x++) {
+        ptr[convertIndex(x, y)] = val;
       }
     }
   }
@@ -150,12 +190,16 @@ public:
 }
 
     inline size_t convertIndex(size_t x, size_t y) const override {
-        uint16_t tileX = x >> bits_;              // x / tileSize_
-        uint16_t tileY = y >> bits_;              // y / tileSize_
-        uint16_t inTileX = x & (tileSize_ - 1);   // x % tileSize_
-        uint16_t inTileY = y & (tileSize_ - 1);   // y % tileSize_
+        return layoutIndex(x, y, this->innerWidth_);
+    }
+
+    static inline size_t layoutIndex(size_t x, size_t y, size_t innerWidth) {
+        size_t tileX = x >> bits_;              // x / tileSize_
+        size_t tileY = y >> bits_;              // y / tileSize_
+        size_t inTileX = x & (tileSize_ - 1);   // x % tileSize_
+        size_t inTileY = y & (tileSize_ - 1);   // y % tileSize_
 
-        return ((tileY * tileWidth_ + tileX) << bits_ << bits_) + (inTileY << bits_) + inTileX;
+        return ((tileY * (innerWidth >> bits_) + tileX) << bits_ << bits_) + (inTileY << bits_) + inTileX;
     }
 
     BufferLayout getLayout() const override {
@@ -192,14 +236,18 @@ public:
     }
 
     inline size_t convertIndex(size_t x, size_t y) const override {
-        uint16_t tileX = x >> bits_;              // x / tileSize_
-        uint16_t tileY = y >> bits_;              // y / tileSize_
-        uint16_t inTileX = x & (tileSize_ - 1);   // x % tileSize_
-        uint16_t inTileY = y & (tileSize_ - 1);   // y % tileSize_
+        return layoutIndex(x, y, this->innerWidth_);
+    }
+
+    static inline size_t layoutIndex(size_t x, size_t y, size_t innerWidth) {
+        size_t tileX = x >> bits_;              // x / tileSize_
+        size_t tileY = y >> bits_;              // y / tileSize_
+        uint8_t inTileX = x & (tileSize_ - 1);  // x % tileSize_
+        uint8_t inTileY = y & (tileSize_ - 1);  // y % tileSize_
 
         uint16_t mortonIndex = encode16_morton2(inTileX, inTileY);
 
-        return ((tileY * tileWidth_ + tileX) << bits_ << bits_) + mortonIndex;
+        return ((tileY * (innerWidth >> bits_) + tileX) << bits_ << bits_) + mortonIndex;
     }
 
     BufferLayout getLayout() const override {
@@ -213,6 +261,22 @@ private:
     size_t tileHeight_ = 0;
 };
 
+// 布局对应的缓冲区类型，用于在编译期选择layoutIndex
+template<typename T, BufferLayout Layout>
+struct BufferLayoutType {
+    using type = Buffer<T>;
+};
+
+template<typename T>
+struct BufferLayoutType<T, Layout_Tiled> {
+    using type = TiledBuffer<T>;
+};
+
+template<typename T>
+struct BufferLayoutType<T, Layout_Morton> {
+    using type = MortonBuffer<T>;
+};
+
 template<typename T>
 std::shared_ptr<Buffer<T>> Buffer<T>::makeDefault(size_t w, size_t h) {
     std::shared_ptr<Buffer<T>> ret = nullptr;
@@ -232,13 +296,14 @@ template<typename T>
 std::shared_ptr<Buffer<T>> Buffer<T>::makeLayout(size_t w, size_t h, BufferLayout layout) {
     std::shared_ptr<Buffer<T>> ret = nullptr;
 
-    //是否缺乏break
     switch (layout) {
     case Layout_Tiled: {
         ret = std::make_shared<TiledBuffer<T>>();
+        break;
     }
     case Layout_Morton: {
         ret = std::make_shared<MortonBuffer<T>>();
+        break;
     }
     case Layout_Linear:
     default: {
@@ -0,0 +1,110 @@
+#ifndef CPUFEATURES_H
+#define CPUFEATURES_H
+
+#include <cstdint>
+#include <cstring>
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#else
+#include <cpuid.h>
+#endif
+
+namespace OpenGL {
+
+// 软光栅SIMD内核的指令集级别，高级别包含低级别
+enum SIMDLevel {
+	SIMDLevel_SCALAR = 0,
+	SIMDLevel_SSE41,
+	SIMDLevel_AVX2,   // AVX2 + FMA
+	SIMDLevel_AVX512, // AVX-512 F + BW
+};
+
+class CPUFeatures {
+public:
+	// 用cpuid检测CPU支持的最高级别，同时检查操作系统是否保存对应的寄存器状态（XCR0）
+	static SIMDLevel detect() {
+		uint32_t regs[4];
+		cpuid(0, 0, regs);
+		uint32_t maxLeaf = regs[0];
+		if (maxLeaf < 1) {
+			return SIMDLevel_SCALAR;
+		}
+
+		cpuid(1, 0, regs);
+		bool sse41 = regs[2] & (1u << 19);
+		bool fma = regs[2] & (1u << 12);
+		bool osxsave = regs[2] & (1u << 27);
+		bool avx = regs[2] & (1u << 28);
+		if (!sse41) {
+			return SIMDLevel_SCALAR;
+		}
+		if (!osxsave || !avx || !fma || maxLeaf < 7) {
+			return SIMDLevel_SSE41;
+		}
+
+		uint64_t xcr0 = xgetbv();
+		if ((xcr0 & 0x6) != 0x6) { // XMM, YMM
+			return SIMDLevel_SSE41;
+		}
+
+		cpuid(7, 0, regs);
+		bool avx2 = regs[1] & (1u << 5);
+		bool avx512f = regs[1] & (1u << 16);
+		bool avx512bw = regs[1] & (1u << 30);
+		if (!avx2) {
+			return SIMDLevel_SSE41;
+		}
+		if (avx512f && avx512bw && (xcr0 & 0xE0) == 0xE0) { // opmask, ZMM0-15高位, ZMM16-31
+			return SIMDLevel_AVX512;
+		}
+		return SIMDLevel_AVX2;
+	}
+
+	static const char* levelName(SIMDLevel level) {
+		switch (level) {
+			case SIMDLevel_SCALAR: return "scalar";
+			case SIMDLevel_SSE41:  return "sse4.1";
+			case SIMDLevel_AVX2:   return "avx2";
+			case SIMDLevel_AVX512: return "avx512";
+		}
+		return "unknown";
+	}
+
+	// 解析levelName()返回的名称，失败时返回false
+	static bool parseLevel(const char* name, SIMDLevel& level) {
+		if (!name) {
+			return false;
+		}
+		for (int i = SIMDLevel_SCALAR; i <= SIMDLevel_AVX512; i++) {
+			if (strcmp(name, levelName((SIMDLevel)i)) == 0) {
+				level = (SIMDLevel)i;
+				return true;
+			}
+		}
+		return false;
+	}
+
+private:
+	static void cpuid(uint32_t leaf, uint32_t subLeaf, uint32_t regs[4]) {
+#ifdef _MSC_VER
+		__cpuidex((int*)regs, (int)leaf, (int)subLeaf);
+#else
+		__cpuid_count(leaf, subLeaf, regs[0], regs[1], regs[2], regs[3]);
+#endif
+	}
+
+	static uint64_t xgetbv() {
+#ifdef _MSC_VER
+		return _xgetbv(0);
+#else
+		uint32_t eax, edx;
+		__asm__ volatile("xgetbv" : "=a"(eax), "=d"(edx) : "c"(0));
+		return ((uint64_t)edx << 32) | eax;
+#endif
+	}
+};
+
+}
+
+#endif
@@ -2,6 +2,7 @@
 #define FILEUTILS_H
 
 #include <fstream>
+#include <vector>
 #include "Base/Logger.h"
 
 namespace OpenGL {
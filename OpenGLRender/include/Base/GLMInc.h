@@ -3,7 +3,8 @@
 
 #define GLM_FORCE_ALIGNED
 #define GLM_FORCE_INLINE
-#define GLM_FORCE_AVX2
+// GLM按编译器目标指令集选择SIMD实现（x86-64默认SSE2），不强制AVX2，保证程序能在不支持AVX2的CPU上运行
+#define GLM_FORCE_INTRINSICS
 #include <glm/glm/glm.hpp>
 #include <glm/glm/gtc/quaternion.hpp>
 #include <glm/glm/gtc/type_aligned.hpp>
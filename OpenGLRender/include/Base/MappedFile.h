@@ -0,0 +1,112 @@
+#ifndef MAPPEDFILE_H
+#define MAPPEDFILE_H
+
+#include <cstdint>
+#include <string>
+#include "Base/Logger.h"
+#include "Base/Platform.h"
+
+#ifdef PLATFORM_WINDOWS
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace OpenGL {
+
+// 只读内存映射文件，数据在对象析构前一直有效
+class MappedFile {
+public:
+	MappedFile() = default;
+	MappedFile(const MappedFile&) = delete;
+	MappedFile& operator=(const MappedFile&) = delete;
+
+	~MappedFile() {
+		close();
+	}
+
+	bool open(const std::string& path) {
+		close();
+#ifdef PLATFORM_WINDOWS
+		HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+								  FILE_ATTRIBUTE_NORMAL, nullptr);
+		if (file == INVALID_HANDLE_VALUE) {
+			LOGE("failed to open file: %s", path.c_str());
+			return false;
+		}
+		LARGE_INTEGER fileSize;
+		if (!GetFileSizeEx(file, &fileSize) || fileSize.QuadPart <= 0) {
+			CloseHandle(file);
+			return false;
+		}
+		HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+		CloseHandle(file);
+		if (!mapping) {
+			LOGE("failed to map file: %s", path.c_str());
+			return false;
+		}
+		// 映射视图会持有文件映射对象，句柄可以立即关闭
+		void* ptr = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+		CloseHandle(mapping);
+		if (!ptr) {
+			LOGE("failed to map file: %s", path.c_str());
+			return false;
+		}
+		data_ = (const uint8_t*)ptr;
+		size_ = (size_t)fileSize.QuadPart;
+#else
+		int fd = ::open(path.c_str(), O_RDONLY);
+		if (fd < 0) {
+			LOGE("failed to open file: %s", path.c_str());
+			return false;
+		}
+		struct stat st {};
+		if (fstat(fd, &st) != 0 || st.st_size <= 0) {
+			::close(fd);
+			return false;
+		}
+		void* ptr = mmap(nullptr, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+		::close(fd);
+		if (ptr == MAP_FAILED) {
+			LOGE("failed to map file: %s", path.c_str());
+			return false;
+		}
+		data_ = (const uint8_t*)ptr;
+		size_ = (size_t)st.st_size;
+#endif
+		return true;
+	}
+
+	void close() {
+		if (!data_) {
+			return;
+		}
+#ifdef PLATFORM_WINDOWS
+		UnmapViewOfFile(data_);
+#else
+		munmap((void*)data_, size_);
+#endif
+		data_ = nullptr;
+		size_ = 0;
+	}
+
+	inline const uint8_t* data() const { return data_; }
+	inline size_t size() const { return size_; }
+
+private:
+	const uint8_t* data_ = nullptr;
+	size_t size_ = 0;
+};
+
+}
+
+#endif
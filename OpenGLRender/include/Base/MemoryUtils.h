@@ -1,9 +1,12 @@
 #ifndef MEMORYUTILS_H
 #define MEMORYUTILS_H
 
+#include <algorithm>
 #include <cmath>
+#include <cstring>
 #include <memory>
 #include "Base/Logger.h"
+#include "Base/SIMD.h"
 
 #define OPENGL_ALIGNMENT 32
 
@@ -58,6 +61,41 @@ public:
 				[](const T* ptr) { MemoryUtils::alignedFree((void*)ptr); });
 	}
 
+	//用val填充cnt个元素，stream为true时使用非临时存储（绕过缓存），用于填充后短时间内不会再访问的内存，
+	//非临时存储是弱序的，全部填充完成后需调用streamFence
+	template<class T>
+	static void fill(T* dst, size_t cnt, const T& val, bool stream) {
+		if constexpr (sizeof(T) == 4 || sizeof(T) == 16) {
+			if (stream) {
+				//先逐个写到32字节对齐，元素大小为16字节且起始地址未按16字节对齐时全部逐个写入
+				while (cnt > 0 && PTR_ADDR(dst) % 32 != 0) {
+					*dst++ = val;
+					cnt--;
+				}
+				__m128i pattern;
+				if constexpr (sizeof(T) == 4) {
+					int32_t bits;
+					memcpy(&bits, &val, sizeof(bits));
+					pattern = _mm_set1_epi32(bits);
+				}
+				else {
+					pattern = _mm_loadu_si128((const __m128i*)&val);
+				}
+				//SSE2的16字节非临时存储，不依赖运行时CPU检测
+				constexpr size_t step = 32 / sizeof(T);
+				for (; cnt >= step; cnt -= step, dst += step) {
+					_mm_stream_si128((__m128i*)dst, pattern);
+					_mm_stream_si128((__m128i*)dst + 1, pattern);
+				}
+			}
+		}
+		std::fill_n(dst, cnt, val);
+	}
+
+	static inline void streamFence() {
+		_mm_sfence();
+	}
+
 	template<class T>
 	static std::shared_ptr<T> makeBuffer(size_t elemCnt, const uint8_t* data = nullptr) {
 		if (elemCnt == 0) {
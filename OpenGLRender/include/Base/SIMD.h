@@ -1,6 +1,15 @@
 #ifndef SIMD_H
 #define SIMD_H
 
+#include <immintrin.h>
+
+// 软光栅SIMD优化开关：编译期启用的路径只使用SSE2（x86-64基础指令集），
+// SSE4.1/AVX2/AVX-512内核由SIMDKernelsSoft按CPU运行时选择。定义SOFTGL_SIMD_DISABLE时只使用标量实现
+#if !defined(SOFTGL_SIMD_DISABLE) && (defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2))
+#define SOFTGL_SIMD_OPT
+#endif
+#define SOFTGL_ALIGNMENT 32
+
 #ifdef _MSC_VER
 #define MM_F32(v, i) v.m128_f32[i]
 #else
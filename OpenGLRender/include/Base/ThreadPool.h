@@ -2,62 +2,159 @@
 #define THREADPOOL_H
 
 #include <atomic>
+#include <chrono>
+#include <condition_variable>
 #include <mutex>
 #include <functional>
 #include <iostream>
 #include <memory>
 #include <queue>
 #include <thread>
+#include <vector>
 
 namespace OpenGL {
 
+// 有界无锁多生产者多消费者环形队列（Vyukov MPMC），capacity必须为2的幂
+// 每个工作线程持有一个，自己从中取任务，空闲的线程也可以从中窃取任务
+template<class T>
+class LockFreeTaskQueue {
+public:
+	explicit LockFreeTaskQueue(size_t capacity)
+		: mask_(capacity - 1), cells_(new Cell[capacity]) {
+		for (size_t i = 0; i < capacity; i++) {
+			cells_[i].seq.store(i, std::memory_order_relaxed);
+		}
+	}
+
+	// 队列已满时返回false
+	bool push(T&& item) {
+		Cell* cell = nullptr;
+		size_t pos = tail_.load(std::memory_order_relaxed);
+		while (true) {
+			cell = &cells_[pos & mask_];
+			size_t seq = cell->seq.load(std::memory_order_acquire);
+			intptr_t diff = (intptr_t)seq - (intptr_t)pos;
+			if (diff == 0) {// 该槽位空闲，尝试占用
+				if (tail_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+					break;
+				}
+			}
+			else if (diff < 0) {
+				return false;
+			}
+			else {// 被其他生产者抢先，重新读取位置
+				pos = tail_.load(std::memory_order_relaxed);
+			}
+		}
+		cell->data = std::move(item);
+		cell->seq.store(pos + 1, std::memory_order_release);
+		return true;
+	}
+
+	// 队列为空时返回false
+	bool pop(T& item) {
+		Cell* cell = nullptr;
+		size_t pos = head_.load(std::memory_order_relaxed);
+		while (true) {
+			cell = &cells_[pos & mask_];
+			size_t seq = cell->seq.load(std::memory_order_acquire);
+			intptr_t diff = (intptr_t)seq - (intptr_t)(pos + 1);
+			if (diff == 0) {// 该槽位已写入数据，尝试取出
+				if (head_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+					break;
+				}
+			}
+			else if (diff < 0) {
+				return false;
+			}
+			else {
+				pos = head_.load(std::memory_order_relaxed);
+			}
+		}
+		item = std::move(cell->data);
+		cell->data = T(); // 及时释放任务捕获的资源
+		cell->seq.store(pos + mask_ + 1, std::memory_order_release);
+		return true;
+	}
+
+private:
+	struct Cell {
+		std::atomic<size_t> seq{ 0 };
+		T data;
+	};
+
+	alignas(64) std::atomic<size_t> head_{ 0 }; // 读写位置放在不同缓存行，避免伪共享
+	alignas(64) std::atomic<size_t> tail_{ 0 };
+	size_t mask_ = 0;
+	std::unique_ptr<Cell[]> cells_;
+};
+
 class ThreadPool {
 public:
 
-	explicit ThreadPool(const size_t threadCnt = std::thread::hardware_concurrency()) 
-	: threadCnt_(threadCnt), 
+	explicit ThreadPool(const size_t threadCnt = std::thread::hardware_concurrency())
+	: threadCnt_(threadCnt),
 	threads_(new std::thread[threadCnt])/*thread对象没有关联任何线程*/ {
+		for (size_t i = 0; i < threadCnt; i++) {
+			queues_.emplace_back(new LockFreeTaskQueue<std::function<void(size_t)>>(kQueueCapacity));
+		}
 		createThreads();
 	}
 
 	~ThreadPool() {
 		waitTasksFinish();
 		running_ = false;
+		{
+			const std::lock_guard<std::mutex> lock(wakeMutex_);
+			wakeCv_.notify_all();
+		}
 		joinThreads();
 	}
 
 	inline size_t getThreadCnt() const {
 		return threadCnt_;
 	}
-	
+
+	// 任务轮流分发到各工作线程的队列，thread_id为执行该任务的工作线程编号
 	template<class F>
 	void pushTask(const F& task) {
-		{//减少锁的作用域，尽快释放锁
-			const std::lock_guard<std::mutex> lock(mutex_);
-			tasks_.push(std::function<void(size_t)>(task));//可以接受参数是自己子集的函数。
+		if (threadCnt_ == 0) {// 没有工作线程时直接在当前线程执行
+			task(0);
+			return;
 		}
+
 		tasksCnt_++;
+		queuedCnt_++;
+		std::function<void(size_t)> func(task);//可以接受参数是自己子集的函数。
+		size_t idx = nextQueue_.fetch_add(1, std::memory_order_relaxed) % threadCnt_;
+		if (!queues_[idx]->push(std::move(func))) {
+			// 工作线程的队列已满，放入共享的溢出队列
+			const std::lock_guard<std::mutex> lock(overflowMutex_);
+			overflowTasks_.push(std::move(func));
+			overflowCnt_++;
+		}
+
+		// 只在有未被通知的休眠线程时才唤醒，避免每次提交都进行系统调用
+		if (sleepingCnt_ > wakePendingCnt_) {
+			const std::lock_guard<std::mutex> lock(wakeMutex_);
+			if (sleepingCnt_ > wakePendingCnt_) {
+				wakePendingCnt_++;
+				wakeCv_.notify_one();
+			}
+		}
 	}
 	//将给的task进行参数打包，存储在tasks_中。
 	template<class F, class... A>
 	void pushTask(const F& task, const A &...args) {
-		pushTask([task, args...] {task(args...); });
+		pushTask([task, args...](size_t) {task(args...); });
 	}
 
 	//阻塞直到任务队列清空
 	void waitTasksFinish() const {
-		while (true) {
-			if (!paused) {
-				if (tasksCnt_ == 0) {
-					break;
-				}
-			}
-			else {
-				if (taskRunningCnt() == 0) {
-					break;
-				}
-			}
-			std::this_thread::yield();
+		std::unique_lock<std::mutex> lock(finishMutex_);
+		while (!(paused ? taskRunningCnt() == 0 : tasksCnt_ == 0)) {
+			// 带超时等待，避免paused切换时没有线程负责唤醒
+			finishCv_.wait_for(lock, std::chrono::milliseconds(1));
 		}
 	}
 
@@ -76,38 +173,61 @@ private:
 		}
 	}
 
-	//取出任务
-	bool popTask(std::function<void(size_t)>& task) {
-		const std::lock_guard<std::mutex> lock(mutex_);
-		if (tasks_.empty()) {
-			return false;
-		}
-		else {
-			task = std::move(tasks_.front());
-			tasks_.pop();
-			return true;
+	//取出任务：先取自己队列，再从其他线程队列窃取，最后检查溢出队列
+	bool popTask(size_t threadId, std::function<void(size_t)>& task) {
+		for (size_t i = 0; i < threadCnt_; i++) {
+			if (queues_[(threadId + i) % threadCnt_]->pop(task)) {
+				queuedCnt_--;
+				return true;
+			}
 		}
-	}
 
-	size_t taskQueueCnt() const {
-		const std::lock_guard<std::mutex> lock(mutex_);
-		return tasks_.size();
+		if (overflowCnt_ > 0) {
+			const std::lock_guard<std::mutex> lock(overflowMutex_);
+			if (!overflowTasks_.empty()) {
+				task = std::move(overflowTasks_.front());
+				overflowTasks_.pop();
+				overflowCnt_--;
+				queuedCnt_--;
+				return true;
+			}
+		}
+		return false;
 	}
 
 	size_t taskRunningCnt() const {
-		return tasksCnt_ - taskQueueCnt();
+		return tasksCnt_ - queuedCnt_;
 	}
 
 	//工作线程执行函数，
 	void taskWorker(size_t threadId) {
+		std::function<void(size_t)> task;
+		size_t idleCnt = 0;
 		while (running_) {
-			std::function<void(size_t)> task;
-			if (!paused && popTask(task)) {
+			if (!paused && popTask(threadId, task)) {
 				task(threadId);
-				tasksCnt_--;
+				task = nullptr;
+				idleCnt = 0;
+				if (--tasksCnt_ == 0) {
+					const std::lock_guard<std::mutex> lock(finishMutex_);
+					finishCv_.notify_all();
+				}
+			}
+			else if (++idleCnt < kSpinCnt) {
+				std::this_thread::yield();// 短暂自旋，连续提交的任务无需唤醒
 			}
 			else {
-				std::this_thread::yield();// 让出CPU时间片
+				// 长时间空闲则休眠，直到有新任务
+				std::unique_lock<std::mutex> lock(wakeMutex_);
+				sleepingCnt_++;
+				wakeCv_.wait_for(lock, std::chrono::milliseconds(2), [this] {
+					return !running_ || (!paused && queuedCnt_ > 0);
+					});
+				sleepingCnt_--;
+				if (wakePendingCnt_ > 0) {
+					wakePendingCnt_--;
+				}
+				idleCnt = 0;
 			}
 		}
 	}
@@ -116,15 +236,30 @@ private:
 public:
 	std::atomic<bool> paused{ false };
 private:
+	static constexpr size_t kQueueCapacity = 4096; // 每个工作线程队列容量（2的幂）
+	static constexpr size_t kSpinCnt = 64; // 休眠前的空转次数
 
-	mutable std::mutex mutex_;
 	std::atomic<bool> running_{ true };
-	
-	std::unique_ptr<std::thread[]> threads_;
+
 	std::atomic<size_t> threadCnt_{ 0 };
+	std::unique_ptr<std::thread[]> threads_;
+	std::vector<std::unique_ptr<LockFreeTaskQueue<std::function<void(size_t)>>>> queues_; // 每个工作线程一个队列
+	std::atomic<size_t> nextQueue_{ 0 };
+
+	mutable std::mutex overflowMutex_;
+	std::queue<std::function<void(size_t)>> overflowTasks_ = {};
+	std::atomic<size_t> overflowCnt_{ 0 };
 
-	std::queue<std::function<void(size_t)>> tasks_ = {};//未执行的
 	std::atomic<size_t> tasksCnt_{ 0 };//未执行+执行中的
+	std::atomic<size_t> queuedCnt_{ 0 };//未执行的
+
+	std::mutex wakeMutex_;
+	std::condition_variable wakeCv_;
+	std::atomic<size_t> sleepingCnt_{ 0 }; // 休眠中的线程数
+	std::atomic<size_t> wakePendingCnt_{ 0 }; // 已通知但尚未醒来的线程数
+
+	mutable std::mutex finishMutex_;
+	mutable std::condition_variable finishCv_;
 };
 
 
@@ -2,6 +2,7 @@
 #define FRAMEBUFFEROPENGL_H
 
 #include "Render/FrameBuffer.h"
+#include "Render/OpenGL/StateCacheOpenGL.h"
 
 namespace OpenGL {
 class FrameBufferOpenGL : public FrameBuffer {
@@ -11,6 +12,7 @@ public:
 	}
 
 	~FrameBufferOpenGL() {
+		StateCacheOpenGL::get().onDeleteFramebuffer(fbo_);
 		GL_CHECK(glDeleteFramebuffers(1, &fbo_));
 	}
 
@@ -23,7 +25,7 @@ public:
 		if (!fbo_) {
 			return false;
 		}
-		GL_CHECK(glBindFramebuffer(GL_FRAMEBUFFER, fbo_));
+		StateCacheOpenGL::get().bindFramebuffer(fbo_);
 
 		//检查完整性
 		GLenum status = glCheckFramebufferStatus(GL_FRAMEBUFFER);
@@ -43,7 +45,7 @@ public:
 		FrameBuffer::setColorAttachment(color, level);
 
 		//绑定纹理附件
-		GL_CHECK(glBindFramebuffer(GL_FRAMEBUFFER, fbo_));
+		StateCacheOpenGL::get().bindFramebuffer(fbo_);
 		GL_CHECK(glFramebufferTexture2D(GL_FRAMEBUFFER,
 										GL_COLOR_ATTACHMENT0,
 										color->multiSample ? GL_TEXTURE_2D_MULTISAMPLE : GL_TEXTURE_2D,
@@ -57,7 +59,7 @@ public:
 		}
 
 		FrameBuffer::setColorAttachment(color, face, level);
-		GL_CHECK(glBindFramebuffer(GL_FRAMEBUFFER, fbo_));
+		StateCacheOpenGL::get().bindFramebuffer(fbo_);
 		GL_CHECK(glFramebufferTexture2D(GL_FRAMEBUFFER,
 										GL_COLOR_ATTACHMENT0,
 										OpenGL::cvtCubeFace(face),
@@ -71,7 +73,7 @@ public:
 		}
 
 		FrameBuffer::setDepthAttachment(depth);
-		GL_CHECK(glBindFramebuffer(GL_FRAMEBUFFER, fbo_));
+		StateCacheOpenGL::get().bindFramebuffer(fbo_);
 		GL_CHECK(glFramebufferTexture2D(GL_FRAMEBUFFER,
 										GL_DEPTH_ATTACHMENT,
 										depth->multiSample ? GL_TEXTURE_2D_MULTISAMPLE : GL_TEXTURE_2D,
@@ -80,7 +82,7 @@ public:
 	}
 
 	void bind() const {
-		GL_CHECK(glBindFramebuffer(GL_FRAMEBUFFER, fbo_));
+		StateCacheOpenGL::get().bindFramebuffer(fbo_);
 	}
 
 private:
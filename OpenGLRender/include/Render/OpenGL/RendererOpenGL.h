@@ -4,6 +4,7 @@
 #include "Render/Renderer.h"
 #include "Render/OpenGL/VertexOpenGL.h"
 #include "Render/OpenGL/ShaderProgramOpenGL.h"
+#include "Render/OpenGL/StateCacheOpenGL.h"
 
 namespace OpenGL {
 
@@ -41,6 +42,12 @@ public:
 	void endRenderPass() override;
 	void waitIdle() override;
 
+public:
+	// 进程全局状态缓存（StateCacheOpenGL::get()）的累计统计：实际发出与省略的GL调用次数，
+	// 包含所有RendererOpenGL实例及资源对象经过缓存的调用，不区分渲染器
+	static const StateCacheStats& getGlobalStateCacheStats();
+	static void resetGlobalStateCacheStats();
+
 private:
 	VertexArrayObjectOpenGL* vao_ = nullptr;
 	ShaderProgramOpenGL* shaderProgram_ = nullptr;
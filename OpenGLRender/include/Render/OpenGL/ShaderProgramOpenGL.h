@@ -1,12 +1,18 @@
 #ifndef SHADERPROGRAMOPENGL_H
 #define SHADERPROGRAMOPENGL_H
 
+#include <unordered_map>
 #include "Render/ShaderProgram.h"
+#include "Render/OpenGL/StateCacheOpenGL.h"
 
 namespace OpenGL {
 
 class ShaderProgramOpenGL : public ShaderProgram {
 public:
+	~ShaderProgramOpenGL() {
+		StateCacheOpenGL::get().onDeleteProgram(programId_);
+	}
+
 	int getId() const override {
 		return (int)programId_;
 	}
@@ -18,6 +24,8 @@ public:
 	bool compileAndLink(const std::string& vsSource, const std::string& fsSource) {
 		bool ret = programGLSL_.loadSource(vsSource, fsSource);
 		programId_ = programGLSL_.getId();
+		blockBindings_.clear();
+		samplerUnits_.clear();
 		return ret;
 	}
 
@@ -26,7 +34,12 @@ public:
 	}
 
 	inline void use() {
-		programGLSL_.use();
+		if (programId_) {
+			StateCacheOpenGL::get().useProgram(programId_);
+		}
+		else {
+			LOGE("failed to use program, not ready");
+		}
 		uniformBlockBinding_ = 0;
 		uniformSamplerBinding_ = 0;
 	}
@@ -39,6 +52,31 @@ public:
 	inline int getUniformSamplerBinding() {
 		return uniformSamplerBinding_++;
 	}
+
+	// uniform块绑定点与采样器单元属于程序对象的状态，每帧绑定顺序不变时无需重复设置
+	inline void setUniformBlockBinding(GLuint index, GLuint binding) {
+		if (updateBinding(blockBindings_, (int)index, (int)binding)) {
+			GL_CHECK(glUniformBlockBinding(programId_, index, binding));
+		}
+	}
+
+	// 需要在use()之后调用
+	inline void setUniformSampler(GLint location, GLint unit) {
+		if (updateBinding(samplerUnits_, location, unit)) {
+			GL_CHECK(glUniform1i(location, unit));
+		}
+	}
+
+private:
+	static inline bool updateBinding(std::unordered_map<int, int>& bindings, int key, int value) {
+		auto it = bindings.find(key);
+		bool changed = it == bindings.end() || it->second != value;
+		if (changed) {
+			bindings[key] = value;
+		}
+		return StateCacheOpenGL::get().record(changed);
+	}
+
 private:
 	GLuint programId_ = 0;
 	ProgramGLSL programGLSL_;
@@ -46,6 +84,9 @@ private:
 	//递增机制
 	int uniformBlockBinding_ = 0;
 	int uniformSamplerBinding_ = 0; // 用于纹理
+
+	std::unordered_map<int, int> blockBindings_;  // uniform块索引 -> 绑定点
+	std::unordered_map<int, int> samplerUnits_;   // 采样器location -> 纹理单元
 };
 
 }
@@ -0,0 +1,301 @@
+#ifndef STATECACHEOPENGL_H
+#define STATECACHEOPENGL_H
+
+#include <glad/glad.h>
+#include "Base/GLMInc.h"
+#include "Render/OpenGL/OpenGLUtils.h"
+
+namespace OpenGL {
+
+// 状态缓存的调用统计：issued为实际发出的GL调用，skipped为因状态未变化而省略的调用
+struct StateCacheStats {
+	uint64_t issued = 0;
+	uint64_t skipped = 0;
+};
+
+/*
+ * OpenGL状态的影子副本，过滤与当前状态相同的GL调用
+ * 进程内只有一个实例（get()），对应程序唯一的GL上下文（main.cpp创建的窗口），
+ * 所有RendererOpenGL与资源对象共用，统计也是进程全局的；如果以后创建多个上下文，
+ * 需要改为每个上下文一个实例并传给资源对象。
+ * 后端之外的代码（ImGui、窗口绘制等）可能直接修改GL状态，
+ * 因此每个渲染通道开始时调用invalidate()，之后后端内的状态修改都要经过这里
+ */
+class StateCacheOpenGL {
+public:
+	static StateCacheOpenGL& get() {
+		static StateCacheOpenGL instance;
+		return instance;
+	}
+
+	// 所有状态标记为未知，下一次设置一定会发出GL调用
+	void invalidate() {
+		for (auto& cap : caps_) {
+			cap.valid = false;
+		}
+		blendEquation_.valid = false;
+		blendFunc_.valid = false;
+		depthMask_.valid = false;
+		depthFunc_.valid = false;
+		polygonMode_.valid = false;
+		lineWidth_.valid = false;
+		viewport_.valid = false;
+		clearColor_.valid = false;
+		program_.valid = false;
+		vertexArray_.valid = false;
+		framebuffer_.valid = false;
+		activeTexture_.valid = false;
+		for (auto& unit : textures_) {
+			for (auto& tex : unit) {
+				tex.valid = false;
+			}
+		}
+		for (auto& ubo : uniformBuffers_) {
+			ubo.valid = false;
+		}
+	}
+
+	// 只缓存渲染器使用的开关，其余直接发出
+	void enable(GLenum cap, bool enable) {
+		int idx = capIndex(cap);
+		if (idx >= 0) {
+			if (!record(caps_[idx].update(enable))) {
+				return;
+			}
+		}
+		else {
+			record(true);
+		}
+		if (enable) {
+			GL_CHECK(glEnable(cap));
+		}
+		else {
+			GL_CHECK(glDisable(cap));
+		}
+	}
+
+	void blendEquationSeparate(GLenum modeRgb, GLenum modeAlpha) {
+		if (record(blendEquation_.update(glm::uvec2(modeRgb, modeAlpha)))) {
+			GL_CHECK(glBlendEquationSeparate(modeRgb, modeAlpha));
+		}
+	}
+
+	void blendFuncSeparate(GLenum srcRgb, GLenum dstRgb, GLenum srcAlpha, GLenum dstAlpha) {
+		if (record(blendFunc_.update(glm::uvec4(srcRgb, dstRgb, srcAlpha, dstAlpha)))) {
+			GL_CHECK(glBlendFuncSeparate(srcRgb, dstRgb, srcAlpha, dstAlpha));
+		}
+	}
+
+	void depthMask(bool mask) {
+		if (record(depthMask_.update(mask))) {
+			GL_CHECK(glDepthMask(mask));
+		}
+	}
+
+	void depthFunc(GLenum func) {
+		if (record(depthFunc_.update(func))) {
+			GL_CHECK(glDepthFunc(func));
+		}
+	}
+
+	void polygonMode(GLenum mode) {
+		if (record(polygonMode_.update(mode))) {
+			GL_CHECK(glPolygonMode(GL_FRONT_AND_BACK, mode));
+		}
+	}
+
+	void lineWidth(float width) {
+		if (record(lineWidth_.update(width))) {
+			GL_CHECK(glLineWidth(width));
+		}
+	}
+
+	void viewport(int x, int y, int width, int height) {
+		if (record(viewport_.update(glm::ivec4(x, y, width, height)))) {
+			GL_CHECK(glViewport(x, y, width, height));
+		}
+	}
+
+	void clearColor(const glm::vec4& color) {
+		if (record(clearColor_.update(color))) {
+			GL_CHECK(glClearColor(color.r, color.g, color.b, color.a));
+		}
+	}
+
+	void useProgram(GLuint program) {
+		if (record(program_.update(program))) {
+			GL_CHECK(glUseProgram(program));
+		}
+	}
+
+	void bindVertexArray(GLuint vao) {
+		if (record(vertexArray_.update(vao))) {
+			GL_CHECK(glBindVertexArray(vao));
+		}
+	}
+
+	void bindFramebuffer(GLuint fbo) {
+		if (record(framebuffer_.update(fbo))) {
+			GL_CHECK(glBindFramebuffer(GL_FRAMEBUFFER, fbo));
+		}
+	}
+
+	void activeTexture(int unit) {
+		if (record(activeTexture_.update(unit))) {
+			GL_CHECK(glActiveTexture(GL_TEXTURE0 + unit));
+		}
+	}
+
+	// 绑定到指定纹理单元
+	void bindTexture(int unit, GLenum target, GLuint tex) {
+		activeTexture(unit);
+		bindTextureCurrentUnit(unit, target, tex);
+	}
+
+	// 绑定到当前激活的纹理单元（创建、上传纹理时使用）
+	void bindTexture(GLenum target, GLuint tex) {
+		bindTextureCurrentUnit(activeTexture_.valid ? activeTexture_.value : -1, target, tex);
+	}
+
+	void bindUniformBufferBase(GLuint binding, GLuint ubo) {
+		if (binding < kMaxUniformBuffers) {
+			if (!record(uniformBuffers_[binding].update(ubo))) {
+				return;
+			}
+		}
+		else {
+			record(true);
+		}
+		GL_CHECK(glBindBufferBase(GL_UNIFORM_BUFFER, binding, ubo));
+	}
+
+	// 程序对象自身的状态（uniform块绑定点、采样器单元）由ShaderProgramOpenGL缓存，这里只记录统计
+	inline bool record(bool changed) {
+		if (changed) {
+			stats_.issued++;
+		}
+		else {
+			stats_.skipped++;
+		}
+		return changed;
+	}
+
+	// 删除对象时GL会把当前上下文中对它的绑定重置为0
+	void onDeleteProgram(GLuint program) {
+		resetIfBound(program_, program);
+	}
+
+	void onDeleteVertexArray(GLuint vao) {
+		resetIfBound(vertexArray_, vao);
+	}
+
+	void onDeleteFramebuffer(GLuint fbo) {
+		resetIfBound(framebuffer_, fbo);
+	}
+
+	void onDeleteTexture(GLuint tex) {
+		for (auto& unit : textures_) {
+			for (auto& bound : unit) {
+				resetIfBound(bound, tex);
+			}
+		}
+	}
+
+	void onDeleteBuffer(GLuint buffer) {
+		for (auto& ubo : uniformBuffers_) {
+			resetIfBound(ubo, buffer);
+		}
+	}
+
+	inline const StateCacheStats& getStats() const { return stats_; }
+	inline void resetStats() { stats_ = {}; }
+
+private:
+	template<typename T>
+	struct CachedState {
+		T value{};
+		bool valid = false;
+
+		// 返回是否需要发出GL调用
+		inline bool update(const T& v) {
+			if (valid && value == v) {
+				return false;
+			}
+			value = v;
+			valid = true;
+			return true;
+		}
+	};
+
+	StateCacheOpenGL() = default;
+
+	static inline int capIndex(GLenum cap) {
+		switch (cap) {
+			case GL_BLEND:              return 0;
+			case GL_DEPTH_TEST:         return 1;
+			case GL_CULL_FACE:          return 2;
+			case GL_PROGRAM_POINT_SIZE: return 3;
+			default:
+				break;
+		}
+		return -1;
+	}
+
+	static inline int textureTargetIndex(GLenum target) {
+		switch (target) {
+			case GL_TEXTURE_2D:             return 0;
+			case GL_TEXTURE_2D_MULTISAMPLE: return 1;
+			case GL_TEXTURE_CUBE_MAP:       return 2;
+			default:
+				break;
+		}
+		return -1;
+	}
+
+	// 当前单元未知时无法判断，直接发出并保持未知
+	void bindTextureCurrentUnit(int unit, GLenum target, GLuint tex) {
+		int targetIdx = textureTargetIndex(target);
+		if (unit >= 0 && unit < kMaxTextureUnits && targetIdx >= 0) {
+			if (!record(textures_[unit][targetIdx].update(tex))) {
+				return;
+			}
+		}
+		else {
+			record(true);
+		}
+		GL_CHECK(glBindTexture(target, tex));
+	}
+
+	template<typename T>
+	static inline void resetIfBound(CachedState<T>& state, GLuint id) {
+		if (state.valid && state.value == (T)id) {
+			state.value = 0;
+		}
+	}
+
+private:
+	static constexpr int kMaxTextureUnits = 16;
+	static constexpr GLuint kMaxUniformBuffers = 16;
+
+	CachedState<bool> caps_[4];
+	CachedState<glm::uvec2> blendEquation_;
+	CachedState<glm::uvec4> blendFunc_;
+	CachedState<bool> depthMask_;
+	CachedState<GLenum> depthFunc_;
+	CachedState<GLenum> polygonMode_;
+	CachedState<float> lineWidth_;
+	CachedState<glm::ivec4> viewport_;
+	CachedState<glm::vec4> clearColor_;
+	CachedState<GLuint> program_;
+	CachedState<GLuint> vertexArray_;
+	CachedState<GLuint> framebuffer_;
+	CachedState<int> activeTexture_;
+	CachedState<GLuint> textures_[kMaxTextureUnits][3];
+	CachedState<GLuint> uniformBuffers_[kMaxUniformBuffers];
+
+	StateCacheStats stats_;
+};
+
+}
+
+#endif
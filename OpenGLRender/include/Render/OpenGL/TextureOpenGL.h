@@ -6,6 +6,7 @@
 #include "Render/Texture.h"
 #include "Render/OpenGL/EnumsOpenGL.h"
 #include "Render/OpenGL/OpenGLUtils.h"
+#include "Render/OpenGL/StateCacheOpenGL.h"
 
 namespace OpenGL {
 
@@ -52,7 +53,7 @@ public:
 		//-------------------- 创建临时帧缓冲区对象(FBO)----------
 		GLuint fbo;
 		GL_CHECK(glGenFramebuffers(1, &fbo));
-		GL_CHECK(glBindFramebuffer(GL_FRAMEBUFFER, fbo));
+		StateCacheOpenGL::get().bindFramebuffer(fbo);
 		//----------------------根据纹理格式确定附件类型-------------
 		GLenum attachment = format == TextureFormat_FLOAT32 ? GL_DEPTH_ATTACHMENT : GL_COLOR_ATTACHMENT0;
 		//-------------------------确定纹理目标类型---------------------
@@ -70,7 +71,7 @@ public:
 		//--------------------------从帧缓冲区读取像素数据-------------------
 		GL_CHECK(glReadPixels(0, 0, levelWidth, levelHeight, glDesc_.format, glDesc_.type, pixels));
 
-		GL_CHECK(glBindFramebuffer(GL_FRAMEBUFFER, 0));
+		StateCacheOpenGL::get().bindFramebuffer(0);
 		GL_CHECK(glDeleteFramebuffers(1, &fbo));
 
 		//---------------如果是浮点纹理（如深度图），转换为可视化的RGBA格式------------
@@ -98,6 +99,7 @@ public:
 		usage = desc.usage;
 		useMipmaps = desc.useMipmaps;
 		multiSample = desc.multiSample;
+		sampleCount = desc.sampleCount;
 		target_ = multiSample ? GL_TEXTURE_2D_MULTISAMPLE : GL_TEXTURE_2D;
 
 		glDesc_ = GetOpenGLDesc(format);
@@ -105,6 +107,7 @@ public:
 	}
 
 	~Texture2DOpenGL() override {
+		StateCacheOpenGL::get().onDeleteTexture(texId_);
 		GL_CHECK(glDeleteTextures(1, &texId_));
 	}
 
@@ -115,7 +118,7 @@ public:
 		}
 
 		//-------------------设置纹理环绕模式----------------
-		GL_CHECK(glBindTexture(target_, texId_));
+		StateCacheOpenGL::get().bindTexture(target_, texId_);
 		GL_CHECK(glTexParameteri(target_, GL_TEXTURE_WRAP_S, OpenGL::cvtWrap(sampler.wrapS)));
 		GL_CHECK(glTexParameteri(target_, GL_TEXTURE_WRAP_T, OpenGL::cvtWrap(sampler.wrapT)));
 		GL_CHECK(glTexParameteri(target_, GL_TEXTURE_MIN_FILTER, OpenGL::cvtFilter(sampler.filterMin)));
@@ -142,7 +145,7 @@ public:
 			return;
 		}
 
-		GL_CHECK(glBindTexture(target_, texId_));
+		StateCacheOpenGL::get().bindTexture(target_, texId_);
 		GL_CHECK(glTexImage2D(target_, 0, glDesc_.internalformat, width, height, 0, glDesc_.format, glDesc_.type,
 							  buffers[0]->getRawDataPtr()));
 
@@ -153,9 +156,9 @@ public:
 
 	// 分配GPU内存
 	void initImageData() override {
-		GL_CHECK(glBindTexture(target_, texId_));
+		StateCacheOpenGL::get().bindTexture(target_, texId_);
 		if (multiSample) {
-			GL_CHECK(glTexImage2DMultisample(target_, 4, glDesc_.internalformat, width, height, GL_TRUE));
+			GL_CHECK(glTexImage2DMultisample(target_, sampleCount, glDesc_.internalformat, width, height, GL_TRUE));
 		}
 		else {
 			GL_CHECK(glTexImage2D(target_, 0, glDesc_.internalformat, width, height, 0, glDesc_.format, glDesc_.type, nullptr));
@@ -185,6 +188,7 @@ public:
 		GL_CHECK(glGenTextures(1, &texId_));
 	}
 	~TextureCubeOpenGL() {
+		StateCacheOpenGL::get().onDeleteTexture(texId_);
 		GL_CHECK(glDeleteTextures(1, &texId_));
 	}
 
@@ -193,7 +197,7 @@ public:
 			return;
 		}
 
-		GL_CHECK(glBindTexture(target_, texId_));
+		StateCacheOpenGL::get().bindTexture(target_, texId_);
 		GL_CHECK(glTexParameteri(target_, GL_TEXTURE_WRAP_S, OpenGL::cvtWrap(sampler.wrapS)));
 		GL_CHECK(glTexParameteri(target_, GL_TEXTURE_WRAP_T, OpenGL::cvtWrap(sampler.wrapT)));
 		GL_CHECK(glTexParameteri(target_, GL_TEXTURE_WRAP_R, OpenGL::cvtWrap(sampler.wrapR)));
@@ -221,7 +225,7 @@ public:
 			return;
 		}
 
-		GL_CHECK(glBindTexture(GL_TEXTURE_CUBE_MAP, texId_));
+		StateCacheOpenGL::get().bindTexture(GL_TEXTURE_CUBE_MAP, texId_);
 		for (int i = 0; i < 6; i++) {
 			GL_CHECK(glTexImage2D(GL_TEXTURE_CUBE_MAP_POSITIVE_X + i, 0, glDesc_.internalformat, width, height, 0,
 								  glDesc_.format, glDesc_.type, buffers[i]->getRawDataPtr()));
@@ -233,7 +237,7 @@ public:
 		
 	// 分配GPU内存
 	void initImageData() override {
-		GL_CHECK(glBindTexture(GL_TEXTURE_CUBE_MAP, texId_));
+		StateCacheOpenGL::get().bindTexture(GL_TEXTURE_CUBE_MAP, texId_);
 		for (int i = 0; i < 6; i++) {
 			GL_CHECK(glTexImage2D(GL_TEXTURE_CUBE_MAP_POSITIVE_X + i, 0, glDesc_.internalformat, width, height, 0,
 								  glDesc_.format, glDesc_.type, nullptr));
@@ -7,9 +7,7 @@
 #include "Render/Uniform.h"
 #include "Render/OpenGL/OpenGLUtils.h"
 #include "Render/OpenGL/ShaderProgramOpenGL.h"
-
-//激活纹理单元
-#define BIND_TEX_OPENGL(n) case n: GL_CHECK(glActiveTexture(GL_TEXTURE##n)); break;
+#include "Render/OpenGL/StateCacheOpenGL.h"
 
 namespace OpenGL {
 
@@ -22,6 +20,7 @@ public:
 	}
 
 	~UniformBlockOpenGL() {
+		StateCacheOpenGL::get().onDeleteBuffer(ubo_);
 		GL_CHECK(glDeleteBuffers(1, &ubo_));
 	}
 
@@ -37,8 +36,8 @@ public:
 		auto* programGL = dynamic_cast<ShaderProgramOpenGL*>(&program);
 		int binding = programGL->getUniformBlockBinding();
 
-		GL_CHECK(glUniformBlockBinding(program.getId(), location, binding));//将着色器程序中的uniform绑定到指定点
-		GL_CHECK(glBindBufferBase(GL_UNIFORM_BUFFER, binding, ubo_));//将uniform缓冲对象绑定到指定点。
+		programGL->setUniformBlockBinding(location, binding);//将着色器程序中的uniform绑定到指定点
+		StateCacheOpenGL::get().bindUniformBufferBase(binding, ubo_);//将uniform缓冲对象绑定到指定点。
 	}
 
 	//部分更新Uniform缓冲对象
@@ -74,23 +73,13 @@ public:
 		auto* programGL = dynamic_cast<ShaderProgramOpenGL*>(&program);
 		int binding = programGL->getUniformSamplerBinding();
 
-		//激活纹理单元
-		switch (binding) {
-			BIND_TEX_OPENGL(0)
-			BIND_TEX_OPENGL(1)
-			BIND_TEX_OPENGL(2)
-			BIND_TEX_OPENGL(3)
-			BIND_TEX_OPENGL(4)
-			BIND_TEX_OPENGL(5)
-			BIND_TEX_OPENGL(6)
-			BIND_TEX_OPENGL(7)
-			default: {
-				LOGE("UniformSampler::bindProgram error: texture unit not support");
-				break;
-			}
+		if (binding >= 8) {
+			LOGE("UniformSampler::bindProgram error: texture unit not support");
+			return;
 		}
-		GL_CHECK(glBindTexture(texTarget_, texId_));
-		GL_CHECK(glUniform1i(location, binding));
+		//激活纹理单元并绑定纹理
+		StateCacheOpenGL::get().bindTexture(binding, texTarget_, texId_);
+		programGL->setUniformSampler(location, binding);
 	}
 
 	void setTexture(const std::shared_ptr<Texture>& tex) {
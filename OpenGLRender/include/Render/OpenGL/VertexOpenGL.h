@@ -5,6 +5,7 @@
 #include "Render/Vertex.h"
 
 #include "Render/OpenGL/OpenGLUtils.h"
+#include "Render/OpenGL/StateCacheOpenGL.h"
 
 namespace OpenGL {
 
@@ -20,7 +21,7 @@ public:
 
 		//配置vao
 		GL_CHECK(glGenVertexArrays(1, &vao_));
-		GL_CHECK(glBindVertexArray(vao_));
+		StateCacheOpenGL::get().bindVertexArray(vao_);
 
 		//配置vbo
 		GL_CHECK(glGenBuffers(1, &vbo_));
@@ -49,7 +50,10 @@ public:
 	~VertexArrayObjectOpenGL() {
 		if (vbo_) GL_CHECK(glDeleteBuffers(1, &vbo_));
 		if (ebo_) GL_CHECK(glDeleteBuffers(1, &ebo_));
-		if (vao_) GL_CHECK(glDeleteVertexArrays(1, &vao_));
+		if (vao_) {
+			StateCacheOpenGL::get().onDeleteVertexArray(vao_);
+			GL_CHECK(glDeleteVertexArrays(1, &vao_));
+		}
 	}
 
 	//更新顶点数据
@@ -64,7 +68,7 @@ public:
 
 	inline void bind() const {
 		if (vao_) {
-			GL_CHECK(glBindVertexArray(vao_));
+			StateCacheOpenGL::get().bindVertexArray(vao_);
 		}
 	}
 
@@ -52,5 +52,12 @@ namespace OpenGL {
 
         return { retRgb, retAlpha };// 组合RGB和Alpha
     }
+
+    /*是否为标准的alpha混合：SRC_ALPHA, ONE_MINUS_SRC_ALPHA, ADD*/
+    inline bool isBlendAlpha(const BlendParameters& params) {
+        return params.blendFuncRgb == BlendFunc_ADD && params.blendFuncAlpha == BlendFunc_ADD
+            && params.blendSrcRgb == BlendFactor_SRC_ALPHA && params.blendDstRgb == BlendFactor_ONE_MINUS_SRC_ALPHA
+            && params.blendSrcAlpha == BlendFactor_SRC_ALPHA && params.blendDstAlpha == BlendFactor_ONE_MINUS_SRC_ALPHA;
+    }
 }
 #endif
\ No newline at end of file
@@ -0,0 +1,270 @@
+#ifndef DEPTHPYRAMIDSOFT_H
+#define DEPTHPYRAMIDSOFT_H
+
+#include <cmath>
+#include <limits>
+#include <vector>
+#include "Render/RenderStates.h"
+#include "Render/Software/TextureSoft.h"
+
+namespace OpenGL {
+
+// 深度缓冲的分层最小/最大值：第0级为8x8像素块，第1级为光栅化tile（与RendererSoft的分块一致）
+// 保存的范围始终包含区域内全部深度值（保守），用于在覆盖计算之前整块或整个三角形地剔除被遮挡的片元
+// 同一tile只由一个线程光栅化，块与tile一一归属，因此更新无需加锁
+class DepthPyramidSoft {
+public:
+    static constexpr int BLOCK_SHIFT = 3;
+    static constexpr int BLOCK_SIZE = 1 << BLOCK_SHIFT;
+
+    // 绑定深度缓冲，缓冲或tile大小变化时重新分配，所有区域标记为未知
+    void attach(ImageBufferSoft<float>* depth, int tileSize) {
+        if (depth == depth_ && tileSize == tileSize_ && depth
+            && depth->width == width_ && depth->height == height_) {
+            return;
+        }
+        depth_ = depth;
+        tileSize_ = tileSize;
+        width_ = depth ? depth->width : 0;
+        height_ = depth ? depth->height : 0;
+        blockCntX_ = (width_ + BLOCK_SIZE - 1) / BLOCK_SIZE;
+        blockCntY_ = (height_ + BLOCK_SIZE - 1) / BLOCK_SIZE;
+        tileCntX_ = (width_ + tileSize - 1) / tileSize;
+        tileCntY_ = (height_ + tileSize - 1) / tileSize;
+        blockInTile_ = tileSize / BLOCK_SIZE;
+        blocks_.resize(blockCntX_ * blockCntY_);
+        tiles_.resize(tileCntX_ * tileCntY_);
+        invalidate();
+    }
+
+    inline bool attached() const {
+        return depth_ != nullptr;
+    }
+
+    // 深度缓冲被整体清除为同一值
+    void reset(float depth) {
+        for (auto& block : blocks_) {
+            block = { depth, depth, Range_Exact };
+        }
+        for (auto& tile : tiles_) {
+            tile = { depth, depth, Range_Exact };
+        }
+    }
+
+    // 深度缓冲内容未知（被外部修改或新绑定），使用前从缓冲重新统计
+    void invalidate() {
+        for (auto& block : blocks_) {
+            block.state = Range_Unknown;
+        }
+        for (auto& tile : tiles_) {
+            tile.state = Range_Unknown;
+        }
+    }
+
+    // 深度写入时扩展所在块和tile的范围，缩小范围留到refreshBlock/refreshTile
+    inline void onDepthWrite(int x, int y, float depth) {
+        int bx = x >> BLOCK_SHIFT;
+        int by = y >> BLOCK_SHIFT;
+        if (bx >= blockCntX_ || by >= blockCntY_) {
+            return;
+        }
+        expand(blocks_[by * blockCntX_ + bx], depth);
+        expand(tiles_[(by / blockInTile_) * tileCntX_ + bx / blockInTile_], depth);
+    }
+
+    // 获取块内深度范围（像素坐标，8x8对齐），区域内没有有效深度时min > max
+    void getBlockRange(int bx, int by, float& minDepth, float& maxDepth) {
+        if (bx >= blockCntX_ || by >= blockCntY_) {
+            minDepth = std::numeric_limits<float>::max();
+            maxDepth = -std::numeric_limits<float>::max();
+            return;
+        }
+        auto& block = blocks_[by * blockCntX_ + bx];
+        if (block.state == Range_Unknown) {
+            computeBlock(bx, by, block);
+        }
+        minDepth = block.minDepth;
+        maxDepth = block.maxDepth;
+    }
+
+    void getTileRange(int tx, int ty, float& minDepth, float& maxDepth) {
+        if (tx >= tileCntX_ || ty >= tileCntY_) {
+            minDepth = std::numeric_limits<float>::max();
+            maxDepth = -std::numeric_limits<float>::max();
+            return;
+        }
+        auto& tile = tiles_[ty * tileCntX_ + tx];
+        if (tile.state == Range_Unknown) {
+            computeTile(tx, ty, tile, false);
+        }
+        minDepth = tile.minDepth;
+        maxDepth = tile.maxDepth;
+    }
+
+    // 光栅化完一个三角形在块内的部分后重新统计被写入过的块，使同一次draw中后续三角形的剔除更有效
+    void refreshBlock(int bx, int by) {
+        if (bx >= blockCntX_ || by >= blockCntY_) {
+            return;
+        }
+        auto& block = blocks_[by * blockCntX_ + bx];
+        if (block.state == Range_Loose) {
+            computeBlock(bx, by, block);
+        }
+    }
+
+    // 重新统计tile内被写入过的块，并由块归并出tile的范围
+    void refreshTile(int tx, int ty) {
+        if (tx >= tileCntX_ || ty >= tileCntY_) {
+            return;
+        }
+        auto& tile = tiles_[ty * tileCntX_ + tx];
+        if (tile.state == Range_Loose) {
+            computeTile(tx, ty, tile, true);
+        }
+    }
+
+    /*
+     * 判断深度范围[zMin, zMax]内的片元与深度范围[dMin, dMax]内的深度值比较是否一定失败
+     * 只有在所有组合都失败时返回true，比较结果含NaN时不剔除
+     */
+    static inline bool rejectRange(float zMin, float zMax, float dMin, float dMax, DepthFunction func) {
+        switch (func) {
+        case DepthFunc_ALWAYS:
+        case DepthFunc_NOTEQUAL:
+            return false;
+        case DepthFunc_NEVER:
+            return true;
+        default:
+            break;
+        }
+        // 区域内没有可比较的深度值（超出深度缓冲或全部为NaN），深度测试一定失败
+        if (dMin > dMax) {
+            return true;
+        }
+        switch (func) {
+        case DepthFunc_LESS:      return zMin >= dMax;
+        case DepthFunc_LEQUAL:    return zMin > dMax;
+        case DepthFunc_GREATER:   return zMax <= dMin;
+        case DepthFunc_GEQUAL:    return zMax < dMin;
+        case DepthFunc_EQUAL: {
+            const float eps = std::numeric_limits<float>::epsilon();
+            return zMin - dMax > eps || dMin - zMax > eps;
+        }
+        default:
+            break;
+        }
+        return false;
+    }
+
+private:
+    enum RangeState : uint8_t {
+        Range_Exact,   // 与缓冲内容一致
+        Range_Loose,   // 写入后只扩展过，包含全部深度值但可能偏大
+        Range_Unknown, // 需要从缓冲重新统计
+    };
+
+    struct DepthRange {
+        float minDepth;
+        float maxDepth;
+        RangeState state;
+    };
+
+    static inline void expand(DepthRange& range, float depth) {
+        if (range.state == Range_Unknown) {
+            return;
+        }
+        range.minDepth = std::min(range.minDepth, depth);
+        range.maxDepth = std::max(range.maxDepth, depth);
+        range.state = Range_Loose;
+    }
+
+    void computeBlock(int bx, int by, DepthRange& block) {
+        float minDepth = std::numeric_limits<float>::max();
+        float maxDepth = -std::numeric_limits<float>::max();
+        int x0 = bx * BLOCK_SIZE;
+        int y0 = by * BLOCK_SIZE;
+        int x1 = std::min(x0 + BLOCK_SIZE, width_);
+        int y1 = std::min(y0 + BLOCK_SIZE, height_);
+        // 块不会跨越延迟清除的tile，待清除的tile直接取清除值
+        if (depth_->isClearedAt(x0, y0)) {
+            float clearDepth = depth_->getClearValue();
+            block = { clearDepth, clearDepth, Range_Exact };
+            return;
+        }
+        // 线性布局的单采样缓冲按行直接访问，光栅化过程中每个块都可能被频繁重新统计
+        if (!depth_->multiSample && depth_->buffer->getLayout() == Layout_Linear) {
+            const float* data = depth_->buffer->getRawDataPtr();
+            size_t stride = depth_->buffer->getInnerWidth();
+            for (int y = y0; y < y1; y++) {
+                const float* row = data + y * stride;
+                for (int x = x0; x < x1; x++) {
+                    minDepth = std::min(minDepth, row[x]);
+                    maxDepth = std::max(maxDepth, row[x]);
+                }
+            }
+            block = { minDepth, maxDepth, Range_Exact };
+            return;
+        }
+        for (int y = y0; y < y1; y++) {
+            for (int x = x0; x < x1; x++) {
+                // NaN不会通过除ALWAYS以外的深度比较，不计入范围
+                if (depth_->multiSample) {
+                    float* ptr = depth_->getSamples(x, y);
+                    for (int s = 0; s < depth_->sampleCnt; s++) {
+                        float value = ptr[s];
+                        minDepth = std::min(minDepth, value);
+                        maxDepth = std::max(maxDepth, value);
+                    }
+                }
+                else {
+                    float value = *depth_->buffer->get(x, y);
+                    minDepth = std::min(minDepth, value);
+                    maxDepth = std::max(maxDepth, value);
+                }
+            }
+        }
+        block = { minDepth, maxDepth, Range_Exact };
+    }
+
+    // tile范围由其包含的块归并，refreshLoose为true时同时重新统计被写入过的块
+    void computeTile(int tx, int ty, DepthRange& tile, bool refreshLoose) {
+        float minDepth = std::numeric_limits<float>::max();
+        float maxDepth = -std::numeric_limits<float>::max();
+        RangeState state = Range_Exact;
+        int bx0 = tx * blockInTile_;
+        int by0 = ty * blockInTile_;
+        int bx1 = std::min(bx0 + blockInTile_, blockCntX_);
+        int by1 = std::min(by0 + blockInTile_, blockCntY_);
+        for (int by = by0; by < by1; by++) {
+            for (int bx = bx0; bx < bx1; bx++) {
+                auto& block = blocks_[by * blockCntX_ + bx];
+                if (block.state == Range_Unknown || (refreshLoose && block.state == Range_Loose)) {
+                    computeBlock(bx, by, block);
+                }
+                minDepth = std::min(minDepth, block.minDepth);
+                maxDepth = std::max(maxDepth, block.maxDepth);
+                if (block.state == Range_Loose) {
+                    state = Range_Loose;
+                }
+            }
+        }
+        tile = { minDepth, maxDepth, state };
+    }
+
+private:
+    ImageBufferSoft<float>* depth_ = nullptr;
+    int width_ = 0;
+    int height_ = 0;
+    int tileSize_ = 0;
+    int blockCntX_ = 0;
+    int blockCntY_ = 0;
+    int tileCntX_ = 0;
+    int tileCntY_ = 0;
+    int blockInTile_ = 1;
+    std::vector<DepthRange> blocks_;
+    std::vector<DepthRange> tiles_;
+};
+
+}
+
+#endif
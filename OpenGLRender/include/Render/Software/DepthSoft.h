@@ -18,6 +18,19 @@ namespace OpenGL {
         }
         return a < b;
     }
+
+    // 比较函数在编译期确定的版本，供特化的光栅化内核使用
+    template<DepthFunction func>
+    inline bool DepthTest(float a, float b) {
+        if constexpr (func == DepthFunc_NEVER)         return false;
+        else if constexpr (func == DepthFunc_LESS)     return a < b;
+        else if constexpr (func == DepthFunc_EQUAL)    return std::fabs(a - b) <= std::numeric_limits<float>::epsilon();
+        else if constexpr (func == DepthFunc_LEQUAL)   return a <= b;
+        else if constexpr (func == DepthFunc_GREATER)  return a > b;
+        else if constexpr (func == DepthFunc_NOTEQUAL) return std::fabs(a - b) > std::numeric_limits<float>::epsilon();
+        else if constexpr (func == DepthFunc_GEQUAL)   return a >= b;
+        else return true;
+    }
 }
 
 #endif
@@ -2,6 +2,7 @@
 #define RENDERERINTERNAL_H
 
 #include "Base/MemoryUtils.h"
+#include "Render/PipelineStates.h"
 #include "Render/Software/ShaderProgramSoft.h"
 
 namespace OpenGL {
@@ -33,10 +34,57 @@ struct VertexHolder {
     int clipMask = 0; // 裁剪空间掩码(6个裁剪平面)，
     glm::aligned_vec4 clipPos = glm::vec4(0.f);     // 裁剪空间坐标，经过顶点着色器处理后得出
     glm::aligned_vec4 fragPos = glm::vec4(0.f);     // 屏幕空间坐标
-    std::shared_ptr<uint8_t> vertexHolder = nullptr; //顶点数据内存块
-    std::shared_ptr<float> varyingsHolder = nullptr; //varying数据内存块
 };                                                                                  
 
+// 裁剪产生的新顶点的varyings内存池：按块分配，draw开始时重置，块内存跨draw复用
+// 同一次draw内已分配的指针保持有效（vertexes_扩容不会影响它们）
+class VaryingsArena {
+public:
+    // 回收所有已分配的内存（不释放）
+    void Reset() {
+        blockIdx_ = 0;
+        blockUsed_ = 0;
+    }
+
+    // 分配elemCnt个float，起始地址按OPENGL_ALIGNMENT对齐（elemCnt需为对齐后的数量）
+    float* Allocate(size_t elemCnt) {
+        if (elemCnt == 0) {
+            return nullptr;
+        }
+        while (blockIdx_ < blocks_.size()) {
+            auto& block = blocks_[blockIdx_];
+            if (block.capacity - blockUsed_ >= elemCnt) {
+                float* ptr = block.data.get() + blockUsed_;
+                blockUsed_ += elemCnt;
+                return ptr;
+            }
+            blockIdx_++;
+            blockUsed_ = 0;
+        }
+
+        Block block;
+        block.capacity = std::max(kBlockFloatCnt, elemCnt);
+        block.data = MemoryUtils::makeAlignedBuffer<float>(block.capacity);
+        blocks_.push_back(std::move(block));
+        blockUsed_ = elemCnt;
+        return blocks_.back().data.get();
+    }
+
+private:
+    struct Block {
+        std::shared_ptr<float> data = nullptr;
+        size_t capacity = 0;
+    };
+
+    static constexpr size_t kBlockFloatCnt = 16 * 1024; // 每块64KB
+    std::vector<Block> blocks_;
+    size_t blockIdx_ = 0;
+    size_t blockUsed_ = 0;
+};
+
+// 单个三角形被6个裁剪平面裁剪后最多产生的顶点数（每个平面最多增加一个顶点），另加一个闭合用的重复顶点
+constexpr int CLIP_MAX_POLYGON_VERTEX = 3 + 6 + 1;
+
 // 图元数据容器，图元装配阶段
 struct PrimitiveHolder {
     bool discard = false;
@@ -44,6 +92,29 @@ struct PrimitiveHolder {
     size_t indices[3] = { 0, 0, 0 };
 };
 
+// 定点数光栅化：屏幕坐标使用4位亚像素精度（1/16像素）
+constexpr int RASTER_SUBPIXEL_BITS = 4;
+constexpr int RASTER_SUBPIXEL_ONE = 1 << RASTER_SUBPIXEL_BITS;
+// 一次边函数求值覆盖的最大采样点数：8xMSAA时一个2x2像素块有32个采样点+4个像素中心，补齐到8的倍数
+constexpr int RASTER_MAX_LANES = 40;
+// 支持的最大采样数（1 / 2 / 4 / 8）
+constexpr int RASTER_MAX_SAMPLES = 8;
+
+// 多重采样时像素块的lane数：每个像素的采样点连续排列（lane = 像素 * 采样数 + 采样点），之后是4个像素中心，补齐到8的倍数
+inline int RasterLaneCount(int sampleCnt) {
+    return sampleCnt > 1 ? (4 * sampleCnt + 4 + 7) & ~7 : 8;
+}
+
+// 三角形的定点数边函数 E_i(p) = a[i] * p.x + b[i] * p.y + c[i]，i为对边顶点序号，三角形内部为正
+struct EdgeFunctions {
+    int32_t a[3] = { 0, 0, 0 };
+    int32_t b[3] = { 0, 0, 0 };
+    int32_t threshold[3] = { 0, 0, 0 }; // E > threshold 时覆盖：满足top-left规则的边为-1（包含边上的点），否则为0
+    int32_t originValue[3] = { 0, 0, 0 }; // 在光栅化起点处的值
+    float invArea = 0.f; // 1 / (E0 + E1 + E2)，用于将边函数值转换为重心坐标
+    bool degenerate = false; // 定点化后面积为0，不覆盖任何采样点
+};
+
 // 采样点内容
 class SampleContext {
 public:
@@ -67,6 +138,41 @@ public:
         return location_4x;
     }
 
+    // 2x与8x使用D3D标准采样点位置
+    inline static glm::vec2* GetSampleLocation2X() {
+        static glm::vec2 location_2x[2] = {
+            {0.75f, 0.75f},
+            {0.25f, 0.25f},
+        };
+        return location_2x;
+    }
+
+    inline static glm::vec2* GetSampleLocation8X() {
+        static glm::vec2 location_8x[8] = {
+            {0.5625f, 0.3125f},
+            {0.4375f, 0.6875f},
+            {0.8125f, 0.5625f},
+            {0.3125f, 0.1875f},
+            {0.1875f, 0.8125f},
+            {0.0625f, 0.4375f},
+            {0.6875f, 0.9375f},
+            {0.9375f, 0.0625f},
+        };
+        return location_8x;
+    }
+
+    // 获取sample_cnt个采样点的位置，不支持的采样数返回nullptr
+    inline static glm::vec2* GetSampleLocation(int sample_cnt) {
+        switch (sample_cnt) {
+            case 2: return GetSampleLocation2X();
+            case 4: return GetSampleLocation4X();
+            case 8: return GetSampleLocation8X();
+            default:
+                break;
+        }
+        return nullptr;
+    }
+
     // 初始化像素上下文
     void Init(float x, float y, int sample_cnt = 1) {
         inside = false;
@@ -74,15 +180,16 @@ public:
         coverage = 0;
         if (sampleCount > 1) {
             samples.resize(sampleCount + 1);  //多重采样: 存储额外采样点+中心点
-            if (sampleCount == 4) { // 初始化4个采样点位置
+            glm::vec2* location = GetSampleLocation(sampleCount);
+            if (location) { // 初始化采样点位置
                 for (int i = 0; i < sampleCount; i++) {
                     samples[i].fboCoord = glm::ivec2(x, y);
-                    samples[i].position = glm::vec4(GetSampleLocation4X()[i] + glm::vec2(x, y), 0.f, 0.f);
+                    samples[i].position = glm::vec4(location[i] + glm::vec2(x, y), 0.f, 0.f);
                 }
                 // pixel center
-                samples[4].fboCoord = glm::ivec2(x, y);
-                samples[4].position = glm::vec4(x + 0.5f, y + 0.5f, 0.f, 0.f);
-                sampleShading = &samples[4];
+                samples[sampleCount].fboCoord = glm::ivec2(x, y);
+                samples[sampleCount].position = glm::vec4(x + 0.5f, y + 0.5f, 0.f, 0.f);
+                sampleShading = &samples[sampleCount];
             }
             else {
                 // not support
@@ -133,7 +240,7 @@ public:
     float* varyingsFrag = nullptr; // 纹理坐标、法线向量、.....
     std::vector<SampleContext> samples; // 采样点
     SampleContext* sampleShading = nullptr; // 当前用于着色的采样点
-    int sampleCount = 0; // 采样数(1 / 4)
+    int sampleCount = 0; // 采样数(1 / 2 / 4 / 8)
     int coverage = 0; // 覆盖率(有效采样点数)
 };
 
@@ -188,14 +295,32 @@ public:
     // triangle Facing
     bool frontFacing = true;
 
+    // 定点数边函数，以及每个lane（采样点）相对像素块原点的边函数增量与求得的重心坐标
+    EdgeFunctions edges;
+    alignas(32) int32_t edgeLaneOffset[3][RASTER_MAX_LANES];
+    alignas(32) float laneBarycentric[3][RASTER_MAX_LANES];
+
     // shader program
     std::shared_ptr<ShaderProgramSoft> shaderProgram = nullptr;
+    bool quadShading = false; // 片段着色器以2x2像素块打包执行
+    ShaderQuad shaderQuad;
 
 private:
     size_t varyingsAlignedCnt_ = 0; // varying数据对齐大小
     std::shared_ptr<float> varyingsPool_ = nullptr; // varying数据内存池
 };
 
+// 光栅化内核的编译期管线状态，每种组合实例化一份像素块处理函数，消除逐采样点的状态分支
+template<bool DepthTest, DepthFunction DepthFn, bool DepthWrite, bool ColorWrite, bool BlendAlpha, bool MultiSample>
+struct RasterKernelState {
+    static constexpr bool depthTest = DepthTest;
+    static constexpr DepthFunction depthFunc = DepthFn;
+    static constexpr bool depthWrite = DepthWrite;
+    static constexpr bool colorWrite = ColorWrite;
+    static constexpr bool blendAlpha = BlendAlpha; // SRC_ALPHA, ONE_MINUS_SRC_ALPHA, ADD
+    static constexpr bool multiSample = MultiSample; // MSAA，采样数在运行时确定
+};
+
 }
 
 #endif
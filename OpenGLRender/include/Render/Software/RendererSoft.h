@@ -2,15 +2,22 @@
 #define RENDERERSOFT_H
 
 #include <memory>
+#include <unordered_map>
 #include "Render/Renderer.h"
 #include "Render/Software/RendererInternal.h"
 #include "Base/Geometry.h"
 #include "Base/ThreadPool.h"
 #include "Render/Software/VertexSoft.h"
 #include "Render/Software/FramebufferSoft.h"
+#include "Render/Software/DepthPyramidSoft.h"
+#include "Render/Software/SIMDKernelsSoft.h"
 namespace OpenGL {
 class RendererSoft : public Renderer {
 public:
+	RendererSoft() = default;
+	// threadCnt为0时所有阶段都在调用线程执行，用于由外部并行调度多个渲染器的场景（如IBL预计算）
+	explicit RendererSoft(size_t threadCnt) : threadPool_(threadCnt) {}
+
 	RendererType type() override { return Renderer_SOFT; }
 	//**********************************资源创建接口*************************************
 	// framebuffer
@@ -45,10 +52,22 @@ public:
 
 public:
 	inline void setEnableEarlyZ(bool enable) { earlyZ_ = enable; };
+	// 着色器支持时以2x2像素块打包执行片段着色器，关闭后全部逐像素执行
+	inline void setEnableQuadShading(bool enable) { quadShading_ = enable; };
+	// 按深度、混合、采样数等管线状态选择编译期特化的光栅化内核，关闭后全部使用通用实现
+	inline void setEnableRasterKernels(bool enable) { rasterKernels_ = enable; };
+	// 清除时只标记tile，第一次写入tile时才填充清除值，关闭后清除时立即填充整个附件
+	inline void setEnableFastClear(bool enable) { fastClear_ = enable; };
+	// 多重采样颜色缓冲中所有采样点相同的像素只存储并解析一个颜色，关闭后每个采样点都单独写入
+	inline void setEnableSampleCompression(bool enable) { sampleCompression_ = enable; };
+	// 变换后顶点缓存的累计命中统计
+	inline const VertexCacheStats& getVertexCacheStats() const { return vertexCacheStats_; }
+	inline void resetVertexCacheStats() { vertexCacheStats_ = {}; }
 
 private:
 	/*******************************  图形管线处理阶段  *********************************/
 	void processVertexShader();
+	void processVertexShaderBatch(ShaderProgramSoft* program, size_t start, size_t end);
 	void processPrimitiveAssembly();
 	void processClipping();
 	void processPerspectiveDivide();
@@ -56,6 +75,7 @@ private:
 	void processFaceCulling();
 	void processRasterization();
 	void processFragmentShader(glm::aligned_vec4& screenPos, bool frontFacing, void* varyings, ShaderProgramSoft* shader);
+	void processFragmentShaderQuad(PixelQuadContext& quad);
 	void processPerSampleOperations(int x, int y, float depth, const glm::vec4& color, int sample);
 	bool processDepthTest(int x, int y, float depth, int sample, bool skipWrite);
 	void processColorBlending(int x, int y, glm::vec4& color, int sample);
@@ -71,27 +91,82 @@ private:
 	void interpolateVertex(VertexHolder& out, VertexHolder& v0, VertexHolder& v1, float t);
 	void interpolateLinear(float* varsOut, const float* varsIn[2], size_t elemCnt, float t);
 	void interpolateBarycentric(float* varsOut, const float* varsIn[3], size_t elemCnt, glm::aligned_vec4& bc);
-	void interpolateBarycentricSIMD(float* varsOut, const float* varsIn[3], size_t elemCnt, glm::aligned_vec4& bc);
 	/*******************************  光栅化算法  *********************************/
-	void rasterizationPoint(VertexHolder* v, float pointSize);
-	void rasterizationLine(VertexHolder* v0, VertexHolder* v1, float lineWidth);
-	void rasterizationTriangle(VertexHolder* v0, VertexHolder* v1, VertexHolder* v2, bool frontFacing);
+	void rasterizationPoint(PixelQuadContext& quad, const glm::aligned_vec4& fragPos, float* varyings, float pointSize,
+	                        const glm::ivec4& tileRect);
+	void rasterizationLine(PixelQuadContext& quad, VertexHolder* v0, VertexHolder* v1, float lineWidth,
+	                       const glm::ivec4& tileRect);
+	void rasterizationPoints(std::vector<PrimitiveHolder>& points, float pointSize);
+	void rasterizationLines(std::vector<PrimitiveHolder>& lines, float lineWidth);
+	void rasterizationTilePoints(int tileX, int tileY, PixelQuadContext& quad, std::vector<PrimitiveHolder>& points, float pointSize);
+	void rasterizationTileLines(int tileX, int tileY, PixelQuadContext& quad, std::vector<PrimitiveHolder>& lines, float lineWidth);
+	void rasterizationTriangle(PixelQuadContext& quad, VertexHolder* v0, VertexHolder* v1, VertexHolder* v2, bool frontFacing, int tileX, int tileY);
+	void rasterizationTile(int tileX, int tileY, PixelQuadContext& quad);
 	void rasterizationPolygons(std::vector<PrimitiveHolder>& primitives);
 	void rasterizationPolygonsPoint(std::vector<PrimitiveHolder>& primitives);
 	void rasterizationPolygonsLine(std::vector<PrimitiveHolder>& primitives);
 	void rasterizationPolygonsTriangle(std::vector<PrimitiveHolder>& primitives);
 	void rasterizationPixelQuad(PixelQuadContext& quad);
+	template<typename State>
+	void rasterizationPixelQuadKernel(PixelQuadContext& quad);
+	void interpolatePixelQuadDepth(PixelQuadContext& quad);
+	void shadingPixelQuad(PixelQuadContext& quad);
+	const glm::vec4& shadingPixel(PixelQuadContext& quad, int idx);
+	void rasterizationBlock(PixelQuadContext& quad, const int32_t* blockValue, int x, int y, int endX);
+	bool rasterizationBlockVisible(PixelQuadContext& quad, int blockX, int blockY, int startX, int startY,
+	                               bool cullDepth, float triZMin, float triZMax);
+	bool rasterizationSetupEdges(PixelQuadContext& quad, int startX, int startY, int endX, int endY);
+	template<typename Func>
+	void rasterizationTiles(const Func& rasterTile);
+	void prepareTile(int tileX, int tileY);
+	glm::ivec4 getTileRect(int tileX, int tileY);
+	void resetTileBins();
+	void binningBounds(size_t idx, const BoundingBox& bounds);
+	void binningTriangles(std::vector<PrimitiveHolder>& primitives);
+	void binningPrimitives(std::vector<PrimitiveHolder>& primitives, int vertexCnt, float size);
+	bool insertEdge(size_t idx0, size_t idx1);
 	/*******************************  高级特性  *********************************/
 	bool earlyZTest(PixelQuadContext& quad);
+	template<typename State>
+	bool earlyZTestKernel(PixelQuadContext& quad);
+	template<typename State>
+	bool depthTestKernel(int x, int y, float depth, int sample);
+	template<typename State>
+	void processPerSampleKernel(int x, int y, float depth, const glm::vec4* color, int sample);
+	template<typename State>
+	void processPixelSamplesKernel(PixelContext& pixel, const glm::vec4* color);
+	template<typename State>
+	inline void writeDepthKernel(int x, int y, float depth, int sample);
+	template<typename State>
+	inline void storeColorKernel(const glm::vec4& color, RGBA* ptr);
+	bool depthRangeOccluded(float zMin, float zMax, float dMin, float dMax);
 	void multiSampleResolve();
+	void multiSampleResolveRow(const RGBA* src, RGBA* dst, int row);
+	void multiSampleResolveSpan(const RGBA* src, RGBA* dst, int row, size_t x, size_t cnt);
+	void resolveSamples(const RGBA* src, RGBA* dst, size_t count, int sampleCnt);
 private:
 	/*******************************  帧缓冲访问  *********************************/
 	inline RGBA* getFrameColor(int x, int y, int sample);
 	inline float* getFrameDepth(int x, int y, int sample);
 	inline void setFrameColor(int x, int y, const RGBA& color, int sample);
+	template<typename State>
+	inline float* getFrameDepthKernel(int x, int y, int sample);
+	/*******************************  光栅化内核选择  *********************************/
+	using RasterQuadFunc = void (RendererSoft::*)(PixelQuadContext& quad);
+	RasterQuadFunc selectRasterKernel();
+	template<DepthFunction DepthFn>
+	RasterQuadFunc selectRasterKernelDepthWrite();
+	template<bool DepthTest, DepthFunction DepthFn, bool DepthWrite>
+	RasterQuadFunc selectRasterKernelColor();
+	template<bool DepthTest, DepthFunction DepthFn, bool DepthWrite, bool ColorWrite, bool BlendAlpha>
+	RasterQuadFunc selectRasterKernelSamples();
 	/*******************************  辅助函数  *********************************/
+	template<typename T>
+	void clearImageBuffer(ImageBufferSoft<T>& image, const T& value);
+	void prepareClearTiles();
+	void initThreadContexts();
+	std::vector<std::shared_ptr<ShaderProgramSoft>>& getThreadPrograms(size_t threadCnt);
 	size_t clippingNewVertex(size_t idx0, size_t idx1, float t, bool postVertexProcess = false);
-	void vertexShaderImpl(VertexHolder& vertex);
 	void perspectiveDivideImpl(VertexHolder& vertex);
 	void viewportTransformImpl(VertexHolder& vertex);
 	int countFrustumClipMask(glm::aligned_vec4& clipPos);
@@ -107,25 +182,55 @@ private:
 	const RenderStates* renderState_ = nullptr;
 	VertexArrayObjectSoft* vao_ = nullptr;
 	ShaderProgramSoft* shaderProgram_ = nullptr;
+	std::weak_ptr<ShaderProgram> shaderProgramRef_;
 	//------------------------------帧缓冲资源--------------------------------
 	std::shared_ptr<ImageBufferSoft<RGBA>> fboColor_ = nullptr;
 	std::shared_ptr<ImageBufferSoft<float>> fboDepth_ = nullptr;
+	DepthPyramidSoft depthPyramid_; // 深度缓冲的分层最小/最大值，用于整块、整三角形的遮挡剔除
 	//--------------------------- 临时数据存储-------------------------------
 	std::vector<VertexHolder> vertexes_; // 处理中的顶点
 	std::vector<PrimitiveHolder> primitives_; // 处理中的图元，其中包含顶点索引
+	std::vector<PrimitiveHolder> clipAppendPrimitives_; // 裁剪后多边形三角化新增的图元，处理完后追加到primitives_
+	VaryingsArena clipVaryings_; // 裁剪新顶点的varyings存储，每次draw重置
 	//----------------------------着色器变量存储----------------------------------
 	std::shared_ptr<float> varyings_ = nullptr;// 存放所有顶点着色器输出给片段着色器的内容
 	size_t varyingsCnt_ = 0;
 	size_t varyingsAlignedCnt_ = 0;
 	size_t varyingsAlignedSize_ = 0;
+	size_t varyingsCapacity_ = 0; // varyings_已分配的float数量，只增不减
 	//----------------------------渲染配置参数----------------------------
 	float pointSize_ = 1.f;
 	bool earlyZ_ = true;
+	bool quadShading_ = true;
+	bool rasterKernels_ = true;
+	bool fastClear_ = true;
+	bool sampleCompression_ = true;
+	const SIMDKernels* simd_ = &SIMDDispatch::kernels(); // 当前draw使用的SIMD内核，每次draw开始时重新获取
+	RasterQuadFunc rasterPixelQuad_ = &RendererSoft::rasterizationPixelQuad; // 当前draw使用的像素块光栅化实现
+	bool depthCulling_ = false; // 当前draw是否启用分层深度剔除
 	int rasterSamples_ = 1;
-	int rasterBlockSize_ = 32;
+	VertexCacheStats vertexCacheStats_;
+	int rasterBlockSize_ = 32; // 屏幕分块(tile)大小，需为8的倍数以保证2x2像素块和分层深度的8x8块不跨tile
+	size_t vertexBatchSize_ = 512; // 顶点着色阶段每个任务处理的最少顶点数
 	//---------------------------------并行处理--------------------------------------
 	ThreadPool threadPool_;
 	std::vector<PixelQuadContext> threadQuadCtx_;
+	// 每个线程的着色器程序副本，按程序id缓存，程序重新设置着色器后才重新克隆
+	struct ThreadPrograms {
+		std::weak_ptr<ShaderProgram> source;
+		uint32_t version = 0;
+		std::vector<std::shared_ptr<ShaderProgramSoft>> programs;
+	};
+	std::unordered_map<int, ThreadPrograms> threadPrograms_;
+	//---------------------------------分块分箱--------------------------------------
+	int tileCntX_ = 0;
+	int tileCntY_ = 0;
+	std::vector<std::vector<size_t>> tileBins_; // 每个tile覆盖的图元在当前图元数组中的下标（保持提交顺序）
+	//---------------------------------多边形点/线框模式--------------------------------------
+	static constexpr uint64_t EDGE_EMPTY = ~0ull;
+	std::vector<PrimitiveHolder> polygonPrimitives_; // 由三角形生成并去重、裁剪后的点或线段图元
+	std::vector<uint64_t> edgeSet_; // 线框模式已绘制的边，开放寻址哈希表，键为两个顶点下标
+	std::vector<uint8_t> pointVisited_; // 点模式中每个顶点是否已绘制
 };
 }
 
@@ -0,0 +1,46 @@
+#ifndef SIMDKERNELSSOFT_H
+#define SIMDKERNELSSOFT_H
+
+#include "Base/CPUFeatures.h"
+#include "Render/Software/RendererInternal.h"
+
+namespace OpenGL {
+
+// 软光栅热点循环的一组实现，每个指令集级别一份，运行时按CPU支持情况选择
+struct SIMDKernels {
+	SIMDLevel level = SIMDLevel_SCALAR;
+
+	// varsOut = varsIn[0] * bc[0] + varsIn[1] * bc[1] + varsIn[2] * bc[2]，非标量版本要求指针按SOFTGL_ALIGNMENT对齐
+	void (*interpolateBarycentric)(float* varsOut, const float* varsIn[3], size_t elemCnt, const glm::aligned_vec4& bc) = nullptr;
+
+	// 对laneCnt（8的倍数）个lane求边函数，返回覆盖掩码并写出各lane的重心坐标
+	uint64_t (*edgeCoverage)(const EdgeFunctions& edges, const int32_t* blockValue,
+	                         const int32_t (*laneOffset)[RASTER_MAX_LANES], float (*laneBarycentric)[RASTER_MAX_LANES],
+	                         int laneCnt) = nullptr;
+
+	// 将颜色截断到[0, 1]后写入RGBA8，BlendAlpha版本先与dst做SRC_ALPHA, ONE_MINUS_SRC_ALPHA混合
+	void (*storeColor)(const glm::vec4& color, RGBA* dst) = nullptr;
+	void (*storeColorBlendAlpha)(const glm::vec4& color, RGBA* dst) = nullptr;
+
+	// 4x MSAA解析：每个像素的4个采样点取平均
+	void (*resolveColor4x)(const glm::tvec4<RGBA>* src, RGBA* dst, size_t count) = nullptr;
+};
+
+class SIMDDispatch {
+public:
+	// 当前使用的内核。首次调用时检测CPU，环境变量SOFTGL_SIMD（scalar/sse4.1/avx2/avx512）可以指定更低的级别
+	static const SIMDKernels& kernels();
+
+	// 指定级别的内核，超过maxLevel()时降为maxLevel()
+	static const SIMDKernels& kernels(SIMDLevel level);
+
+	// 切换当前使用的内核，返回实际生效的级别
+	static SIMDLevel setLevel(SIMDLevel level);
+
+	// CPU与编译选项都支持的最高级别
+	static SIMDLevel maxLevel();
+};
+
+}
+
+#endif
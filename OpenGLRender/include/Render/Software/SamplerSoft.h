@@ -5,13 +5,37 @@
 #include "Render/Software/TextureSoft.h"
 
 namespace OpenGL {
-// 适用于周期性边界
-#define CoordMod(i, n) ((i) & ((n) - 1) + (n)) & ((n) - 1)  // (i % n + n) % n
-#define CoordMirror(i) (i) >= 0 ? (i) : (-1 - (i))
+
+// 按环绕模式把纹理坐标映射到[0, size)，CLAMP_TO_BORDER越界时返回false
+template<WrapMode Wrap>
+inline bool wrapTexelCoord(int& x, int size) {
+    if constexpr (Wrap == Wrap_REPEAT) {
+        x %= size;
+        if (x < 0) x += size;
+    }
+    else if constexpr (Wrap == Wrap_MIRRORED_REPEAT) {
+        x %= 2 * size;
+        if (x < 0) x += 2 * size;
+        x -= size;
+        x = x >= 0 ? x : (-1 - x);
+        x = size - 1 - x;
+    }
+    else if constexpr (Wrap == Wrap_CLAMP_TO_EDGE) {
+        if (x < 0) x = 0;
+        if (x >= size) x = size - 1;
+    }
+    else {
+        if (x < 0 || x >= size) return false;
+    }
+    return true;
+}
 
 template<typename T>
 class BaseSampler {
 public:
+    // 单个mipmap层级的采样函数，按缓冲区布局、环绕模式和过滤方式特化
+    using LevelSampleFunc = T(*)(Buffer<T>* buffer, const glm::vec2& uv, const glm::ivec2& offset, T border);
+
     virtual bool empty() = 0;
     inline size_t width() const { return width_; }
     inline size_t height() const { return height_; }
@@ -31,12 +55,17 @@ public:
     static void sampleBufferBilinear(Buffer<T>* buffer_out, Buffer<T>* buffer_in, T border);
     static T samplePixelBilinear(Buffer<T>* buffer, glm::vec2 uv, WrapMode wrap, T border);// uv像素坐标
 
+    // 选择布局、环绕模式、过滤方式对应的特化采样函数
+    static LevelSampleFunc getLevelSampleFunc(BufferLayout layout, WrapMode wrap, bool linear);
+
     inline void setWrapMode(int wrap_mode) {
         wrapMode_ = (WrapMode)wrap_mode;
+        updateSampleFunc();
     }
 
     inline void setFilterMode(int filter_mode) {
         filterMode_ = (FilterMode)filter_mode;
+        updateSampleFunc();
     }
 
     inline void setLodFunc(std::function<float(BaseSampler<T>*)>* func) {
@@ -45,6 +74,39 @@ public:
 
     static void generateMipmaps(TextureImageSoft<T>* tex, bool sample);
 
+protected:
+    inline void setLayout(BufferLayout layout) {
+        layout_ = layout;
+        updateSampleFunc();
+    }
+
+    // 环绕模式、过滤方式和布局在绑定纹理时确定，每次采样不再逐像素判断
+    inline void updateSampleFunc() {
+        bool linear = filterMode_ == Filter_LINEAR
+            || filterMode_ == Filter_LINEAR_MIPMAP_NEAREST
+            || filterMode_ == Filter_LINEAR_MIPMAP_LINEAR;
+        sampleFunc_ = getLevelSampleFunc(layout_, wrapMode_, linear);
+    }
+
+    // 特化的采样实现，寻址与环绕全部在编译期确定
+    template<BufferLayout Layout, WrapMode Wrap>
+    static T texelFetch(const T* data, size_t innerWidth, int w, int h, int x, int y, T border);
+
+    template<BufferLayout Layout, WrapMode Wrap>
+    static T sampleNearestImpl(Buffer<T>* buffer, const glm::vec2& uv, const glm::ivec2& offset, T border);
+
+    template<BufferLayout Layout, WrapMode Wrap>
+    static T sampleBilinearImpl(Buffer<T>* buffer, const glm::vec2& uv, const glm::ivec2& offset, T border);
+
+    template<BufferLayout Layout, WrapMode Wrap>
+    static T samplePixelBilinearImpl(Buffer<T>* buffer, const glm::vec2& uv, T border);
+
+    template<BufferLayout Layout>
+    static T samplePixelBilinearLayout(Buffer<T>* buffer, const glm::vec2& uv, WrapMode wrap, T border);
+
+    template<BufferLayout Layout>
+    static LevelSampleFunc getLayoutSampleFunc(WrapMode wrap, bool linear);
+
 protected:
     T borderColor_;
 
@@ -54,6 +116,8 @@ protected:
     bool useMipmaps = false;
     WrapMode wrapMode_ = Wrap_CLAMP_TO_EDGE;
     FilterMode filterMode_ = Filter_LINEAR;
+    BufferLayout layout_ = Layout_Linear;
+    LevelSampleFunc sampleFunc_ = getLevelSampleFunc(Layout_Linear, Wrap_CLAMP_TO_EDGE, true);
 
     // LOD计算函数指针
     std::function<float(BaseSampler<T>*)>* lodFunc_ = nullptr;
@@ -63,11 +127,8 @@ template<typename T>
 T BaseSampler<T>::textureImpl(TextureImageSoft<T>* tex, glm::vec2& uv, float lod, glm::ivec2 offset) {//lod：mipmap级别
     if (tex != nullptr && !tex->empty()) {
         // -------------------------------------基础非mipmap采样--------------------------------
-        if (filterMode_ == Filter_NEAREST) {
-            return sampleNearest(tex->levels[0]->buffer.get(), uv, wrapMode_, offset, borderColor_);
-        }
-        if (filterMode_ == Filter_LINEAR) {
-            return sampleBilinear(tex->levels[0]->buffer.get(), uv, wrapMode_, offset, borderColor_);
+        if (filterMode_ == Filter_NEAREST || filterMode_ == Filter_LINEAR) {
+            return sampleFunc_(tex->levels[0]->buffer.get(), uv, offset, borderColor_);
         }
 
         // ------------------------------------------使用mipmap的时候----------------------------------------------
@@ -75,12 +136,7 @@ T BaseSampler<T>::textureImpl(TextureImageSoft<T>* tex, glm::vec2& uv, float lod
         // -------------------最近mipmap层级选择（不混合）--------------------
         if (filterMode_ == Filter_NEAREST_MIPMAP_NEAREST || filterMode_ == Filter_LINEAR_MIPMAP_NEAREST) {
             int level = glm::clamp((int)glm::ceil(lod + 0.5f) - 1, 0, max_level);// 计算目标mipmap级别（四舍五入）
-            if (filterMode_ == Filter_NEAREST_MIPMAP_NEAREST) {
-                return sampleNearest(tex->levels[level]->buffer.get(), uv, wrapMode_, offset, borderColor_);
-            }
-            else {
-                return sampleBilinear(tex->levels[level]->buffer.get(), uv, wrapMode_, offset, borderColor_);
-            }
+            return sampleFunc_(tex->levels[level]->buffer.get(), uv, offset, borderColor_);
         }
         // -----------------三线性插值（混合）-----------------------
         if (filterMode_ == Filter_NEAREST_MIPMAP_LINEAR || filterMode_ == Filter_LINEAR_MIPMAP_LINEAR) {
@@ -88,25 +144,12 @@ T BaseSampler<T>::textureImpl(TextureImageSoft<T>* tex, glm::vec2& uv, float lod
             int level_hi = glm::clamp((int)std::floor(lod), 0, max_level);
             int level_lo = glm::clamp(level_hi + 1, 0, max_level);
 
-            T texel_hi, texel_lo;
-            if (filterMode_ == Filter_NEAREST_MIPMAP_LINEAR) {
-                texel_hi = sampleNearest(tex->levels[level_hi]->buffer.get(), uv, wrapMode_, offset, borderColor_);
-            }
-            else {
-                texel_hi = sampleBilinear(tex->levels[level_hi]->buffer.get(), uv, wrapMode_, offset, borderColor_);
-            }
+            T texel_hi = sampleFunc_(tex->levels[level_hi]->buffer.get(), uv, offset, borderColor_);
             // 如果两个层级相同（如lod=0且max_level=0）
             if (level_hi == level_lo) {
                 return texel_hi;
             }
-            else {
-                if (filterMode_ == Filter_NEAREST_MIPMAP_LINEAR) {
-                    texel_lo = sampleNearest(tex->levels[level_lo]->buffer.get(), uv, wrapMode_, offset, borderColor_);
-                }
-                else {
-                    texel_lo = sampleBilinear(tex->levels[level_lo]->buffer.get(), uv, wrapMode_, offset, borderColor_);
-                }
-            }
+            T texel_lo = sampleFunc_(tex->levels[level_lo]->buffer.get(), uv, offset, borderColor_);
 
             float f = glm::fract(lod);// 插值系数
             return glm::mix(texel_hi, texel_lo, f);
@@ -127,9 +170,12 @@ void BaseSampler<T>::generateMipmaps(TextureImageSoft<T>* tex, bool sample) {
     tex->levels[0] = level0;
 
     // 计算mipmap级别总数（基于最大尺寸的对数）
+    // 各级别与level 0使用相同的内存布局，采样器按level 0的布局选择采样函数
     uint32_t levelCount = static_cast<uint32_t>(std::floor(std::log2(std::max(width, height)))) + 1;
+    BufferLayout layout = level0->buffer->getLayout();
     for (uint32_t level = 1; level < levelCount; level++) {
-        tex->levels.push_back(std::make_shared<ImageBufferSoft<T>>(std::max(1, width >> level), std::max(1, height >> level)));
+        auto buffer = Buffer<T>::makeLayout(std::max(1, width >> level), std::max(1, height >> level), layout);
+        tex->levels.push_back(std::make_shared<ImageBufferSoft<T>>(buffer));
     }
 
     if (!sample) {
@@ -147,41 +193,138 @@ void TextureImageSoft<T>::generateMipmap(bool sample) {
 }
 
 template<typename T>
-T BaseSampler<T>::pixelWithWrapMode(Buffer<T>* buffer, int x, int y, WrapMode wrap, T border) {
+template<BufferLayout Layout, WrapMode Wrap>
+inline T BaseSampler<T>::texelFetch(const T* data, size_t innerWidth, int w, int h, int x, int y, T border) {
+    if (!wrapTexelCoord<Wrap>(x, w) || !wrapTexelCoord<Wrap>(y, h)) {
+        return border;
+    }
+    return data[BufferLayoutType<T, Layout>::type::layoutIndex(x, y, innerWidth)];
+}
+
+template<typename T>/*最近邻采样实现*/
+template<BufferLayout Layout, WrapMode Wrap>
+T BaseSampler<T>::sampleNearestImpl(Buffer<T>* buffer, const glm::vec2& uv, const glm::ivec2& offset, T border) {
+    const T* data = buffer->getRawDataPtr();
+    if (data == nullptr) {
+        return T(0);
+    }
     int w = (int)buffer->getWidth();
     int h = (int)buffer->getHeight();
-    switch (wrap) {// 根据环绕模式进行坐标转换
-        case Wrap_REPEAT: {
-            x = CoordMod(x, w);
-            y = CoordMod(y, h);
-            break;
+    glm::vec2 texUV = uv * glm::vec2(w, h);
+
+    // 取整并应用偏移量（向下取整保证一致性）
+    auto x = (int)glm::floor(texUV.x) + offset.x; // offset 像素偏移量（用于各向异性采样等场景）
+    auto y = (int)glm::floor(texUV.y) + offset.y;
+
+    return texelFetch<Layout, Wrap>(data, buffer->getInnerWidth(), w, h, x, y, border);
+}
+
+template<typename T>
+template<BufferLayout Layout, WrapMode Wrap>
+T BaseSampler<T>::sampleBilinearImpl(Buffer<T>* buffer, const glm::vec2& uv, const glm::ivec2& offset, T border) {
+    glm::vec2 texUV = uv * glm::vec2(buffer->getWidth(), buffer->getHeight());
+    texUV.x += (float)offset.x;
+    texUV.y += (float)offset.y;
+    return samplePixelBilinearImpl<Layout, Wrap>(buffer, texUV, border);
+}
+
+template<typename T>/*双线性插值采样实现*/
+template<BufferLayout Layout, WrapMode Wrap>
+T BaseSampler<T>::samplePixelBilinearImpl(Buffer<T>* buffer, const glm::vec2& uv, T border) {
+    const T* data = buffer->getRawDataPtr();
+    if (data == nullptr) {
+        return T(0);
+    }
+    const int w = (int)buffer->getWidth();
+    const int h = (int)buffer->getHeight();
+    const size_t innerWidth = buffer->getInnerWidth();
+
+    auto x = (int)glm::floor(uv.x - 0.5f);
+    auto y = (int)glm::floor(uv.y - 0.5f);
+
+    T s1, s2, s3, s4;
+    if (x >= 0 && y >= 0 && x + 1 < w && y + 1 < h) {
+        // 四个像素都在纹理内部，与环绕模式无关，直接寻址
+        using LayoutBuffer = typename BufferLayoutType<T, Layout>::type;
+        if constexpr (Layout == Layout_Linear) {
+            const T* row0 = data + (size_t)y * innerWidth + x;
+            const T* row1 = row0 + innerWidth;
+            s1 = row0[0];
+            s2 = row0[1];
+            s3 = row1[0];
+            s4 = row1[1];
+        }
+        else {
+            s1 = data[LayoutBuffer::layoutIndex(x, y, innerWidth)];
+            s2 = data[LayoutBuffer::layoutIndex(x + 1, y, innerWidth)];
+            s3 = data[LayoutBuffer::layoutIndex(x, y + 1, innerWidth)];
+            s4 = data[LayoutBuffer::layoutIndex(x + 1, y + 1, innerWidth)];
         }
-        case Wrap_MIRRORED_REPEAT: {
-            x = CoordMod(x, 2 * w);
-            y = CoordMod(y, 2 * h);
+    }
+    else {
+        s1 = texelFetch<Layout, Wrap>(data, innerWidth, w, h, x, y, border);        // 左下
+        s2 = texelFetch<Layout, Wrap>(data, innerWidth, w, h, x + 1, y, border);    // 右下
+        s3 = texelFetch<Layout, Wrap>(data, innerWidth, w, h, x, y + 1, border);    // 左上
+        s4 = texelFetch<Layout, Wrap>(data, innerWidth, w, h, x + 1, y + 1, border);// 右上
+    }
+
+    // 计算插值系数（获取坐标的小数部分）  示例：uv(0.503,0.498) → f(0.003, -0.002) → fract后(0.003,0.998)
+    glm::vec2 f = glm::fract(uv - glm::vec2(0.5f));
+
+    return glm::mix(glm::mix(s1, s2, f.x), glm::mix(s3, s4, f.x), f.y);
+}
 
-            x -= w;
-            y -= h;
+template<typename T>
+template<BufferLayout Layout>
+typename BaseSampler<T>::LevelSampleFunc BaseSampler<T>::getLayoutSampleFunc(WrapMode wrap, bool linear) {
+    switch (wrap) {
+        case Wrap_REPEAT:
+            return linear ? sampleBilinearImpl<Layout, Wrap_REPEAT> : sampleNearestImpl<Layout, Wrap_REPEAT>;
+        case Wrap_MIRRORED_REPEAT:
+            return linear ? sampleBilinearImpl<Layout, Wrap_MIRRORED_REPEAT> : sampleNearestImpl<Layout, Wrap_MIRRORED_REPEAT>;
+        case Wrap_CLAMP_TO_BORDER:
+            return linear ? sampleBilinearImpl<Layout, Wrap_CLAMP_TO_BORDER> : sampleNearestImpl<Layout, Wrap_CLAMP_TO_BORDER>;
+        case Wrap_CLAMP_TO_EDGE:
+        default:
+            return linear ? sampleBilinearImpl<Layout, Wrap_CLAMP_TO_EDGE> : sampleNearestImpl<Layout, Wrap_CLAMP_TO_EDGE>;
+    }
+}
 
-            x = CoordMirror(x);
-            y = CoordMirror(y);
+template<typename T>
+typename BaseSampler<T>::LevelSampleFunc BaseSampler<T>::getLevelSampleFunc(BufferLayout layout, WrapMode wrap, bool linear) {
+    switch (layout) {
+        case Layout_Tiled:
+            return getLayoutSampleFunc<Layout_Tiled>(wrap, linear);
+        case Layout_Morton:
+            return getLayoutSampleFunc<Layout_Morton>(wrap, linear);
+        case Layout_Linear:
+        default:
+            return getLayoutSampleFunc<Layout_Linear>(wrap, linear);
+    }
+}
 
-            x = w - 1 - x;
-            y = h - 1 - y;
+template<typename T>
+T BaseSampler<T>::pixelWithWrapMode(Buffer<T>* buffer, int x, int y, WrapMode wrap, T border) {
+    // 单个像素读取，不在采样的热路径上，直接使用缓冲区的坐标转换
+    int w = (int)buffer->getWidth();
+    int h = (int)buffer->getHeight();
+    bool inside = true;
+    switch (wrap) {// 根据环绕模式进行坐标转换
+        case Wrap_REPEAT:
+            inside = wrapTexelCoord<Wrap_REPEAT>(x, w) && wrapTexelCoord<Wrap_REPEAT>(y, h);
             break;
-        }
-        case Wrap_CLAMP_TO_EDGE: {
-            if (x < 0) x = 0;
-            if (y < 0) y = 0;
-            if (x >= w) x = w - 1;
-            if (y >= h) y = h - 1;
+        case Wrap_MIRRORED_REPEAT:
+            inside = wrapTexelCoord<Wrap_MIRRORED_REPEAT>(x, w) && wrapTexelCoord<Wrap_MIRRORED_REPEAT>(y, h);
             break;
-        }
-        case Wrap_CLAMP_TO_BORDER: {
-            if (x < 0 || x >= w) return border;
-            if (y < 0 || y >= h) return border;
+        case Wrap_CLAMP_TO_EDGE:
+            inside = wrapTexelCoord<Wrap_CLAMP_TO_EDGE>(x, w) && wrapTexelCoord<Wrap_CLAMP_TO_EDGE>(y, h);
             break;
-        }
+        case Wrap_CLAMP_TO_BORDER:
+            inside = wrapTexelCoord<Wrap_CLAMP_TO_BORDER>(x, w) && wrapTexelCoord<Wrap_CLAMP_TO_BORDER>(y, h);
+            break;
+    }
+    if (!inside) {
+        return border;
     }
 
     T* ptr = buffer->get(x, y);
@@ -191,23 +334,14 @@ T BaseSampler<T>::pixelWithWrapMode(Buffer<T>* buffer, int x, int y, WrapMode wr
     return T(0);
 }
 
-template<typename T>/*最近邻采样实现*/
+template<typename T>
 T BaseSampler<T>::sampleNearest(Buffer<T>* buffer, glm::vec2& uv, WrapMode wrap, glm::ivec2& offset, T border) {
-    glm::vec2 texUV = uv * glm::vec2(buffer->getWidth(), buffer->getHeight());
-    
-    // 取整并应用偏移量（向下取整保证一致性）
-    auto x = (int)glm::floor(texUV.x) + offset.x; // offset 像素偏移量（用于各向异性采样等场景）
-    auto y = (int)glm::floor(texUV.y) + offset.y;
-
-    return pixelWithWrapMode(buffer, x, y, wrap, border);
+    return getLevelSampleFunc(buffer->getLayout(), wrap, false)(buffer, uv, offset, border);
 }
 
 template<typename T>
 T BaseSampler<T>::sampleBilinear(Buffer<T>* buffer, glm::vec2& uv, WrapMode wrap, glm::ivec2& offset, T border) {
-    glm::vec2 texUV = uv * glm::vec2(buffer->getWidth(), buffer->getHeight());
-    texUV.x += (float)offset.x;
-    texUV.y += (float)offset.y;
-    return samplePixelBilinear(buffer, texUV, wrap, border);
+    return getLevelSampleFunc(buffer->getLayout(), wrap, true)(buffer, uv, offset, border);
 }
 
 template<typename T>/*使用双线性插值对输入缓冲区进行下采样，生成输出缓冲区*/
@@ -229,20 +363,33 @@ void BaseSampler<T>::sampleBufferBilinear(Buffer<T>* buffer_out, Buffer<T>* buff
     }
 }
 
-template<typename T>/*双线性插值采样实现*/
-T BaseSampler<T>::samplePixelBilinear(Buffer<T>* buffer, glm::vec2 uv, WrapMode wrap, T border) {
-    auto x = (int)glm::floor(uv.x - 0.5f);
-    auto y = (int)glm::floor(uv.y - 0.5f);
-
-    auto s1 = pixelWithWrapMode(buffer, x, y, wrap, border);        // 左下
-    auto s2 = pixelWithWrapMode(buffer, x + 1, y, wrap, border);    // 右下
-    auto s3 = pixelWithWrapMode(buffer, x, y + 1, wrap, border);    // 左上
-    auto s4 = pixelWithWrapMode(buffer, x + 1, y + 1, wrap, border);// 右上
-
-    // 计算插值系数（获取坐标的小数部分）  示例：uv(0.503,0.498) → f(0.003, -0.002) → fract后(0.003,0.998)
-    glm::vec2 f = glm::fract(uv - glm::vec2(0.5f));
+template<typename T>
+template<BufferLayout Layout>
+T BaseSampler<T>::samplePixelBilinearLayout(Buffer<T>* buffer, const glm::vec2& uv, WrapMode wrap, T border) {
+    switch (wrap) {
+        case Wrap_REPEAT:
+            return samplePixelBilinearImpl<Layout, Wrap_REPEAT>(buffer, uv, border);
+        case Wrap_MIRRORED_REPEAT:
+            return samplePixelBilinearImpl<Layout, Wrap_MIRRORED_REPEAT>(buffer, uv, border);
+        case Wrap_CLAMP_TO_BORDER:
+            return samplePixelBilinearImpl<Layout, Wrap_CLAMP_TO_BORDER>(buffer, uv, border);
+        case Wrap_CLAMP_TO_EDGE:
+        default:
+            return samplePixelBilinearImpl<Layout, Wrap_CLAMP_TO_EDGE>(buffer, uv, border);
+    }
+}
 
-    return glm::mix(glm::mix(s1, s2, f.x), glm::mix(s3, s4, f.x), f.y);
+template<typename T>
+T BaseSampler<T>::samplePixelBilinear(Buffer<T>* buffer, glm::vec2 uv, WrapMode wrap, T border) {
+    switch (buffer->getLayout()) {
+        case Layout_Tiled:
+            return samplePixelBilinearLayout<Layout_Tiled>(buffer, uv, wrap, border);
+        case Layout_Morton:
+            return samplePixelBilinearLayout<Layout_Morton>(buffer, uv, wrap, border);
+        case Layout_Linear:
+        default:
+            return samplePixelBilinearLayout<Layout_Linear>(buffer, uv, wrap, border);
+    }
 }
 
 // -------------------------------------------------------------------------------------------------
@@ -256,6 +403,9 @@ public:
         BaseSampler<T>::width_ = (tex_ == nullptr) ? 0 : tex_->getWidth();
         BaseSampler<T>::height_ = (tex_ == nullptr) ? 0 : tex_->getHeight();
         BaseSampler<T>::useMipmaps = BaseSampler<T>::filterMode_ > Filter_LINEAR;
+        if (tex_ != nullptr && !tex_->empty()) {
+            BaseSampler<T>::setLayout(tex_->levels[0]->buffer->getLayout());
+        }
     }
 
     inline bool empty() override {
@@ -294,6 +444,9 @@ public:
             BaseSampler<T>::width_ = (tex == nullptr) ? 0 : tex->getWidth();
             BaseSampler<T>::height_ = (tex == nullptr) ? 0 : tex->getHeight();
             BaseSampler<T>::useMipmaps = BaseSampler<T>::filterMode_ > Filter_LINEAR;
+            if (tex != nullptr && !tex->empty()) {
+                BaseSampler<T>::setLayout(tex->levels[0]->buffer->getLayout());
+            }
         }
     }
 
@@ -320,6 +473,9 @@ public:
     // 三维坐标到立方体面UV的转换
     static void convertXYZ2UV(float x, float y, float z, int* index, float* u, float* v);
 
+    // convertXYZ2UV的逆变换：立方体面index上的UV到（未归一化的）方向
+    static glm::vec3 convertUV2XYZ(int index, float u, float v);
+
 private:
     // +x, -x, +y, -y, +z, -z
     TextureImageSoft<T>* texes_[6] = { nullptr, nullptr, nullptr, nullptr, nullptr, nullptr };
@@ -389,6 +545,24 @@ void BaseSamplerCube<T>::convertXYZ2UV(float x, float y, float z, int* index, fl
     *v = 0.5f * (vc / maxAxis + 1.0f);
 }
 
+template<typename T>
+glm::vec3 BaseSamplerCube<T>::convertUV2XYZ(int index, float u, float v) {
+    // 还原到[-1, 1]，v需要撤销convertXYZ2UV中的翻转
+    float uc = 2.0f * u - 1.0f;
+    float vc = 1.0f - 2.0f * v;
+
+    switch (index) {
+        case 0: return { 1.0f, vc, -uc };  // POSITIVE X
+        case 1: return { -1.0f, vc, uc };  // NEGATIVE X
+        case 2: return { uc, 1.0f, -vc };  // POSITIVE Y
+        case 3: return { uc, -1.0f, vc };  // NEGATIVE Y
+        case 4: return { uc, vc, 1.0f };   // POSITIVE Z
+        case 5: return { -uc, vc, -1.0f }; // NEGATIVE Z
+        default: break;
+    }
+    return { 0.0f, 0.0f, 0.0f };
+}
+
 // -------------------------------------------------------------------------------------------------
 class SamplerSoft {
 public:
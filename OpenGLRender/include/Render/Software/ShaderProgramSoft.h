@@ -19,6 +19,7 @@ public:
     }
     // 设置顶点 / 片段着色器
     bool SetShaders(std::shared_ptr<ShaderSoft> vs, std::shared_ptr<ShaderSoft> fs) {
+        version_++;
         vertexShader_ = std::move(vs);
         fragmentShader_ = std::move(fs);
 
@@ -92,6 +93,11 @@ public:
         vertexShader_->shaderMain();
     }
 
+    // 一次虚函数调用执行一批顶点的顶点着色器
+    inline void execVertexShaderBatch(ShaderBatch& batch) {
+        vertexShader_->shaderMainBatch(batch);
+    }
+
     //准备执行片段着色器（如初始化导数计算等）
     inline void prepareFragmentShader() {
         fragmentShader_->prepareExecMain();
@@ -102,6 +108,22 @@ public:
         fragmentShader_->shaderMain();
     }
 
+    inline bool supportQuadShading() const {
+        return fragmentShader_->supportQuadShading();
+    }
+
+    // 打包执行一个2x2像素块的片段着色器
+    inline void execFragmentShaderQuad(ShaderQuad& quad) {
+        fragmentShader_->setupSamplerDerivative();
+        fragmentShader_->shaderMainQuad(quad);
+    }
+
+    // 着色器或define/uniform缓冲重新创建时递增，之前的副本随之失效
+    // 副本与原程序共享uniform与define缓冲，更新uniform、采样器不需要重新克隆
+    inline uint32_t getVersion() const {
+        return version_;
+    }
+
     inline std::shared_ptr<ShaderProgramSoft> clone() const {
         auto ret = std::make_shared<ShaderProgramSoft>(*this);
 
@@ -122,6 +144,7 @@ private:
 
     std::shared_ptr<uint8_t> definesBuffer_;  //宏定义启用状态缓冲区  0->false; 1->true，对应shadersoft中的def
     std::shared_ptr<uint8_t> uniformBuffer_;   //Uniform变量数据缓冲区
+    uint32_t version_ = 0;
 
 private:
     UUID<ShaderProgramSoft> uuid_;
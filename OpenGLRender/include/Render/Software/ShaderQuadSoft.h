@@ -0,0 +1,192 @@
+#ifndef SHADERQUADSOFT_H
+#define SHADERQUADSOFT_H
+
+#include <cmath>
+#include "Base/GLMInc.h"
+#include "Base/SIMD.h"
+
+namespace OpenGL {
+
+// 2x2像素块打包着色：每个分量用一个SSE寄存器保存4个像素（lane）的值，lane顺序与PixelQuadContext::pixels一致
+constexpr int QUAD_LANES = 4;
+
+// 4个lane的float
+struct QuadFloat {
+    __m128 v;
+
+    QuadFloat() : v(_mm_setzero_ps()) {}
+    QuadFloat(__m128 val) : v(val) {}
+    QuadFloat(float val) : v(_mm_set1_ps(val)) {}
+    QuadFloat(float l0, float l1, float l2, float l3) : v(_mm_setr_ps(l0, l1, l2, l3)) {}
+
+    inline float lane(int i) const {
+        alignas(16) float out[QUAD_LANES];
+        _mm_store_ps(out, v);
+        return out[i];
+    }
+};
+
+inline QuadFloat operator+(QuadFloat a, QuadFloat b) { return _mm_add_ps(a.v, b.v); }
+inline QuadFloat operator-(QuadFloat a, QuadFloat b) { return _mm_sub_ps(a.v, b.v); }
+inline QuadFloat operator*(QuadFloat a, QuadFloat b) { return _mm_mul_ps(a.v, b.v); }
+inline QuadFloat operator/(QuadFloat a, QuadFloat b) { return _mm_div_ps(a.v, b.v); }
+inline QuadFloat operator-(QuadFloat a) { return _mm_xor_ps(a.v, _mm_set1_ps(-0.f)); }
+inline QuadFloat& operator+=(QuadFloat& a, QuadFloat b) { return a = a + b; }
+inline QuadFloat& operator*=(QuadFloat& a, QuadFloat b) { return a = a * b; }
+
+namespace quad {
+
+inline QuadFloat min(QuadFloat a, QuadFloat b) { return _mm_min_ps(a.v, b.v); }
+inline QuadFloat max(QuadFloat a, QuadFloat b) { return _mm_max_ps(a.v, b.v); }
+inline QuadFloat clamp(QuadFloat a, QuadFloat lo, QuadFloat hi) { return min(max(a, lo), hi); }
+inline QuadFloat sqrt(QuadFloat a) { return _mm_sqrt_ps(a.v); }
+// 编译目标不含FMA时用乘加代替（结果多一次舍入）
+#if defined(__FMA__) || defined(__AVX2__)
+inline QuadFloat fma(QuadFloat a, QuadFloat b, QuadFloat c) { return _mm_fmadd_ps(a.v, b.v, c.v); }
+#else
+inline QuadFloat fma(QuadFloat a, QuadFloat b, QuadFloat c) { return _mm_add_ps(_mm_mul_ps(a.v, b.v), c.v); }
+#endif
+
+// 超越函数没有SIMD实现，逐lane调用标准库
+inline QuadFloat pow(QuadFloat a, float e) {
+    alignas(16) float out[QUAD_LANES];
+    _mm_store_ps(out, a.v);
+    for (float& val : out) {
+        val = std::pow(val, e);
+    }
+    return _mm_load_ps(out);
+}
+
+inline QuadFloat exp2(QuadFloat a) {
+    alignas(16) float out[QUAD_LANES];
+    _mm_store_ps(out, a.v);
+    for (float& val : out) {
+        val = std::exp2(val);
+    }
+    return _mm_load_ps(out);
+}
+
+}
+
+struct QuadVec2 {
+    QuadFloat x, y;
+};
+
+struct QuadVec3 {
+    QuadFloat x, y, z;
+
+    QuadVec3() = default;
+    QuadVec3(QuadFloat x, QuadFloat y, QuadFloat z) : x(x), y(y), z(z) {}
+    explicit QuadVec3(float s) : x(s), y(s), z(s) {}
+    explicit QuadVec3(QuadFloat s) : x(s), y(s), z(s) {}
+    // 所有lane取相同的值（如uniform）
+    explicit QuadVec3(const glm::vec3& s) : x(s.x), y(s.y), z(s.z) {}
+
+    inline glm::vec3 lane(int i) const {
+        return { x.lane(i), y.lane(i), z.lane(i) };
+    }
+};
+
+struct QuadVec4 {
+    QuadFloat x, y, z, w;
+
+    inline QuadVec3 xyz() const {
+        return { x, y, z };
+    }
+};
+
+inline QuadVec3 operator+(const QuadVec3& a, const QuadVec3& b) { return { a.x + b.x, a.y + b.y, a.z + b.z }; }
+inline QuadVec3 operator-(const QuadVec3& a, const QuadVec3& b) { return { a.x - b.x, a.y - b.y, a.z - b.z }; }
+inline QuadVec3 operator*(const QuadVec3& a, const QuadVec3& b) { return { a.x * b.x, a.y * b.y, a.z * b.z }; }
+inline QuadVec3 operator*(const QuadVec3& a, QuadFloat s) { return { a.x * s, a.y * s, a.z * s }; }
+inline QuadVec3 operator*(QuadFloat s, const QuadVec3& a) { return a * s; }
+inline QuadVec3 operator/(const QuadVec3& a, QuadFloat s) { return a * (QuadFloat(1.f) / s); }
+inline QuadVec3 operator-(const QuadVec3& a) { return { -a.x, -a.y, -a.z }; }
+inline QuadVec3& operator+=(QuadVec3& a, const QuadVec3& b) { return a = a + b; }
+inline QuadVec3& operator*=(QuadVec3& a, QuadFloat s) { return a = a * s; }
+
+namespace quad {
+
+inline QuadFloat dot(const QuadVec3& a, const QuadVec3& b) {
+    return fma(a.x, b.x, fma(a.y, b.y, a.z * b.z));
+}
+
+inline QuadVec3 normalize(const QuadVec3& a) {
+    return a * (QuadFloat(1.f) / sqrt(dot(a, a)));
+}
+
+inline QuadVec3 cross(const QuadVec3& a, const QuadVec3& b) {
+    return { a.y * b.z - b.y * a.z, a.z * b.x - b.z * a.x, a.x * b.y - b.x * a.y };
+}
+
+inline QuadVec3 reflect(const QuadVec3& i, const QuadVec3& n) {
+    return i - n * (QuadFloat(2.f) * dot(n, i));
+}
+
+inline QuadVec3 mix(const QuadVec3& a, const QuadVec3& b, QuadFloat t) {
+    return a + (b - a) * t;
+}
+
+inline QuadVec3 max(const QuadVec3& a, const QuadVec3& b) {
+    return { max(a.x, b.x), max(a.y, b.y), max(a.z, b.z) };
+}
+
+inline QuadVec3 pow(const QuadVec3& a, float e) {
+    return { pow(a.x, e), pow(a.y, e), pow(a.z, e) };
+}
+
+// TBN * v，列向量分别为t、b、n
+inline QuadVec3 mul(const QuadVec3& t, const QuadVec3& b, const QuadVec3& n, const QuadVec3& v) {
+    return t * v.x + b * v.y + n * v.z;
+}
+
+}
+
+// 一个2x2像素块的片段着色输入输出
+struct ShaderQuad {
+    float* varyings[QUAD_LANES] = { nullptr, nullptr, nullptr, nullptr }; // 每个像素插值后的varyings（AoS）
+    glm::vec4 fragCoord[QUAD_LANES];
+    bool frontFacing = true;
+    uint32_t activeMask = 0; // bit i为1表示第i个像素需要输出颜色，其余lane仅作为辅助lane参与计算
+
+    glm::vec4 fragColor[QUAD_LANES]; // 输出
+
+    // 从4个像素的varyings中按字节偏移读取分量，转为SoA
+    inline QuadFloat loadFloat(size_t offset) const {
+        return { lanePtr(0, offset)[0], lanePtr(1, offset)[0], lanePtr(2, offset)[0], lanePtr(3, offset)[0] };
+    }
+
+    inline QuadVec2 loadVec2(size_t offset) const {
+        return { loadFloat(offset), loadFloat(offset + sizeof(float)) };
+    }
+
+    inline QuadVec3 loadVec3(size_t offset) const {
+        return { loadFloat(offset), loadFloat(offset + sizeof(float)), loadFloat(offset + 2 * sizeof(float)) };
+    }
+
+    inline QuadVec4 loadVec4(size_t offset) const {
+        return { loadFloat(offset), loadFloat(offset + sizeof(float)),
+                 loadFloat(offset + 2 * sizeof(float)), loadFloat(offset + 3 * sizeof(float)) };
+    }
+
+    // 将SoA颜色写回到每个像素的fragColor
+    inline void storeColor(const QuadVec3& rgb, QuadFloat a) {
+        alignas(16) float r[QUAD_LANES], g[QUAD_LANES], b[QUAD_LANES], alpha[QUAD_LANES];
+        _mm_store_ps(r, rgb.x.v);
+        _mm_store_ps(g, rgb.y.v);
+        _mm_store_ps(b, rgb.z.v);
+        _mm_store_ps(alpha, a.v);
+        for (int i = 0; i < QUAD_LANES; i++) {
+            fragColor[i] = glm::vec4(r[i], g[i], b[i], alpha[i]);
+        }
+    }
+
+private:
+    inline const float* lanePtr(int lane, size_t offset) const {
+        return reinterpret_cast<const float*>(reinterpret_cast<const uint8_t*>(varyings[lane]) + offset);
+    }
+};
+
+}
+
+#endif
@@ -3,6 +3,7 @@
 
 #include <functional>
 #include "SamplerSoft.h"
+#include "ShaderQuadSoft.h"
 
 namespace OpenGL {
 // 用于管理2x2像素分块的处理状态
@@ -45,6 +46,20 @@ struct ShaderBuiltin {
     DerivativeContext dfCtx;
 };
 
+// 批量执行顶点着色器的输入输出描述，各数组按stride（字节）跨步访问
+struct ShaderBatch {
+    uint8_t* attributes = nullptr;   // 第一个顶点的属性
+    size_t attributesStride = 0;
+    const int32_t* indices = nullptr; // 非空时第i个顶点的属性为attributes + indices[i] * attributesStride
+    uint8_t* varyings = nullptr;     // 第一个顶点的varyings输出位置，可为空
+    size_t varyingsStride = 0;
+    uint8_t* positions = nullptr;    // 第一个顶点的gl_Position输出位置
+    size_t positionsStride = 0;
+    size_t count = 0;                // 顶点数量
+
+    float pointSize = 1.f;           // 最后一个顶点输出的gl_PointSize
+};
+
 // 软件渲染着色器抽象基类
 class ShaderSoft {
 public:
@@ -64,6 +79,36 @@ public:
 
     virtual std::shared_ptr<ShaderSoft> clone() = 0;    //克隆接口（原型模式）用于创建着色器副本
 
+    // 批量执行着色器，默认逐顶点调用；CREATE_SHADER_CLONE会生成非虚调用shaderMain的版本
+    virtual void shaderMainBatch(ShaderBatch& batch) {
+        for (size_t i = 0; i < batch.count; i++) {
+            bindShaderAttributes(batch.attributes + (batch.indices ? batch.indices[i] : i) * batch.attributesStride);
+            bindShaderVaryings(batch.varyings ? batch.varyings + i * batch.varyingsStride : nullptr);
+            shaderMain();
+            *reinterpret_cast<glm::vec4*>(batch.positions + i * batch.positionsStride) = gl->Position;
+        }
+        batch.pointSize = gl->PointSize;
+    }
+
+    // 片段着色器是否实现了2x2像素块的打包执行，未实现时渲染器逐像素调用shaderMain
+    virtual bool supportQuadShading() const {
+        return false;
+    }
+
+    // 打包执行一个2x2像素块，默认逐个有效像素调用shaderMain
+    virtual void shaderMainQuad(ShaderQuad& quad) {
+        gl->FrontFacing = quad.frontFacing;
+        for (int i = 0; i < QUAD_LANES; i++) {
+            if (!(quad.activeMask & (1u << i))) {
+                continue;
+            }
+            bindShaderVaryings(quad.varyings[i]);
+            gl->FragCoord = quad.fragCoord[i];
+            shaderMain();
+            quad.fragColor[i] = gl->FragColor;
+        }
+    }
+
 public:
     // 获取2D纹理尺寸
     static inline glm::ivec2 textureSize(Sampler2DSoft<RGBA>* sampler, int lod) {
@@ -105,6 +150,41 @@ public:
         return ret / 255.f;
     }
 
+    // 打包着色的纹理采样：采样器只有标量接口，逐个有效lane采样，无效lane结果为0
+    static inline QuadVec4 textureQuad(Sampler2DSoft<RGBA>* sampler, const QuadVec2& coord, uint32_t mask) {
+        return sampleLanes(mask, [&](int i) {
+            return texture(sampler, glm::vec2(coord.x.lane(i), coord.y.lane(i)));
+        });
+    }
+
+    static inline QuadVec4 textureQuad(SamplerCubeSoft<RGBA>* sampler, const QuadVec3& coord, uint32_t mask) {
+        return sampleLanes(mask, [&](int i) {
+            return texture(sampler, coord.lane(i));
+        });
+    }
+
+    static inline QuadVec4 textureLodQuad(SamplerCubeSoft<RGBA>* sampler, const QuadVec3& coord, QuadFloat lod, uint32_t mask) {
+        return sampleLanes(mask, [&](int i) {
+            return textureLod(sampler, coord.lane(i), lod.lane(i));
+        });
+    }
+
+    template<typename F>
+    static inline QuadVec4 sampleLanes(uint32_t mask, F sample) {
+        alignas(16) float out[4][QUAD_LANES] = {};
+        for (int i = 0; i < QUAD_LANES; i++) {
+            if (!(mask & (1u << i))) {
+                continue;
+            }
+            glm::vec4 texel = sample(i);
+            out[0][i] = texel.x;
+            out[1][i] = texel.y;
+            out[2][i] = texel.z;
+            out[3][i] = texel.w;
+        }
+        return { _mm_load_ps(out[0]), _mm_load_ps(out[1]), _mm_load_ps(out[2]), _mm_load_ps(out[3]) };
+    }
+
 public:
     //-----------------------运行时数据-----------------------------
     ShaderBuiltin* gl = nullptr; 
@@ -203,6 +283,19 @@ public:
 #define CREATE_SHADER_CLONE(T)                          \
     std::shared_ptr<ShaderSoft> clone() override {        \
         return std::make_shared<T>(*this);                  \
+    }                                                     \
+                                                        \
+    void shaderMainBatch(ShaderBatch &batch) override {   \
+    for (size_t i = 0; i < batch.count; i++) {            \
+        a = reinterpret_cast<ShaderAttributes *>(batch.attributes + \
+            (batch.indices ? batch.indices[i] : i) * batch.attributesStride); \
+        v = reinterpret_cast<ShaderVaryings *>(batch.varyings ? \
+            batch.varyings + i * batch.varyingsStride : nullptr); \
+        T::shaderMain();                                  \
+        *reinterpret_cast<glm::vec4 *>(                   \
+            batch.positions + i * batch.positionsStride) = gl->Position; \
+    }                                                     \
+    batch.pointSize = gl->PointSize;                      \
     }
 
 }
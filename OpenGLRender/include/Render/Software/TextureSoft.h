@@ -1,14 +1,39 @@
 #ifndef TEXTURESOFT_H
 #define TEXTURESOFT_H
 
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
 #include <fstream>
+#include <vector>
 #include "Base/UUID.h"
 #include "Base/Buffer.h"
+#include "Base/FileUtils.h"
 #include "Base/ImageUtils.h"
+#include "Base/hashUtils.h"
 #include "Render/Texture.h"
 
 namespace OpenGL {
-#define SOFT_MS_CNT 4
+// 纹理缓存文件格式变化时递增，旧缓存随之失效
+constexpr uint32_t TEXTURE_CACHE_VERSION = 1;
+constexpr char TEXTURE_CACHE_MAGIC[4] = { 'S', 'G', 'T', 'X' };
+
+// 纹理缓存文件头，之后紧跟按层、级别顺序排列的原始像素数据
+struct TextureCacheHeader {
+    char magic[4];
+    uint32_t version;
+    uint32_t format;
+    uint32_t layout;
+    uint32_t texelSize;
+    uint32_t width;
+    uint32_t height;
+    uint32_t layerCount;
+    uint32_t levelCount;
+    uint32_t reserved;
+    uint64_t payloadSize;
+    char paramsKey[32]; // 生成参数的MD5
+    char checksum[32];  // 像素数据的MD5
+};
 
 // 软件实现纹理的存储
 template<typename T>
@@ -25,8 +50,9 @@ public:
         if (samples == 1) {
             buffer = Buffer<T>::makeDefault(w, h);
         }
-        else if (samples == 4) {
-            bufferMs4x = Buffer<glm::tvec4<T>>::makeDefault(w, h);
+        else if (samples == 2 || samples == 4 || samples == 8) {
+            // 每个像素的采样点在内存中连续存放，按线性布局分配
+            bufferMs = Buffer<T>::makeLayout((size_t)w * samples, h, Layout_Linear);
         }
         else {
             LOGE("create color buffer failed: samplers not support");
@@ -42,14 +68,177 @@ public:
         buffer = buf;
     }
 
+    // 延迟清除：只记录清除值并把所有tile标记为待清除，tile第一次被写入前才真正填充，
+    // 读取待清除的tile时直接使用清除值（见RendererSoft）
+    void clearTiles(const T& value, int tileSize) {
+        clearValue_ = value;
+        clearTileSize_ = tileSize;
+        clearTileCntX_ = (width + tileSize - 1) / tileSize;
+        clearTileCntY_ = (height + tileSize - 1) / tileSize;
+        clearTiles_.assign(clearTileCntX_ * clearTileCntY_, 1);
+        clearPending_ = true;
+    }
+
+    inline bool hasClearTiles() const {
+        return clearPending_;
+    }
+
+    inline int getClearTileSize() const {
+        return clearTileSize_;
+    }
+
+    inline const T& getClearValue() const {
+        return clearValue_;
+    }
+
+    inline bool isTileCleared(int tileX, int tileY) const {
+        return clearPending_ && clearTiles_[tileY * clearTileCntX_ + tileX];
+    }
+
+    // 像素(x, y)所在的tile是否待清除
+    inline bool isClearedAt(int x, int y) const {
+        return clearPending_ && clearTiles_[(y / clearTileSize_) * clearTileCntX_ + x / clearTileSize_];
+    }
+
+    // 填充待清除的tile，不同tile可以在不同线程中并行填充
+    void materializeTile(int tileX, int tileY, bool stream) {
+        if (isTileCleared(tileX, tileY)) {
+            materializeTiles(tileX, tileX + 1, tileY, stream);
+        }
+    }
+
+    // 填充所有待清除的tile，之后缓冲区可以被任意读取
+    void materializeAll(bool stream) {
+        if (!clearPending_) {
+            return;
+        }
+        // 同一行中连续的待清除tile合并填充
+        for (int tileY = 0; tileY < clearTileCntY_; tileY++) {
+            int tileX = 0;
+            while (tileX < clearTileCntX_) {
+                if (!isTileCleared(tileX, tileY)) {
+                    tileX++;
+                    continue;
+                }
+                int endX = tileX + 1;
+                while (endX < clearTileCntX_ && isTileCleared(endX, tileY)) {
+                    endX++;
+                }
+                materializeTiles(tileX, endX, tileY, stream);
+                tileX = endX;
+            }
+        }
+        clearPending_ = false;
+    }
+
+    // 像素(x, y)的第一个采样点，其余sampleCnt - 1个采样点紧随其后，不处理采样点压缩
+    inline T* getSamples(int x, int y) {
+        return bufferMs->get((size_t)x * sampleCnt, y);
+    }
+
+    // 第row行第一个像素的第一个采样点
+    inline T* getSamplesRow(int row) const {
+        return bufferMs->getRawDataPtr() + (size_t)row * width * sampleCnt;
+    }
+
+    // 采样点压缩：记录每个像素的所有采样点是否相同，相同时只有第一个采样点有效。
+    // 关闭时先展开所有压缩的像素
+    void setSampleCompression(bool enable) {
+        if (!multiSample || enable == hasSampleCompression()) {
+            return;
+        }
+        if (enable) {
+            uniformSamples_.assign((size_t)width * height, 0);
+            return;
+        }
+        for (int y = 0; y < height; y++) {
+            for (int x = 0; x < width; x++) {
+                expandSamples(x, y);
+            }
+        }
+        uniformSamples_.clear();
+        uniformSamples_.shrink_to_fit();
+    }
+
+    inline bool hasSampleCompression() const {
+        return !uniformSamples_.empty();
+    }
+
+    // 第row行每个像素是否压缩，未开启压缩时返回nullptr
+    inline const uint8_t* getSampleUniformRow(int row) const {
+        return hasSampleCompression() ? uniformSamples_.data() + (size_t)row * width : nullptr;
+    }
+
+    // 调用前需已开启压缩且(x, y)在缓冲区内
+    inline bool isSampleUniform(int x, int y) const {
+        return uniformSamples_[(size_t)y * width + x];
+    }
+
+    inline void setSampleUniform(int x, int y) {
+        uniformSamples_[(size_t)y * width + x] = 1;
+    }
+
+    // 标记所有像素为压缩，用于所有采样点被整体写入相同值之后（如清除）
+    void setAllSampleUniform() {
+        if (hasSampleCompression()) {
+            std::fill(uniformSamples_.begin(), uniformSamples_.end(), 1);
+        }
+    }
+
+    // 展开压缩的像素（第一个采样点复制到其余采样点），之后可以单独读写每个采样点
+    inline T* expandSamples(int x, int y) {
+        T* ptr = getSamples(x, y);
+        if (ptr && hasSampleCompression() && isSampleUniform(x, y)) {
+            for (int s = 1; s < sampleCnt; s++) {
+                ptr[s] = ptr[0];
+            }
+            uniformSamples_[(size_t)y * width + x] = 0;
+        }
+        return ptr;
+    }
+
 public:
     std::shared_ptr<Buffer<T>> buffer;
-    std::shared_ptr<Buffer<glm::tvec4<T>>> bufferMs4x;
+    std::shared_ptr<Buffer<T>> bufferMs; // 多重采样存储，宽度为width * sampleCnt
 
     int width = 0;
     int height = 0;
     bool multiSample = false;
     int sampleCnt = 1; // 每个像素的采样点数
+
+private:
+    // 填充同一行中[tileX0, tileX1)范围的tile
+    void materializeTiles(int tileX0, int tileX1, int tileY, bool stream) {
+        size_t x0 = tileX0 * clearTileSize_;
+        size_t y0 = tileY * clearTileSize_;
+        size_t x1 = tileX1 * clearTileSize_;
+        size_t y1 = y0 + clearTileSize_;
+        if (multiSample) {
+            bufferMs->setRect(x0 * sampleCnt, y0, x1 * sampleCnt, y1, clearValue_, stream);
+            if (hasSampleCompression()) {
+                x1 = std::min(x1, (size_t)width);
+                y1 = std::min(y1, (size_t)height);
+                for (size_t y = y0; y < y1; y++) {
+                    memset(&uniformSamples_[y * width + x0], 1, x1 - x0);
+                }
+            }
+        }
+        else {
+            buffer->setRect(x0, y0, x1, y1, clearValue_, stream);
+        }
+        for (int tileX = tileX0; tileX < tileX1; tileX++) {
+            clearTiles_[tileY * clearTileCntX_ + tileX] = 0;
+        }
+    }
+
+private:
+    std::vector<uint8_t> uniformSamples_; // 每个像素的采样点是否已压缩，未开启压缩时为空
+    std::vector<uint8_t> clearTiles_; // 每个tile是否待清除
+    T clearValue_{};
+    int clearTileSize_ = 0;
+    int clearTileCntX_ = 0;
+    int clearTileCntY_ = 0;
+    bool clearPending_ = false;
 };
 
 // 支持存储多张图像的纹理
@@ -90,6 +279,7 @@ public:
         usage = desc.usage;
         useMipmaps = desc.useMipmaps;
         multiSample = desc.multiSample;
+        sampleCount = desc.sampleCount;
 
         switch (type) {
         case TextureType_2D:
@@ -138,7 +328,7 @@ public:
     void initImageData() override {
         for (auto& image : images_) {
             image.levels.resize(1);
-            image.levels[0] = std::make_shared<ImageBufferSoft<T>>(width, height, multiSample ? SOFT_MS_CNT : 1);
+            image.levels[0] = std::make_shared<ImageBufferSoft<T>>(width, height, multiSample ? sampleCount : 1);
             if (useMipmaps) {// 如果需要，生成mipmap（不使用采样）
                 image.generateMipmap(false);
             }
@@ -166,63 +356,119 @@ public:
         ret = glm::clamp(cvtBorderColor(samplerDesc_.borderColor) * 255.f, { 0, 0, 0, 0 }, { 255, 255, 255, 255 });
     }
 
-    // 从文件加载纹理数据
-    bool loadFromFile(const char* path) {
-        std::ifstream file(path, std::ios::in | std::ios::binary);
-        if (!file.is_open()) {
-            LOGE("failed to open file: %s", path);
+    // 从缓存文件加载纹理数据，paramsKey为生成该纹理的参数摘要
+    // 文件头、尺寸、参数摘要或数据校验和不匹配时返回false，纹理数据保持不变
+    bool loadFromFile(const char* path, const std::string& paramsKey) {
+        if (multiSample) {
+            LOGE("loadFromFile not support: multi sample texture");
             return false;
         }
 
-        for (int i = 0; i < layerCount_; i++) {
-            auto& layer = images_[i];
-            for (int level = 0; level < layer.levels.size(); level++) {
-                auto& img = layer.getBuffer(level);
-                if (multiSample) {
-                    file.read((char*)img->bufferMs4x->getRawDataPtr(), img->bufferMs4x->getRawDataBytesSize());
-                }
-                else {
-                    file.read((char*)img->buffer->getRawDataPtr(), img->buffer->getRawDataBytesSize());
-                }
-            }
+        auto fileData = FileUtils::readBytes(path);
+        TextureCacheHeader header{};
+        if (fileData.size() < sizeof(TextureCacheHeader)) {
+            LOGW("invalid texture cache: %s", path);
+            return false;
         }
+        memcpy(&header, fileData.data(), sizeof(TextureCacheHeader));
 
-        if (!file) {
-            LOGE("failed to read file: %s", path);
-            file.close();
+        TextureCacheHeader expected = makeCacheHeader(paramsKey);
+        if (0 != memcmp(header.magic, expected.magic, sizeof(header.magic))
+            || header.version != expected.version) {
+            LOGW("texture cache version mismatch: %s", path);
+            return false;
+        }
+        if (header.format != expected.format
+            || header.layout != expected.layout
+            || header.texelSize != expected.texelSize
+            || header.width != expected.width
+            || header.height != expected.height
+            || header.layerCount != expected.layerCount
+            || header.levelCount != expected.levelCount
+            || header.payloadSize != expected.payloadSize
+            || 0 != memcmp(header.paramsKey, expected.paramsKey, sizeof(header.paramsKey))) {
+            LOGW("texture cache is stale: %s", path);
+            return false;
+        }
+        if (fileData.size() != sizeof(TextureCacheHeader) + header.payloadSize) {
+            LOGW("texture cache truncated: %s", path);
+            return false;
+        }
+        const char* payload = (const char*)fileData.data() + sizeof(TextureCacheHeader);
+        auto checksum = HashUtils::getHashMD5(payload, header.payloadSize);
+        if (0 != memcmp(header.checksum, checksum.c_str(), sizeof(header.checksum))) {
+            LOGW("texture cache checksum mismatch: %s", path);
             return false;
         }
 
-        file.close();
+        // 校验全部通过后再写入纹理
+        for (auto& layer : images_) {
+            for (auto& level : layer.levels) {
+                memcpy(level->buffer->getRawDataPtr(), payload, level->buffer->getRawDataBytesSize());
+                payload += level->buffer->getRawDataBytesSize();
+            }
+        }
         return true;
     }
 
-    // 将纹理数据保存到文件
-    void storeToFile(const char* path)   {
-        std::ofstream file(path, std::ios::out | std::ios::binary);
-        if (!file.is_open()) {
-            LOGE("failed to open file: %s", path);
-            return;
+    // 将纹理数据连同文件头写入缓存文件，先写临时文件再重命名，避免留下写了一半的缓存
+    bool storeToFile(const char* path, const std::string& paramsKey) {
+        if (multiSample) {
+            LOGE("storeToFile not support: multi sample texture");
+            return false;
         }
 
-        // 逐层逐级别写入数据
-        for (int i = 0; i < layerCount_; i++) {
-            auto& layer = images_[i];
-            for (int level = 0; level < layer.levels.size(); level++) {
-                auto& img = layer.getBuffer(level);
-                if (multiSample) {
-                    file.write((char*)img->bufferMs4x->getRawDataPtr(), img->bufferMs4x->getRawDataBytesSize());
-                }
-                else {
-                    file.write((char*)img->buffer->getRawDataPtr(), img->buffer->getRawDataBytesSize());
-                }
+        TextureCacheHeader header = makeCacheHeader(paramsKey);
+        std::vector<char> fileData(sizeof(TextureCacheHeader) + header.payloadSize);
+        char* payload = fileData.data() + sizeof(TextureCacheHeader);
+        for (auto& layer : images_) {
+            for (auto& level : layer.levels) {
+                memcpy(payload, level->buffer->getRawDataPtr(), level->buffer->getRawDataBytesSize());
+                payload += level->buffer->getRawDataBytesSize();
             }
         }
-
-        file.close();
+        auto checksum = HashUtils::getHashMD5(fileData.data() + sizeof(TextureCacheHeader), header.payloadSize);
+        memcpy(header.checksum, checksum.c_str(), sizeof(header.checksum));
+        memcpy(fileData.data(), &header, sizeof(TextureCacheHeader));
+
+        std::error_code ec;
+        std::filesystem::create_directories(std::filesystem::path(path).parent_path(), ec);
+        std::string tmpPath = std::string(path) + ".tmp";
+        if (!FileUtils::writeBytes(tmpPath, fileData.data(), fileData.size())) {
+            return false;
+        }
+        std::filesystem::rename(tmpPath, path, ec);
+        if (ec) {
+            LOGW("store texture cache failed: %s", ec.message().c_str());
+            std::filesystem::remove(tmpPath, ec);
+            return false;
+        }
+        return true;
     }
 
 protected:
+    TextureCacheHeader makeCacheHeader(const std::string& paramsKey) {
+        TextureCacheHeader header{};
+        memcpy(header.magic, TEXTURE_CACHE_MAGIC, sizeof(header.magic));
+        header.version = TEXTURE_CACHE_VERSION;
+        header.format = (uint32_t)format;
+        header.texelSize = sizeof(T);
+        header.width = (uint32_t)width;
+        header.height = (uint32_t)height;
+        header.layerCount = layerCount_;
+        header.levelCount = images_.empty() ? 0 : (uint32_t)images_[0].levels.size();
+        if (header.levelCount > 0) {
+            header.layout = (uint32_t)images_[0].levels[0]->buffer->getLayout();
+        }
+        for (auto& layer : images_) {
+            for (auto& level : layer.levels) {
+                header.payloadSize += level->buffer->getRawDataBytesSize();
+            }
+        }
+        memcpy(header.paramsKey, paramsKey.c_str(), std::min(paramsKey.size(), sizeof(header.paramsKey)));
+        return header;
+    }
+
     static inline glm::vec4 cvtBorderColor(BorderColor color) {
         switch (color) {
         case Border_BLACK:
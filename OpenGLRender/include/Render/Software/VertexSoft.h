@@ -6,6 +6,12 @@
 
 namespace OpenGL {
 
+// 变换后顶点缓存的命中统计
+struct VertexCacheStats {
+	size_t hits = 0;   // 索引引用的顶点已被着色过
+	size_t misses = 0; // 需要新分配槽位并执行顶点着色器
+};
+
 class VertexArrayObjectSoft : public VertexArrayObject {
 public:
 	explicit VertexArrayObjectSoft(const VertexArray& vertexArray) {
@@ -19,12 +25,44 @@ public:
 		indicesCnt = vertexArray.indexBufferLength / sizeof(int32_t);
 		indices.resize(indicesCnt);
 		memcpy(indices.data(), vertexArray.indexBuffer, vertexArray.indexBufferLength);
+
+		buildVertexCache();
 	}
 
 	int getId() const override {
 		return uuid_.get();
 	}
 
+	// 构建索引到变换后顶点槽位的映射：每个被索引引用的顶点只占一个槽位，每次draw只着色一次
+	// 索引数据创建后不再变化，因此映射只需构建一次
+	void buildVertexCache() {
+		std::vector<int32_t> vertexSlot(vertexCnt, -1);
+		slotIndices.resize(indicesCnt);
+		slotVertexes.clear();
+		cacheStats = {};
+		for (size_t i = 0; i < indicesCnt; i++) {
+			int32_t& slot = vertexSlot[indices[i]];
+			if (slot < 0) {
+				slot = (int32_t)slotVertexes.size();
+				slotVertexes.push_back(indices[i]);
+				cacheStats.misses++;
+			}
+			else {
+				cacheStats.hits++;
+			}
+			slotIndices[i] = slot;
+		}
+
+		// 槽位与原始顶点一一顺序对应时，着色阶段可以直接按跨步访问顶点数据
+		slotIdentity = true;
+		for (size_t i = 0; i < slotVertexes.size(); i++) {
+			if (slotVertexes[i] != (int32_t)i) {
+				slotIdentity = false;
+				break;
+			}
+		}
+	}
+
 	void updateVertexData(void* data, size_t length) override {
 		memcpy(vertexes.data(), data, std::min(length, vertexes.size()));
 	}
@@ -34,6 +72,12 @@ public:
 	size_t indicesCnt = 0;
 	std::vector<uint8_t> vertexes;
 	std::vector<int32_t> indices;
+
+	// 变换后顶点缓存
+	std::vector<int32_t> slotIndices;  // 每个索引对应的槽位
+	std::vector<int32_t> slotVertexes; // 每个槽位对应的原始顶点下标
+	bool slotIdentity = true;          // slotVertexes[i] == i
+	VertexCacheStats cacheStats;
 private:
 	UUID<VertexArrayObjectSoft> uuid_;
 };
@@ -78,6 +78,7 @@ struct TextureDesc {
 	uint32_t usage = TextureUsage_Sampler;
 	bool useMipmaps = false;
 	bool multiSample = false;
+	int sampleCount = 4; // multiSample为true时每个像素的采样数（2 / 4 / 8）
 	std::string tag;//用于调试/识别；可以当作创建hash值的参数
 };
 
@@ -1,8 +1,6 @@
 #ifndef VERTEX_H
 #define VERTEX_H
 
-#include <glad/glad.h>
-
 #include <vector>
 #include <memory>
 #include "Base/GLMInc.h"
@@ -0,0 +1,50 @@
+#ifndef ASSETSCONFIG_H
+#define ASSETSCONFIG_H
+
+#include <string>
+#include <unordered_map>
+#include "json11/json11.hpp"
+#include "Base/Logger.h"
+#include "Base/FileUtils.h"
+#include "Viewer/Config.h"
+
+namespace OpenGL {
+
+// 资源配置文件assets.json的解析结果，控制面板与无窗口渲染共用
+// key为资源名，value为资源的完整路径
+class AssetsConfig {
+public:
+	bool load(const std::string& assetsDir = ASSETS_DIR) {
+		auto configPath = assetsDir + "assets.json"; //构建完整配置文件路径
+		//读取配置文件内容
+		auto configStr = FileUtils::readText(configPath);
+		if (configStr.empty()) {
+			LOGE("load models failed: error read config file");
+			return false;
+		}
+
+		// 使用json11解析JSON配置
+		std::string err;
+		const auto json = json11::Json::parse(configStr, err);
+		for (auto& kv : json["model"].object_items()) {// 解析模型路径
+			modelPaths[kv.first] = assetsDir + kv.second["path"].string_value();
+		}
+		for (auto& kv : json["skybox"].object_items()) {// 解析天空盒路径
+			skyboxPaths[kv.first] = assetsDir + kv.second["path"].string_value();
+		}
+
+		if (modelPaths.empty()) {// 验证至少加载了一个模型
+			LOGE("load models failed: %s", err.c_str());
+			return false;
+		}
+		return true;
+	}
+
+public:
+	std::unordered_map<std::string, std::string> modelPaths;
+	std::unordered_map<std::string, std::string> skyboxPaths;
+};
+
+}
+
+#endif
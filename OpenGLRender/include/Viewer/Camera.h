@@ -1,7 +1,6 @@
 #ifndef CAMERA_H
 #define CAMERA_H
 
-#include <glad/glad.h>
 #include "Base/GLMInc.h"
 #include <glm/glm/gtc/matrix_transform.hpp>
 #include "Base/Geometry.h"
@@ -25,6 +25,9 @@ public:
 	std::string skyboxPath;
 
 	size_t triangleCount_ = 0;
+	// OpenGL后端上一帧的GL状态调用：实际发出的，以及因状态未变化被状态缓存省略的
+	uint64_t glStateIssued_ = 0;
+	uint64_t glStateSkipped_ = 0;
 	
 	bool wireframe = false;
 	bool worldAxis = true;
@@ -33,7 +36,10 @@ public:
 	
 	bool shadowMap = true;
 	bool pbrIbl = false;
+	bool iblAsync = true;        // 软件渲染在后台生成IBL，生成期间沿用上一个天空盒的IBL或只用环境光
+	bool iblIrradianceSH = true; // 软件渲染用球谐投影生成irradiance map，false时用着色器逐像素卷积
 	bool mipmaps = false;
+	bool meshOverdrawStats = false; // 导入模型时统计网格优化前后的overdraw（每个网格额外12次CPU光栅化），只用于分析
 	
 	bool cullFace = true;
 	bool depthTest = true;
@@ -47,6 +53,7 @@ public:
 	glm::vec3 pointLightColor = { 0.5f, 0.5f, 0.5f };
 
 	int aaType = AAType_NONE;
+	int msaaSamples = 4; // MSAA每个像素的采样数（2 / 4 / 8）
 	int rendererType = Renderer_SOFT;
 };
 
@@ -1,8 +1,10 @@
 #ifndef ENVIRONMENT_H
 #define ENVIRONMENT_H
 
+#include <algorithm>
 #include <memory>
 #include <functional>
+#include <thread>
 #include "Viewer/Camera.h"
 #include "Viewer/Model.h"
 #include "Render/FrameBuffer.h"
@@ -14,18 +16,31 @@ constexpr int kIrradianceMapSize = 32;
 constexpr int kPrefilterMaxMipLevels = 5;
 constexpr int kPrefilterMapSize = 128;
 
+// 二阶球谐（L0~L2）的9个RGB系数，系数顺序：L00, L1-1, L10, L11, L2-2, L2-1, L20, L21, L22
+struct SHCoefficients {
+    glm::vec3 coeffs[9];
+};
+
 //包含渲染立方体贴图所需的所有资源
 struct CubeRenderContext {
+    std::shared_ptr<Renderer> renderer;
     std::shared_ptr<FrameBuffer> fbo;
     Camera camera;
     ModelMesh modelSkybox;
     std::shared_ptr<UniformBlock> uniformsBlockModel;
+    std::shared_ptr<UniformBlock> uniformsBlockPrefilter; // 仅生成prefilter map时创建
 };
 
 class IBLGenerator {
 public:
-    explicit IBLGenerator(const std::shared_ptr<Renderer>& renderer) : renderer_(renderer) {};
+    // workerCnt：软件渲染时生成使用的线程数，后台生成时可以少于CPU核数，给前台渲染留出余量
+    explicit IBLGenerator(const std::shared_ptr<Renderer>& renderer, size_t workerCnt = std::thread::hardware_concurrency())
+        : renderer_(renderer), workerCnt_(std::max<size_t>(1, workerCnt)) {};
     inline void clearCaches() { contextCache_.clear(); }
+    // 关闭后不读写./cache/IBL/中的纹理缓存，每次都重新生成
+    inline void setEnableCache(bool enable) { cacheEnabled_ = enable; }
+    // 软件渲染时逐texel直接执行着色器（generateCubeMapSoft），关闭后与OpenGL一样逐面光栅化绘制
+    inline void setEnableDirectSoft(bool enable) { directSoft_ = enable; }
 
     // 将等距柱状投影贴图转化为立方体贴图
     bool convertEquirectangular(const std::function<bool(ShaderProgram& program)>& shaderFunc,
@@ -36,27 +51,62 @@ public:
                                const std::shared_ptr<Texture>& texIn,
                                std::shared_ptr<Texture>& texOut);
 
+    // 软件渲染：将环境贴图投影到球谐系数后直接烘焙irradiance map，耗时与源纹理像素数成线性关系。
+    // generateIrradianceMap的逐像素半球卷积作为精度参考
+    bool generateIrradianceMapSH(const std::shared_ptr<Texture>& texIn, std::shared_ptr<Texture>& texOut);
+
+    // 按立体角加权，将立方体贴图level 0的所有像素投影到9个球谐系数，各个面按行在线程池中并行累加
+    bool projectCubeMapSH(const std::shared_ptr<Texture>& texIn, SHCoefficients& sh);
+
+    // 由球谐系数计算法线方向n的漫反射辐照度，结果已除以PI，与irradiance map中存储的值一致
+    static glm::vec3 evalIrradianceSH(const SHCoefficients& sh, const glm::vec3& n);
+
     bool generatePrefilterMap(const std::function<bool(ShaderProgram& program)>& shaderFunc,
                               const std::shared_ptr<Texture>& texIn,
                               std::shared_ptr<Texture>& texOut);
 
 private:
+    // 生成立方体贴图的levelCnt个mip级别。OpenGL逐面绘制立方体；软件渲染输出RGBA8且开启directSoft_时走generateCubeMapSoft
+    bool generateCubeMap(const std::function<bool(ShaderProgram& program)>& shaderFunc,
+                         const std::shared_ptr<Texture>& texIn,
+                         std::shared_ptr<Texture>& texOut,
+                         MaterialTexType texType,
+                         uint32_t levelCnt,
+                         bool prefilter);
+
+    // 软件渲染：不经过光栅化，对每个texel计算方向后直接执行着色器，结果写入输出纹理对应的面与级别。
+    // 按面、级别、行块划分任务并行执行，每个工作线程一个独立的着色器程序
+    bool generateCubeMapSoft(const std::function<bool(ShaderProgram& program)>& shaderFunc,
+                             const std::shared_ptr<Texture>& texIn,
+                             std::shared_ptr<Texture>& texOut,
+                             MaterialTexType texType,
+                             uint32_t levelCnt,
+                             bool prefilter);
+
+    std::shared_ptr<Texture> createMipmappedCubeSoft(const std::shared_ptr<Texture>& texIn);
+
     bool createCubeRenderContext(CubeRenderContext& context,
                                  const std::function<bool(ShaderProgram& program)>& shaderFunc,
                                  const std::shared_ptr<Texture>& texIn,
-                                 MaterialTexType texType);
+                                 MaterialTexType texType,
+                                 bool prefilter);
 
-    void drawCubeFaces(CubeRenderContext& context, uint32_t width, uint32_t height, std::shared_ptr<Texture>& texOut,
-                       uint32_t texOutLevel = 0, const std::function<void()>& beforeDraw = nullptr);
+    void drawCubeFace(CubeRenderContext& context, const std::shared_ptr<Texture>& texIn, std::shared_ptr<Texture>& texOut,
+                      int face, uint32_t texOutLevel);
 
-    bool loadFromCache(std::shared_ptr<Texture>& tex);
-    void storeToCache(std::shared_ptr<Texture>& tex);
+    bool loadFromCache(std::shared_ptr<Texture>& tex, const std::string& paramsKey);
+    void storeToCache(std::shared_ptr<Texture>& tex, const std::string& paramsKey);
 
     static std::string getTextureHashKey(std::shared_ptr<Texture>& tex);
     static std::string getCacheFilePath(const std::string& hashKey);
+    static std::string getGenerateParamsKey(const std::shared_ptr<Texture>& texIn, std::shared_ptr<Texture>& texOut,
+                                            uint32_t levelCnt, bool prefilter);
 
 private:
     std::shared_ptr<Renderer> renderer_;
+    size_t workerCnt_ = 1;
+    bool cacheEnabled_ = true;
+    bool directSoft_ = true;
     std::vector<std::shared_ptr<CubeRenderContext>> contextCache_;// 渲染上下文缓存
 };
 }
@@ -0,0 +1,57 @@
+#ifndef MESHOPTIMIZER_H
+#define MESHOPTIMIZER_H
+
+#include <vector>
+#include "Viewer/Model.h"
+
+namespace OpenGL {
+
+// 模拟的变换后顶点缓存大小（FIFO），Tipsify排序与ACMR统计使用同一个值
+constexpr size_t kVertexCacheSize = 16;
+
+// 网格优化前后的统计
+struct MeshOptimizeStats {
+	size_t triangleCnt = 0;
+	size_t vertexCntBefore = 0;
+	size_t vertexCntAfter = 0;
+	float acmrBefore = 0.f;     // 平均每个三角形的顶点缓存未命中数，范围[0.5, 3]，越小越好
+	float acmrAfter = 0.f;
+	float overdrawBefore = 0.f; // 通过深度测试的片段数 / 被覆盖的像素数，最小为1，未统计时为0
+	float overdrawAfter = 0.f;
+};
+
+// 导入后的三角形网格优化，依次执行：
+//  1. 焊接各属性完全相同的顶点
+//  2. Tipsify重排三角形，提高变换后顶点缓存的命中率
+//  3. 在不明显降低缓存命中率的位置把三角形划分为簇，朝外的簇先绘制，减少overdraw
+//  4. 按首次使用的顺序重排顶点，顶点读取按内存顺序进行
+// Ref: Sander, Nehab, Barczak, Fast Triangle Reordering for Vertex Locality and Reduced Overdraw
+class MeshOptimizer {
+public:
+	// stats不为空时统计优化前后的顶点数与ACMR；overdraw需要在优化前后各光栅化6个视角，开销较大，只在overdrawStats为true时统计
+	static void optimize(std::vector<Vertex>& vertexes, std::vector<int32_t>& indices, MeshOptimizeStats* stats = nullptr,
+	                     bool overdrawStats = false);
+
+	// 合并相同的顶点并更新索引，返回合并后的顶点数
+	static size_t weldVertexes(std::vector<Vertex>& vertexes, std::vector<int32_t>& indices);
+
+	// Tipsify三角形重排
+	static void optimizeVertexCache(std::vector<int32_t>& indices, size_t vertexCnt);
+
+	// 输入为已经按顶点缓存排序的索引。3个顶点都未命中缓存的三角形处开始新簇，
+	// 再按threshold（允许的ACMR增长比例）细分，最后按簇朝外的程度从大到小重排
+	static void optimizeOverdraw(std::vector<int32_t>& indices, const std::vector<Vertex>& vertexes, float threshold = 1.05f);
+
+	// 按索引中首次出现的顺序重排顶点
+	static void optimizeVertexFetch(std::vector<Vertex>& vertexes, std::vector<int32_t>& indices);
+
+	// 模拟FIFO顶点缓存，返回ACMR
+	static float analyzeVertexCache(const std::vector<int32_t>& indices, size_t vertexCnt, size_t cacheSize = kVertexCacheSize);
+
+	// 从6个轴向正交视角光栅化（剔除背面、深度测试），返回通过深度测试的片段数与覆盖像素数之比
+	static float analyzeOverdraw(const std::vector<Vertex>& vertexes, const std::vector<int32_t>& indices);
+};
+
+}
+
+#endif
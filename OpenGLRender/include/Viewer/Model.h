@@ -10,6 +10,8 @@
 
 namespace OpenGL {
 
+class MappedFile;
+
 //定义单个顶点
 struct Vertex {
 	glm::vec3 a_position;
@@ -92,6 +94,8 @@ struct Model {
 
 	glm::mat4 centeredTransform;// 模型中心化校准
 
+	std::shared_ptr<MappedFile> cacheData;// 从二进制缓存加载时，网格的顶点/索引指针指向该映射文件
+
 	void resetStates() {
 		resetNodeStates(rootNode);
 	}
@@ -0,0 +1,29 @@
+#ifndef MODELCACHE_H
+#define MODELCACHE_H
+
+#include <string>
+#include "Viewer/Model.h"
+
+namespace OpenGL {
+
+// 模型的二进制缓存：保存Assimp导入后的节点层级、顶点/索引数据、包围盒和材质引用
+// 缓存文件以源文件（以及glTF的.bin、obj的.mtl）内容的MD5命名，源文件修改后自动失效
+// 加载时内存映射缓存文件，网格的顶点/索引指针直接指向映射的数据，不再逐个拷贝
+class ModelCache {
+public:
+	// 计算缓存key，源文件读取失败时返回空字符串
+	static std::string getCacheKey(const std::string& filepath);
+
+	// 加载前需要设置model.resourcePath，材质纹理只填写路径(tag)与环绕方式，纹理数据由调用方加载
+	// 缓存不存在或校验失败时返回false，model保持不变
+	static bool loadFromCache(const std::string& cacheKey, Model& model);
+
+	static bool storeToCache(const std::string& cacheKey, const Model& model);
+
+private:
+	static std::string getCacheFilePath(const std::string& cacheKey);
+};
+
+}
+
+#endif
@@ -3,12 +3,15 @@
 
 #include <unordered_map>
 #include <mutex>
+#include <set>
 #include <assimp/scene.h>
 
 #include "Base/Buffer.h"
 #include "Viewer/Model.h"
+#include "Viewer/MeshOptimizer.h"
 #include "Viewer/Config.h"
 #include "Base/Geometry.h"
+#include "Viewer/Cube.h"
 
 
 namespace OpenGL {
@@ -27,6 +30,7 @@ public:
 		if (scene_.model) {
 			return scene_.model->primitiveCnt;
 		}
+		return 0;
 	}
 
 	//将已加载的model状态重置,释放GPU资源
@@ -39,7 +43,24 @@ public:
 		}
 	}
 
-	static void loadCubeMesh(ModelVertexes& mesh);
+	// 不依赖assimp，定义在头文件中，无窗口构建没有ModelLoader.cpp时IBL生成（Environment）也能链接
+	static void loadCubeMesh(ModelVertexes& mesh) {
+		const float* cubeVertexes = Cube::getCubeVertexes();
+
+		mesh.primitiveType = Primitive_TRIANGLE;
+		mesh.primitiveCnt = 12;
+		for (int i = 0; i < 12; i++) {
+			for (int j = 0; j < 3; j++) {
+				Vertex vertex{};
+				vertex.a_position.x = cubeVertexes[i * 9 + j * 3 + 0];
+				vertex.a_position.y = cubeVertexes[i * 9 + j * 3 + 1];
+				vertex.a_position.z = cubeVertexes[i * 9 + j * 3 + 2];
+				mesh.vertexes.push_back(vertex);
+				mesh.indices.push_back(i * 3 + j);
+			}
+		}
+		mesh.InitVertexes();
+	}
 
 private:
 	// 在Y=axisY平面创建一个16x16单位的网格线框，作为场景参考坐标系
@@ -68,6 +89,10 @@ private:
 
 	// 预加载场景中所有材质引用的纹理文件
 	void preloadTextureFiles(const aiScene* scene, const std::string& resDir);
+	void preloadTextureFiles(const std::set<std::string>& texPaths);
+
+	// 从二进制缓存加载模型，并按缓存记录的路径加载材质纹理
+	bool loadModelFromCache(const std::string& cacheKey);
 
 	//将所给路径图像加载为自定义的格式存储。
 	std::shared_ptr<Buffer<RGBA>> loadTextureFile(const std::string& path);
@@ -84,6 +109,9 @@ private:
 	//key: 纹理文件路径
 	std::unordered_map<std::string, std::shared_ptr<SkyboxMaterial>> skyboxMaterialCache_;
 
+	// 当前导入模型所有网格的优化统计，ACMR与overdraw为按三角形数加权的累加值
+	MeshOptimizeStats importStats_;
+
 	std::mutex modelLoadMutex_;
 	std::mutex texCacheMutex_;
 };
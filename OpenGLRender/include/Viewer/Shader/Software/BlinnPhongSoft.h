@@ -241,6 +241,95 @@ public:
 
         gl->FragColor = glm::vec4(ambientColor + diffuseColor + specularColor + emissiveColor, baseColor.a);
     }
+
+    //-------------------------------- 2x2像素块打包执行，与shaderMain逐项对应 --------------------------------
+    bool supportQuadShading() const override {
+        return true;
+    }
+
+    QuadVec3 GetNormalFromMap(const ShaderQuad& quad, const QuadVec2& texCoord) {
+        if (def->NORMAL_MAP) {
+            QuadVec3 N = quad::normalize(quad.loadVec3(offsetof(ShaderVaryings, v_normal)));
+            QuadVec3 T = quad::normalize(quad.loadVec3(offsetof(ShaderVaryings, v_tangent)));
+            T = quad::normalize(T - quad::dot(T, N) * N);
+            QuadVec3 B = quad::cross(T, N);
+
+            QuadVec3 tangentNormal = textureQuad(u->u_normalMap, texCoord, quad.activeMask).xyz() * 2.0f - QuadVec3(1.0f);
+            return quad::normalize(quad::mul(T, B, N, tangentNormal));
+        }
+        else {
+            return quad::normalize(quad.loadVec3(offsetof(ShaderVaryings, v_normalVector)));
+        }
+    }
+
+    // specularExponent = 128 = 2^7，连续平方7次
+    static QuadFloat PowSpecular(QuadFloat x) {
+        for (int i = 0; i < 7; i++) {
+            x = x * x;
+        }
+        return x;
+    }
+
+    void shaderMainQuad(ShaderQuad& quad) override {
+        const float pointLightRangeInverse = 1.0f / 5.f;
+        const uint32_t mask = quad.activeMask;
+        QuadVec2 texCoord = quad.loadVec2(offsetof(ShaderVaryings, v_texCoord));
+
+        QuadVec4 baseColor;
+        if (def->ALBEDO_MAP) {
+            baseColor = textureQuad(u->u_albedoMap, texCoord, mask);
+        }
+        else {
+            baseColor = { u->u_baseColor.x, u->u_baseColor.y, u->u_baseColor.z, u->u_baseColor.w };
+        }
+
+        QuadVec3 N = GetNormalFromMap(quad, texCoord);
+
+        // ambient
+        QuadFloat ao = 1.f;
+        if (def->AO_MAP) {
+            ao = textureQuad(u->u_aoMap, texCoord, mask).x;
+        }
+        QuadVec3 color = baseColor.xyz() * QuadVec3(u->u_ambientColor) * ao;
+
+        if (u->u_enableLight) {
+            // diffuse
+            QuadVec3 lightDir = quad.loadVec3(offsetof(ShaderVaryings, v_lightDirection));
+            QuadVec3 lDir = lightDir * pointLightRangeInverse;
+            QuadFloat attenuation = quad::clamp(1.0f - quad::dot(lDir, lDir), 0.0f, 1.0f);
+
+            QuadVec3 lightDirection = quad::normalize(lightDir);
+            QuadFloat diffuse = quad::max(quad::dot(N, lightDirection), 0.0f);
+            QuadVec3 diffuseColor = QuadVec3(u->u_pointLightColor) * baseColor.xyz() * (diffuse * attenuation);
+
+            // specular
+            QuadVec3 cameraDirection = quad::normalize(quad.loadVec3(offsetof(ShaderVaryings, v_cameraDirection)));
+            QuadVec3 halfVector = quad::normalize(lightDirection + cameraDirection);
+            QuadFloat specularAngle = quad::max(quad::dot(N, halfVector), 0.0f);
+            QuadVec3 specularColor(PowSpecular(specularAngle) * u->u_kSpecular);
+
+            if (u->u_enableShadow) {
+                // 阴影的PCF采样没有打包版本，逐个有效像素计算
+                alignas(16) float shadow[QUAD_LANES] = { 1.f, 1.f, 1.f, 1.f };
+                for (int i = 0; i < QUAD_LANES; i++) {
+                    if (mask & (1u << i)) {
+                        bindShaderVaryings(quad.varyings[i]);
+                        shadow[i] = 1.0f - ShadowCalculation(v->v_shadowFragPos, N.lane(i));
+                    }
+                }
+                QuadFloat visibility = _mm_load_ps(shadow);
+                diffuseColor *= visibility;
+                specularColor *= visibility;
+            }
+            color += diffuseColor + specularColor;
+        }
+
+        if (def->EMISSIVE_MAP) {
+            color += textureQuad(u->u_emissiveMap, texCoord, mask).xyz();
+        }
+
+        quad.storeColor(color, baseColor.w);
+    }
 };
 
 
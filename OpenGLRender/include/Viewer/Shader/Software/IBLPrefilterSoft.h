@@ -1,6 +1,8 @@
 #ifndef IBLPREFILTERSOFT_H
 #define IBLPREFILTERSOFT_H
 
+#include <map>
+#include <mutex>
 #include "Render/Software/ShaderProgramSoft.h"
 
 namespace OpenGL {
@@ -67,14 +69,28 @@ public:
     }
 };
 
+// 每个像素使用的重要性采样数。源立方体贴图带mipmap，按采样的立体角选择级别（filtered importance sampling），
+// 相比直接采样level 0的1024个采样点，64个即可得到相近的结果
+constexpr uint32_t kPrefilterSampleCount = 64u;
+
+// 一个粗糙度对应的采样表。V = R = N时采样方向在切线空间中只与粗糙度有关，预先计算后由所有线程共享
+struct PrefilterSampleTable {
+    struct Sample {
+        glm::vec3 L;  // 切线空间的采样方向，z轴为N
+        float NdotL;  // 权重
+        float lod;    // 源立方体贴图的mip级别
+    };
+    std::vector<Sample> samples;
+    float totalWeight = 0.f;
+};
+
 class FS : public ShaderIBLPrefilter {
 public:
     CREATE_SHADER_CLONE(FS)
 
-    static float DistributionGGX(glm::vec3 N, glm::vec3 H, float roughness) {
+    static float DistributionGGX(float NdotH, float roughness) {
         float a = roughness * roughness;
         float a2 = a * a;
-        float NdotH = glm::max(dot(N, H), 0.0f);
         float NdotH2 = NdotH * NdotH;
 
         float nom = a2;
@@ -99,68 +115,88 @@ public:
         return { float(i) / float(N), RadicalInverse_VdC(i) };
     }
     // ----------------------------------------------------------------------------
-    static glm::vec3 ImportanceSampleGGX(glm::vec2 Xi, glm::vec3 N, float roughness) {
+    // 切线空间的GGX半程向量
+    static glm::vec3 ImportanceSampleGGX(glm::vec2 Xi, float roughness) {
         float a = roughness * roughness;
 
         float phi = 2.0f * PI * Xi.x;
         float cosTheta = glm::sqrt((1.0f - Xi.y) / (1.0f + (a * a - 1.0f) * Xi.y));
         float sinTheta = glm::sqrt(1.0f - cosTheta * cosTheta);
 
-        // from spherical coordinates to cartesian coordinates - halfway vector
-        glm::vec3 H;
-        H.x = glm::cos(phi) * sinTheta;
-        H.y = glm::sin(phi) * sinTheta;
-        H.z = cosTheta;
+        return { glm::cos(phi) * sinTheta, glm::sin(phi) * sinTheta, cosTheta };
+    }
+    // ----------------------------------------------------------------------------
+    static std::shared_ptr<PrefilterSampleTable> CreateSampleTable(float roughness, float srcResolution) {
+        auto table = std::make_shared<PrefilterSampleTable>();
+        const glm::vec3 V(0.0f, 0.0f, 1.0f);
 
-        // from tangent-space H vector to world-space sample vector
-        glm::vec3 up = abs(N.z) < 0.999 ? glm::vec3(0.0, 0.0, 1.0) : glm::vec3(1.0, 0.0, 0.0);
-        glm::vec3 tangent = glm::normalize(glm::cross(up, N));
-        glm::vec3 bitangent = glm::cross(N, tangent);
+        // 源立方体贴图一个像素对应的立体角
+        float saTexel = 4.0f * PI / (6.0f * srcResolution * srcResolution);
+
+        for (uint32_t i = 0u; i < kPrefilterSampleCount; ++i) {
+            glm::vec3 H = ImportanceSampleGGX(Hammersley(i, kPrefilterSampleCount), roughness);
+            glm::vec3 L = glm::normalize(2.0f * glm::dot(V, H) * H - V);
+
+            float NdotL = L.z;
+            if (NdotL <= 0.0f) {
+                continue;
+            }
+
+            // N = V时NdotH = HdotV，pdf = D * NdotH / (4 * HdotV) = D / 4
+            float pdf = DistributionGGX(H.z, roughness) * 0.25f + 0.0001f;
+            float saSample = 1.0f / (float(kPrefilterSampleCount) * pdf + 0.0001f);
+            float lod = roughness == 0.0f ? 0.0f : glm::max(0.5f * glm::log2(saSample / saTexel), 0.0f);
 
-        glm::vec3 sampleVec = tangent * H.x + bitangent * H.y + N * H.z;
-        return glm::normalize(sampleVec);
+            table->samples.push_back({ L, NdotL, lod });
+            table->totalWeight += NdotL;
+        }
+        return table;
+    }
+
+    // 按（粗糙度，源分辨率）缓存采样表，每个mip级别只计算一次
+    static std::shared_ptr<PrefilterSampleTable> GetSampleTable(float roughness, float srcResolution) {
+        static std::mutex mutex;
+        static std::map<std::pair<float, float>, std::shared_ptr<PrefilterSampleTable>> tables;
+
+        std::lock_guard<std::mutex> lock(mutex);
+        auto& table = tables[{ roughness, srcResolution }];
+        if (!table) {
+            table = CreateSampleTable(roughness, srcResolution);
+        }
+        return table;
     }
 
     void shaderMain() override {
+        // 每个线程的着色器副本只在粗糙度变化（切换mip级别）时查表
+        if (!table_ || tableRoughness_ != u->u_roughness || tableResolution_ != u->u_srcResolution) {
+            table_ = GetSampleTable(u->u_roughness, u->u_srcResolution);
+            tableRoughness_ = u->u_roughness;
+            tableResolution_ = u->u_srcResolution;
+        }
+
         glm::vec3 N = normalize(v->v_worldPos);
 
         // make the simplyfying assumption that V equals R equals the normal
-        glm::vec3 R = N;
-        glm::vec3 V = R;
+        glm::vec3 up = abs(N.z) < 0.999 ? glm::vec3(0.0, 0.0, 1.0) : glm::vec3(1.0, 0.0, 0.0);
+        glm::vec3 tangent = glm::normalize(glm::cross(up, N));
+        glm::vec3 bitangent = glm::cross(N, tangent);
 
-        const uint32_t SAMPLE_COUNT = 1024u;
         glm::vec3 prefilteredColor = glm::vec3(0.0f);
-        float totalWeight = 0.0f;
-
-        for (uint32_t i = 0u; i < SAMPLE_COUNT; ++i) {
-            // generates a sample vector that's biased towards the preferred alignment direction (importance sampling).
-            glm::vec2 Xi = Hammersley(i, SAMPLE_COUNT);
-            glm::vec3 H = ImportanceSampleGGX(Xi, N, u->u_roughness);
-            glm::vec3 L = glm::normalize(2.0f * dot(V, H) * H - V);
-
-            float NdotL = glm::max(glm::dot(N, L), 0.0f);
-            if (NdotL > 0.0f) {
-                // sample from the environment's mip level based on roughness/pdf
-                float D = DistributionGGX(N, H, u->u_roughness);
-                float NdotH = glm::max(dot(N, H), 0.0f);
-                float HdotV = glm::max(dot(H, V), 0.0f);
-                float pdf = D * NdotH / (4.0f * HdotV) + 0.0001f;
-
-                float resolution = u->u_srcResolution; // resolution of source cubemap (per face)
-                float saTexel = 4.0f * PI / (6.0f * resolution * resolution);
-                float saSample = 1.0f / (float(SAMPLE_COUNT) * pdf + 0.0001f);
-
-                float mipLevel = u->u_roughness == 0.0f ? 0.0f : 0.5f * glm::log2(saSample / saTexel);
-
-                prefilteredColor += glm::vec3(textureLod(u->u_cubeMap, L, mipLevel)) * NdotL;
-                totalWeight += NdotL;
-            }
+        for (auto& sample : table_->samples) {
+            // from tangent-space sample vector to world-space
+            glm::vec3 L = tangent * sample.L.x + bitangent * sample.L.y + N * sample.L.z;
+            prefilteredColor += glm::vec3(textureLod(u->u_cubeMap, L, sample.lod)) * sample.NdotL;
         }
 
-        prefilteredColor = prefilteredColor / totalWeight;
+        prefilteredColor = prefilteredColor / table_->totalWeight;
 
         gl->FragColor = glm::vec4(prefilteredColor, 1.0);
     }
+
+private:
+    std::shared_ptr<PrefilterSampleTable> table_ = nullptr;
+    float tableRoughness_ = -1.f;
+    float tableResolution_ = 0.f;
 };
 
 }
@@ -318,6 +318,172 @@ public:
 
         gl->FragColor = glm::vec4(color + emissive, albedo_rgba.a);
     }
+
+    //-------------------------------- 2x2像素块打包执行，与shaderMain逐项对应 --------------------------------
+    bool supportQuadShading() const override {
+        return true;
+    }
+
+    QuadVec3 GetNormalFromMap(const ShaderQuad& quad, const QuadVec2& texCoord) {
+        if (def->NORMAL_MAP) {
+            QuadVec3 N = quad::normalize(quad.loadVec3(offsetof(ShaderVaryings, v_normal)));
+            QuadVec3 T = quad::normalize(quad.loadVec3(offsetof(ShaderVaryings, v_tangent)));
+            T = quad::normalize(T - quad::dot(T, N) * N);
+            QuadVec3 B = quad::cross(T, N);
+
+            QuadVec3 tangentNormal = textureQuad(u->u_normalMap, texCoord, quad.activeMask).xyz() * 2.0f - QuadVec3(1.0f);
+            return quad::normalize(quad::mul(T, B, N, tangentNormal));
+        }
+        else {
+            return quad::normalize(quad.loadVec3(offsetof(ShaderVaryings, v_normalVector)));
+        }
+    }
+
+    static QuadFloat DistributionGGX(const QuadVec3& N, const QuadVec3& H, QuadFloat roughness) {
+        QuadFloat a = roughness * roughness;
+        QuadFloat a2 = a * a;
+        QuadFloat NdotH = quad::max(quad::dot(N, H), 0.0f);
+        QuadFloat NdotH2 = NdotH * NdotH;
+
+        QuadFloat denom = NdotH2 * (a2 - 1.0f) + 1.0f;
+        denom = PI * denom * denom;
+
+        return a2 / denom;
+    }
+
+    static QuadFloat GeometrySchlickGGX(QuadFloat NdotV, QuadFloat roughness) {
+        QuadFloat r = roughness + 1.0f;
+        QuadFloat k = (r * r) / 8.0f;
+
+        return NdotV / (NdotV * (1.0f - k) + k);
+    }
+
+    static QuadFloat GeometrySmith(const QuadVec3& N, const QuadVec3& V, const QuadVec3& L, QuadFloat roughness) {
+        QuadFloat NdotV = quad::max(quad::dot(N, V), 0.0f);
+        QuadFloat NdotL = quad::max(quad::dot(N, L), 0.0f);
+        return GeometrySchlickGGX(NdotL, roughness) * GeometrySchlickGGX(NdotV, roughness);
+    }
+
+    static QuadFloat Pow5(QuadFloat x) {
+        QuadFloat x2 = x * x;
+        return x2 * x2 * x;
+    }
+
+    static QuadVec3 FresnelSchlick(QuadFloat cosTheta, const QuadVec3& F0) {
+        return F0 + (QuadVec3(1.0f) - F0) * Pow5(quad::clamp(1.0f - cosTheta, 0.0f, 1.0f));
+    }
+
+    static QuadVec3 FresnelSchlickRoughness(QuadFloat cosTheta, const QuadVec3& F0, QuadFloat roughness) {
+        return F0 + (quad::max(QuadVec3(1.0f - roughness), F0) - F0) * Pow5(quad::clamp(1.0f - cosTheta, 0.0f, 1.0f));
+    }
+
+    static QuadVec3 EnvBRDFApprox(const QuadVec3& SpecularColor, QuadFloat Roughness, QuadFloat NdotV) {
+        // 同标量版本：c0 = (-1, -0.0275, -0.572, 0.022), c1 = (1, 0.0425, 1.04, -0.04)
+        QuadFloat rx = Roughness * -1.f + 1.f;
+        QuadFloat ry = Roughness * -0.0275f + 0.0425f;
+        QuadFloat rz = Roughness * -0.572f + 1.04f;
+        QuadFloat rw = Roughness * 0.022f - 0.04f;
+        QuadFloat a004 = quad::min(rx * rx, quad::exp2(NdotV * -9.28f)) * rx + ry;
+        QuadFloat A = a004 * -1.04f + rz;
+        QuadFloat B = a004 * 1.04f + rw;
+
+        B *= quad::max(0.f, quad::min(1.f, SpecularColor.y * 50.0f));
+
+        return SpecularColor * A + QuadVec3(B);
+    }
+
+    void shaderMainQuad(ShaderQuad& quad) override {
+        const float pointLightRangeInverse = 1.0f / 5.f;
+        const uint32_t mask = quad.activeMask;
+        QuadVec2 texCoord = quad.loadVec2(offsetof(ShaderVaryings, v_texCoord));
+
+        QuadVec4 albedo_rgba;
+        if (def->ALBEDO_MAP) {
+            albedo_rgba = textureQuad(u->u_albedoMap, texCoord, mask);
+        }
+        else {
+            albedo_rgba = { u->u_baseColor.x, u->u_baseColor.y, u->u_baseColor.z, u->u_baseColor.w };
+        }
+
+        QuadVec3 albedo = quad::pow(albedo_rgba.xyz(), 2.2f);
+
+        QuadFloat metallic = 0.0f;
+        QuadFloat roughness = 1.0f;
+        if (def->METALROUGHNESS_MAP) {
+            QuadVec4 metalRoughness = textureQuad(u->u_metalRoughnessMap, texCoord, mask);
+            metallic = metalRoughness.z;
+            roughness = metalRoughness.y;
+        }
+
+        QuadFloat ao = 1.f;
+        if (def->AO_MAP) {
+            ao = textureQuad(u->u_aoMap, texCoord, mask).x;
+        }
+
+        QuadVec3 N = GetNormalFromMap(quad, texCoord);
+        QuadVec3 V = quad::normalize(quad.loadVec3(offsetof(ShaderVaryings, v_cameraDirection)));
+        QuadVec3 R = quad::reflect(-V, N);
+        QuadFloat NdotV = quad::max(quad::dot(N, V), 0.0f);
+
+        QuadVec3 F0 = quad::mix(QuadVec3(0.04f), albedo, metallic);
+
+        // reflectance equation
+        QuadVec3 Lo(0.0f);
+
+        // Light begin ---------------------------------------------------------------
+        if (u->u_enableLight) {
+            QuadVec3 lightDirection = quad.loadVec3(offsetof(ShaderVaryings, v_lightDirection));
+            QuadVec3 L = quad::normalize(lightDirection);
+            QuadVec3 H = quad::normalize(V + L);
+
+            QuadVec3 lDir = lightDirection * pointLightRangeInverse;
+            QuadFloat attenuation = quad::clamp(1.0f - quad::dot(lDir, lDir), 0.0f, 1.0f);
+            QuadVec3 radiance = QuadVec3(u->u_pointLightColor) * attenuation;
+
+            // Cook-Torrance BRDF
+            QuadFloat NDF = DistributionGGX(N, H, roughness);
+            QuadFloat G = GeometrySmith(N, V, L, roughness);
+            QuadVec3 F = FresnelSchlick(quad::max(quad::dot(H, V), 0.0f), F0);
+
+            QuadFloat NdotL = quad::max(quad::dot(N, L), 0.0f);
+            // + 0.0001 to prevent divide by zero
+            QuadFloat denominator = 4.0f * NdotV * NdotL + 0.0001f;
+            QuadVec3 specular = F * (NDF * G) / denominator;
+
+            QuadVec3 kD = (QuadVec3(1.0f) - F) * (1.0f - metallic);
+            Lo += (kD * albedo / PI + specular) * radiance * NdotL;
+        }
+        // Light end ---------------------------------------------------------------
+
+        // Ambient begin ---------------------------------------------------------------
+        QuadVec3 ambient;
+        if (u->u_enableIBL) {
+            QuadVec3 F = FresnelSchlickRoughness(NdotV, F0, roughness);
+            QuadVec3 kD = (QuadVec3(1.0f) - F) * (1.0f - metallic);
+
+            QuadVec3 irradiance = textureQuad(u->u_irradianceMap, N, mask).xyz();
+            QuadVec3 diffuse = irradiance * albedo;
+
+            const float MAX_REFLECTION_LOD = 4.0f;
+            QuadVec3 prefilteredColor = textureLodQuad(u->u_prefilterMap, R, roughness * MAX_REFLECTION_LOD, mask).xyz();
+            QuadVec3 specular = prefilteredColor * EnvBRDFApprox(F, roughness, NdotV);
+            ambient = (kD * diffuse + specular) * ao;
+        }
+        else {
+            ambient = QuadVec3(u->u_ambientColor) * albedo * ao;
+        }
+        // Ambient end ---------------------------------------------------------------
+
+        // gamma correct
+        QuadVec3 color = quad::pow(ambient + Lo, 1.0f / 2.2f);
+
+        // emissive
+        if (def->EMISSIVE_MAP) {
+            color += textureQuad(u->u_emissiveMap, texCoord, mask).xyz();
+        }
+
+        quad.storeColor(color, albedo_rgba.w);
+    }
 };
 
 }
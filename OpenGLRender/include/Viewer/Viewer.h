@@ -8,6 +8,7 @@
 #include "Viewer/QuadFilter.h"
 #include "Viewer/Environment.h"
 #include <functional>
+#include <future>
 namespace OpenGL {
 
 class Viewer {
@@ -47,9 +48,21 @@ private:
     void setupModelNodes(ModelNode& node, bool wireframe);
     void setupSkybox(ModelMesh& skybox);
 
+    // 绘制列表中的一项，sortKey从高位到低位依次为：pass（不透明/半透明）、状态与深度（顺序见buildDrawList）
+    struct DrawItem {
+        uint64_t sortKey = 0;
+        ModelMesh* mesh = nullptr;
+        glm::mat4 modelMatrix = glm::mat4(1.0f);
+        float specular = 1.f;
+    };
+
     void drawScene(bool shadowPass);
-    void drawModelNodes(ModelNode& node, bool shadowPass, glm::mat4& transform, AlphaMode mode, float specular = 1.f);
+    void buildDrawList();
+    void collectModelNodes(ModelNode& node, const glm::mat4& transform);
+    void pushDrawItem(ModelMesh& mesh, const glm::mat4& modelMatrix, float specular);
+    void drawItems(std::vector<DrawItem>::iterator begin, std::vector<DrawItem>::iterator end, bool shadowPass);
     void drawModelMesh(ModelMesh& mesh, bool shadowPass, float specular);
+    uint32_t getDrawStateId(const void* state);
 
     void pipelineSetup(ModelBase& model, ShadingModel shading, const std::set<int>& uniformBlocks,
     const std::function<void(RenderStates& rs)>& extraStates = nullptr);
@@ -72,8 +85,27 @@ private:
     void updateUniformModel(const glm::mat4& model, const glm::mat4& view);
     void updateUniformMaterial(Material& material, float specular = 1.f);
 
+    // IBL生成结果，在主线程中一次性替换到天空盒材质上
+    struct IBLTextures {
+        std::shared_ptr<Texture> cubeMap = nullptr; // 由等距柱状贴图转换得到，天空盒本身就是立方体贴图时为空
+        std::shared_ptr<Texture> irradiance = nullptr;
+        std::shared_ptr<Texture> prefilter = nullptr;
+    };
+
+    // 软件渲染的后台IBL生成任务，使用独立的渲染器与生成器，不占用renderer_
+    struct IBLJob {
+        std::shared_ptr<SkyboxMaterial> material; // 生成目标，天空盒切换后仍然有效（材质按路径缓存）
+        IBLTextures textures;
+        std::future<bool> result;
+    };
+
     inline SkyboxMaterial* getSkyboxMaterial();
     bool initSkyboxIBL();
+    bool updateIBLJob(const std::shared_ptr<SkyboxMaterial>& material);
+    void waitIBLJob();
+    bool generateIBL(IBLGenerator& generator, Renderer& renderer, const std::shared_ptr<Texture>& texCube,
+                     const std::shared_ptr<Texture>& texEquirect, bool irradianceSH, IBLTextures& textures);
+    void applyIBLTextures(SkyboxMaterial& material, const IBLTextures& textures);
     bool iBLEnabled();
     void updateIBLTextures(MaterialObject* materialObj);
     void updateShadowTextures(MaterialObject* materialObj, bool shadowPass);
@@ -82,7 +114,8 @@ private:
     static size_t getShaderProgramCacheKey(ShadingModel shading, const std::set<std::string>& defines);
     static size_t getPipelineCacheKey(Material& material, const RenderStates& rs);
 
-    std::shared_ptr<Texture> createTextureCubeDefault(int width, int height, uint32_t usage, bool mipmaps = false);
+    static std::shared_ptr<Texture> createTextureCubeDefault(Renderer& renderer, int width, int height, uint32_t usage,
+                                                             bool mipmaps = false);
     std::shared_ptr<Texture> createTexture2DDefault(int width, int height, TextureFormat format, uint32_t usage, bool mipmaps = false);
     bool checkMeshFrustumCull(ModelMesh& mesh, const glm::mat4& transform);
 
@@ -120,6 +153,8 @@ protected:
     // ibl
     std::shared_ptr<Texture> iblPlaceholder_ = nullptr;
     std::shared_ptr<IBLGenerator> iblGenerator_ = nullptr;
+    std::shared_ptr<IBLJob> iblJob_ = nullptr;
+    IBLTextures iblFallback_; // 最近一次生成完成的IBL，新天空盒的IBL生成期间继续用于光照
 
     // uniforms，会在setupmaterial（）被赋值到model中, 
     std::shared_ptr<UniformBlock> uniformBlockScene_;
@@ -129,6 +164,10 @@ protected:
     // caches ...........key: hash值
     std::unordered_map<size_t, std::shared_ptr<ShaderProgram>> programCache_;
     std::unordered_map<size_t, std::shared_ptr<PipelineStates>> pipelineCache_;
+
+    // 每帧重建的绘制列表，以及本帧出现过的program/pipeline到连续编号的映射（用于sortKey）
+    std::vector<DrawItem> drawList_;
+    std::unordered_map<const void*, uint32_t> drawStateIds_;
 };
 }
 
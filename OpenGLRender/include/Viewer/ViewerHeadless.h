@@ -0,0 +1,108 @@
+#ifndef VIEWERHEADLESS_H
+#define VIEWERHEADLESS_H
+
+#include "Viewer/Camera.h"
+#include "Viewer/ModelLoader.h"
+#include "Viewer/ViewerSoftware.h"
+
+namespace OpenGL {
+
+// 无窗口的软件渲染入口，不依赖GLFW/glad/ImGui，用于离线渲染和批量性能测试
+// 每帧的流程与ViewerManager::drawFrame一致，相机由调用方设置，点光源固定在控制面板的默认位置
+class ViewerHeadless {
+public:
+	bool create(int width, int height) {
+		width_ = width;
+		height_ = height;
+
+		// camera
+		camera_ = std::make_shared<Camera>();
+		camera_->setPerspective(glm::radians(CAMERA_FOV), (float)width / (float)height, CAMERA_NEAR, CAMERA_FAR);
+
+		// config
+		config_ = std::make_shared<Config>();
+		config_->rendererType = Renderer_SOFT;
+
+		// viewer software
+		viewer_ = std::make_shared<ViewerSoftware>(*config_, *camera_);
+
+		// modelloader
+		modelLoader_ = std::make_shared<ModelLoader>(*config_);
+
+		return viewer_->create(width, height, 0);
+	}
+
+	bool loadModel(const std::string& name, const std::string& path) {
+		viewer_->waitRenderIdle();
+		config_->modelName = name;
+		config_->modelPath = path;
+		return modelLoader_->loadModel(path);
+	}
+
+	bool loadSkybox(const std::string& name, const std::string& path) {
+		viewer_->waitRenderIdle();
+		config_->skyboxName = name;
+		config_->skyboxPath = path;
+		return modelLoader_->loadSkybox(path);
+	}
+
+	inline void setCamera(const glm::vec3& eye, const glm::vec3& center) {
+		camera_->lookAt(eye, center, glm::vec3(0.f, 1.f, 0.f));
+	}
+
+	// 渲染一帧并等待渲染完成，结果通过getColorBuffer获取
+	void drawFrame() {
+		camera_->update();
+		updateLight();
+
+		config_->triangleCount_ = modelLoader_->getModelPrimitiveCnt();
+
+		viewer_->configRenderer();
+		viewer_->drawFrame(modelLoader_->getScene());
+		viewer_->waitRenderIdle();
+	}
+
+	inline std::shared_ptr<Buffer<RGBA>> getColorBuffer() {
+		return viewer_->getColorBuffer();
+	}
+
+	inline Config& getConfig() { return *config_; }
+
+	// 当前天空盒的IBL是否已生成完成（iblAsync时生成期间返回false）
+	inline bool isIBLReady() {
+		auto* skybox = dynamic_cast<SkyboxMaterial*>(modelLoader_->getScene().skybox.material.get());
+		return skybox && skybox->iblReady;
+	}
+
+	inline void destroy() {
+		viewer_->waitRenderIdle();
+		modelLoader_->resetAllModelStates();
+		modelLoader_->getScene().resetStates();
+		viewer_->destroy();
+	}
+
+private:
+	// 与ConfigPanel::update的光源更新方式一致
+	void updateLight() {
+		config_->pointLightPosition = 2.f * glm::vec3(glm::sin(lightPositionAngle_), 1.2f, glm::cos(lightPositionAngle_));
+		auto& scene = modelLoader_->getScene();
+		scene.pointLight.vertexes[0].a_position = config_->pointLightPosition;
+		scene.pointLight.UpdateVertexes();
+		scene.pointLight.material->baseColor = glm::vec4(config_->pointLightColor, 1.0f);
+	}
+
+private:
+	int width_ = 0;
+	int height_ = 0;
+
+	float lightPositionAngle_ = glm::radians(235.f);
+
+	std::shared_ptr<Config> config_;
+	std::shared_ptr<Camera> camera_;
+	std::shared_ptr<ViewerSoftware> viewer_;
+	std::shared_ptr<ModelLoader> modelLoader_;
+};
+
+}
+
+#endif
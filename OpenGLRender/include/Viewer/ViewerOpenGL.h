@@ -31,6 +31,13 @@ public:
 	}
 
 	int swapBuffer() override {
+		// 记录本帧经过状态缓存的GL调用数，供配置面板显示，然后重新计数。
+		// 统计是进程全局的，包含本帧所有OpenGL渲染（阴影、IBL生成等）
+		const StateCacheStats& stats = RendererOpenGL::getGlobalStateCacheStats();
+		config_.glStateIssued_ = stats.issued;
+		config_.glStateSkipped_ = stats.skipped;
+		RendererOpenGL::resetGlobalStateCacheStats();
+
 		int width = texColorMain_->width;
 		int height = texColorMain_->height;
 
@@ -2,7 +2,9 @@
 #define VIEWERSOFTWARE_H
 
 #include "Viewer/Viewer.h"
+#ifndef SOFTGL_HEADLESS
 #include "Render/OpenGL/OpenGLUtils.h"
+#endif
 #include "Render/Software/RendererSoft.h"
 #include "Render/Software/TextureSoft.h"
 #include "Viewer/Shader/Software/ShaderSoft.h"
@@ -21,10 +23,19 @@ public:
         cameraDepth_->setReverseZ(config_.reverseZ);
     }
 
-    /*获取软件渲染的颜色缓冲区,通过glTexSubImage2D上传到GPU纹理*/
-    int swapBuffer() override {
+    // 软件渲染最终输出的颜色缓冲区（已完成MSAA resolve与FXAA），第0行为图像底部
+    std::shared_ptr<Buffer<RGBA>> getColorBuffer() {
         auto* texOut = dynamic_cast<TextureSoft<RGBA> *>(texColorMain_.get());
-        auto buffer = texOut->getImage().getBuffer()->buffer;
+        if (!texOut) {
+            return nullptr;
+        }
+        return texOut->getImage().getBuffer()->buffer;
+    }
+
+    /*获取软件渲染的颜色缓冲区,通过glTexSubImage2D上传到GPU纹理；无窗口构建中没有GL上下文，不上传*/
+    int swapBuffer() override {
+#ifndef SOFTGL_HEADLESS
+        auto buffer = getColorBuffer();
         GL_CHECK(glBindTexture(GL_TEXTURE_2D, outTexId_));
         GL_CHECK(glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0,
                                  (int)buffer->getWidth(),
@@ -32,6 +43,7 @@ public:
                                  GL_RGBA,
                                  GL_UNSIGNED_BYTE,
                                  buffer->getRawDataPtr()));
+#endif
         return outTexId_;
     }
 
@@ -1,10 +1,9 @@
-#include "Viewer/configPanel.h"
+#include "Viewer/ConfigPanel.h"
+#include "Viewer/AssetsConfig.h"
 #include "imgui.h"
 #include "imgui_impl_glfw.h"
 #include "imgui_impl_opengl3.h"
-#include "json11/json11.hpp"
 #include "Base/Logger.h"
-#include "Base/FileUtils.h"
 
 
 namespace OpenGL {
@@ -94,6 +93,10 @@ void ConfigPanel::drawSettings() {
     ImGui::Separator();
     ImGui::Text("fps: %.1f (%.2f ms/frame)", ImGui::GetIO().Framerate, 1000.0f / ImGui::GetIO().Framerate);
     ImGui::Text("triangles: %zu", config_.triangleCount_);
+    if (config_.rendererType == Renderer_OPENGL) {
+        ImGui::Text("gl state calls: %llu issued, %llu skipped",
+                    (unsigned long long)config_.glStateIssued_, (unsigned long long)config_.glStateSkipped_);
+    }
 
     // ---------------------------------模型加载--------------------------------------------
     ImGui::Separator();
@@ -117,6 +120,12 @@ void ConfigPanel::drawSettings() {
     if (config_.showSkybox) {
         // pbr ibl
         ImGui::Checkbox("enable IBL", &config_.pbrIbl);
+        if (config_.pbrIbl && config_.rendererType == Renderer_SOFT) {
+            // 切换算法后重新加载天空盒，重新生成irradiance map
+            if (ImGui::Checkbox("SH irradiance", &config_.iblIrradianceSH) && reloadSkyboxFunc_) {
+                reloadSkyboxFunc_(config_.skyboxPath);
+            }
+        }
 
         // 查找当前天空盒索引
         int skyboxIdx = 0;
@@ -204,6 +213,24 @@ void ConfigPanel::drawSettings() {
         }
         ImGui::SameLine();
     }
+
+    // MSAA sample count
+    if (config_.aaType == AAType_MSAA) {
+        const char* sampleItems[] = {
+            "2x",
+            "4x",
+            "8x",
+        };
+        const int sampleCounts[] = { 2, 4, 8 };
+        ImGui::NewLine();
+        ImGui::Text("MSAA samples");
+        for (int i = 0; i < 3; i++) {
+            if (ImGui::RadioButton(sampleItems[i], config_.msaaSamples == sampleCounts[i])) {
+                config_.msaaSamples = sampleCounts[i];
+            }
+            ImGui::SameLine();
+        }
+    }
 }
 
 /*此函数负责清理ImGui相关的所有资源，包括：
@@ -245,28 +272,12 @@ bool ConfigPanel::wantCaptureMouse() {
 
 //加载并解析配置文件，初始化模型和天空盒资源路径
 bool ConfigPanel::loadConfig() {
-    auto configPath = ASSETS_DIR + "assets.json"; //构建完整配置文件路径
-    //读取配置文件内容
-    auto configStr = FileUtils::readText(configPath);
-    if (configStr.empty()) {
-        LOGE("load models failed: error read config file");
-        return false;
-    }
-
-    // 使用json11解析JSON配置
-    std::string err;
-    const auto json = json11::Json::parse(configStr, err);
-    for (auto& kv : json["model"].object_items()) {// 解析模型路径
-        modelPaths_[kv.first] = ASSETS_DIR + kv.second["path"].string_value();
-    }
-    for (auto& kv : json["skybox"].object_items()) {// 解析天空盒路径
-        skyboxPaths_[kv.first] = ASSETS_DIR + kv.second["path"].string_value();
-    }
-
-    if (modelPaths_.empty()) {// 验证至少加载了一个模型
-        LOGE("load models failed: %s", err.c_str());
+    AssetsConfig assets;
+    if (!assets.load()) {
         return false;
     }
+    modelPaths_ = std::move(assets.modelPaths);
+    skyboxPaths_ = std::move(assets.skyboxPaths);
 
     //准备ImGui下拉菜单需要的数据
     for (const auto& kv : modelPaths_) {
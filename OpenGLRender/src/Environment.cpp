@@ -2,6 +2,10 @@
 #include "Viewer/ModelLoader.h"
 #include "Base/hashUtils.h"
 #include "Base/Logger.h"
+#include "Base/ThreadPool.h"
+#include "Render/Software/RendererSoft.h"
+#include "Render/Software/SIMDKernelsSoft.h"
+#include "Render/Software/SamplerSoft.h"
 #include "Render/Software/TextureSoft.h"
 #include <memory>
 
@@ -9,6 +13,9 @@ namespace OpenGL {
 // 存储辐照度贴图、预滤波贴图的路径
 const std::string IBL_TEX_CACHE_DIR = "./cache/IBL/";
 
+// 生成算法（着色器采样数等）变化时递增，已有缓存随之失效
+constexpr uint32_t IBL_GENERATOR_VERSION = 2;
+
 struct LookAtParam {
     glm::vec3 eye; // 相机位置
     glm::vec3 center;
@@ -19,86 +26,344 @@ bool IBLGenerator::convertEquirectangular(const std::function<bool(ShaderProgram
     const std::shared_ptr<Texture>& texIn,
     std::shared_ptr<Texture>& texOut) {
     texOut->tag = texIn->tag + ".cubeMap";
-    if (loadFromCache(texOut)) {
+    return generateCubeMap(shaderFunc, texIn, texOut, MaterialTexType_EQUIRECTANGULAR, 1, false);
+}
+
+bool IBLGenerator::generateIrradianceMap(const std::function<bool(ShaderProgram& program)>& shaderFunc,
+                                         const std::shared_ptr<Texture>& texIn,
+                                         std::shared_ptr<Texture>& texOut) {
+    texOut->tag = texIn->tag + ".irradianceMap";
+    return generateCubeMap(shaderFunc, texIn, texOut, MaterialTexType_CUBE, 1, false);
+}
+
+bool IBLGenerator::generateIrradianceMapSH(const std::shared_ptr<Texture>& texIn, std::shared_ptr<Texture>& texOut) {
+    texOut->tag = texIn->tag + ".irradianceMapSH";
+    if (renderer_->type() != Renderer_SOFT || texIn->format != TextureFormat_RGBA8 || texOut->format != TextureFormat_RGBA8) {
+        LOGE("generate irradiance map by SH failed: only RGBA8 software textures supported");
+        return false;
+    }
+
+    auto paramsKey = getGenerateParamsKey(texIn, texOut, 1, false);
+    if (loadFromCache(texOut, paramsKey)) {
         return true;
     }
-    contextCache_.push_back(std::make_shared<CubeRenderContext>());
-    CubeRenderContext& ctx = *contextCache_.back();
-    bool success = createCubeRenderContext(ctx,
-                                           shaderFunc,
-                                           std::dynamic_pointer_cast<Texture>(texIn),
-                                           MaterialTexType_EQUIRECTANGULAR);
-    if (!success) {
-        LOGE("create render context failed");
+
+    SHCoefficients sh{};
+    if (!projectCubeMapSH(texIn, sh)) {
         return false;
     }
 
-    drawCubeFaces(ctx, texOut->width, texOut->height, texOut);
-    storeToCache(texOut);
+    // irradiance map只有32x32，逐像素计算9项多项式即可
+    auto* cubeOut = dynamic_cast<TextureSoft<RGBA> *>(texOut.get());
+    for (int face = 0; face < 6; face++) {
+        auto& buffer = cubeOut->getImage((CubeMapFace)face).getBuffer(0)->buffer;
+        int width = (int)buffer->getWidth();
+        int height = (int)buffer->getHeight();
+        for (int y = 0; y < height; y++) {
+            for (int x = 0; x < width; x++) {
+                glm::vec3 dir = BaseSamplerCube<RGBA>::convertUV2XYZ(face, ((float)x + 0.5f) / (float)width,
+                                                                     ((float)y + 0.5f) / (float)height);
+                glm::vec3 irradiance = evalIrradianceSH(sh, glm::normalize(dir));
+                glm::vec3 color = glm::clamp(irradiance, 0.f, 1.f) * 255.f + 0.5f;
+                buffer->set(x, y, RGBA((uint8_t)color.r, (uint8_t)color.g, (uint8_t)color.b, 255));
+            }
+        }
+    }
+
+    storeToCache(texOut, paramsKey);
     return true;
 }
 
-bool IBLGenerator::generateIrradianceMap(const std::function<bool(ShaderProgram& program)>& shaderFunc,
-                                         const std::shared_ptr<Texture>& texIn,
-                                         std::shared_ptr<Texture>& texOut) {
-    texOut->tag = texIn->tag + ".irradianceMap";
-    if (loadFromCache(texOut)) {
-        return true;
+bool IBLGenerator::projectCubeMapSH(const std::shared_ptr<Texture>& texIn, SHCoefficients& sh) {
+    auto* cubeIn = dynamic_cast<TextureSoft<RGBA> *>(texIn.get());
+    if (!cubeIn || cubeIn->type != TextureType_CUBE) {
+        LOGE("project SH failed: input is not a software RGBA8 cube map");
+        return false;
     }
-    contextCache_.push_back(std::make_shared<CubeRenderContext>());
-    CubeRenderContext& ctx = *contextCache_.back();
-    bool success = createCubeRenderContext(ctx,
-                                           shaderFunc,
-                                           std::dynamic_pointer_cast<Texture>(texIn),
-                                           MaterialTexType_CUBE);
-    if (!success) {
-        LOGE("create render context failed");
+
+    // 每个线程独立累加（双精度），结束后再合并，避免原子操作与精度损失
+    struct Accumulator {
+        glm::dvec3 coeffs[9];
+        double weightSum = 0.0;
+    };
+
+    std::vector<Accumulator> partials(workerCnt_);
+
+    ThreadPool pool(workerCnt_);
+    for (int face = 0; face < 6; face++) {
+        auto& buffer = cubeIn->getImage((CubeMapFace)face).getBuffer(0)->buffer;
+        int width = (int)buffer->getWidth();
+        int height = (int)buffer->getHeight();
+        for (int y = 0; y < height; y++) {
+            pool.pushTask([&, face, y, width, height](size_t threadId) {
+                Accumulator& acc = partials[threadId];
+                float v = ((float)y + 0.5f) / (float)height;
+                for (int x = 0; x < width; x++) {
+                    float u = ((float)x + 0.5f) / (float)width;
+                    glm::vec3 dir = BaseSamplerCube<RGBA>::convertUV2XYZ(face, u, v);
+
+                    // 像素对应的立体角：dA / (1 + s^2 + t^2)^(3/2)，dA为像素在[-1, 1]面上的面积
+                    float lenSq = glm::dot(dir, dir);
+                    double weight = 4.0 / ((double)width * height * lenSq * std::sqrt(lenSq));
+                    glm::vec3 n = dir / std::sqrt(lenSq);
+
+                    RGBA* texel = buffer->get(x, y);
+                    glm::dvec3 radiance = glm::dvec3(texel->r, texel->g, texel->b) * (weight / 255.0);
+
+                    // 实数球谐基函数
+                    acc.coeffs[0] += radiance * 0.282095;
+                    acc.coeffs[1] += radiance * (0.488603 * n.y);
+                    acc.coeffs[2] += radiance * (0.488603 * n.z);
+                    acc.coeffs[3] += radiance * (0.488603 * n.x);
+                    acc.coeffs[4] += radiance * (1.092548 * n.x * n.y);
+                    acc.coeffs[5] += radiance * (1.092548 * n.y * n.z);
+                    acc.coeffs[6] += radiance * (0.315392 * (3.0 * n.z * n.z - 1.0));
+                    acc.coeffs[7] += radiance * (1.092548 * n.x * n.z);
+                    acc.coeffs[8] += radiance * (0.546274 * (n.x * n.x - n.y * n.y));
+                    acc.weightSum += weight;
+                }
+            });
+        }
+    }
+    pool.waitTasksFinish();
+
+    Accumulator total{};
+    for (auto& acc : partials) {
+        for (int i = 0; i < 9; i++) {
+            total.coeffs[i] += acc.coeffs[i];
+        }
+        total.weightSum += acc.weightSum;
+    }
+    if (total.weightSum <= 0.0) {
+        LOGE("project SH failed: empty cube map");
         return false;
     }
 
-    drawCubeFaces(ctx, texOut->width, texOut->height, texOut);
-    storeToCache(texOut);
+    // 离散立体角之和归一化到4PI
+    double scale = 4.0 * glm::pi<double>() / total.weightSum;
+    for (int i = 0; i < 9; i++) {
+        sh.coeffs[i] = glm::vec3(total.coeffs[i] * scale);
+    }
     return true;
 }
 
+// Ref: Ramamoorthi & Hanrahan, An Efficient Representation for Irradiance Environment Maps
+glm::vec3 IBLGenerator::evalIrradianceSH(const SHCoefficients& sh, const glm::vec3& n) {
+    // 余弦卷积核的各阶系数：A0 = PI, A1 = 2PI/3, A2 = PI/4，最后整体除以PI
+    const float a0 = 1.f;
+    const float a1 = 2.f / 3.f;
+    const float a2 = 1.f / 4.f;
+
+    const glm::vec3* c = sh.coeffs;
+    glm::vec3 irradiance = c[0] * (a0 * 0.282095f)
+        + (c[1] * n.y + c[2] * n.z + c[3] * n.x) * (a1 * 0.488603f)
+        + (c[4] * (n.x * n.y) + c[5] * (n.y * n.z) + c[7] * (n.x * n.z)) * (a2 * 1.092548f)
+        + c[6] * (a2 * 0.315392f * (3.f * n.z * n.z - 1.f))
+        + c[8] * (a2 * 0.546274f * (n.x * n.x - n.y * n.y));
+    return glm::max(irradiance, glm::vec3(0.f));
+}
+
 bool IBLGenerator::generatePrefilterMap(const std::function<bool(ShaderProgram& program)>& shaderFunc,
                                         const std::shared_ptr<Texture>& texIn,
                                         std::shared_ptr<Texture>& texOut) {
     texOut->tag = texIn->tag + ".prefilterMap";
-    if (loadFromCache(texOut)) {
+
+    // 软件渲染的prefilter着色器按采样立体角从源贴图的mipmap中取值，天空盒本身的纹理不带mipmap，这里生成一份带mipmap的副本
+    std::shared_ptr<Texture> texSrc = texIn;
+    if (renderer_->type() == Renderer_SOFT && !texIn->useMipmaps) {
+        texSrc = createMipmappedCubeSoft(texIn);
+        if (!texSrc) {
+            return false;
+        }
+    }
+    return generateCubeMap(shaderFunc, texSrc, texOut, MaterialTexType_CUBE, kPrefilterMaxMipLevels, true);
+}
+
+// level 0与源纹理共享内存，其余级别由双线性下采样生成
+std::shared_ptr<Texture> IBLGenerator::createMipmappedCubeSoft(const std::shared_ptr<Texture>& texIn) {
+    auto* cubeIn = dynamic_cast<TextureSoft<RGBA> *>(texIn.get());
+    if (!cubeIn || cubeIn->type != TextureType_CUBE) {
+        LOGE("create mipmapped cube map failed: input is not a software RGBA8 cube map");
+        return nullptr;
+    }
+
+    TextureDesc desc{};
+    desc.width = texIn->width;
+    desc.height = texIn->height;
+    desc.type = TextureType_CUBE;
+    desc.format = TextureFormat_RGBA8;
+    desc.usage = TextureUsage_Sampler;
+    desc.useMipmaps = true;
+    desc.multiSample = false;
+    auto texOut = renderer_->createTexture(desc);
+    if (!texOut) {
+        return nullptr;
+    }
+
+    SamplerDesc sampler = cubeIn->getSamplerDesc();
+    sampler.filterMin = Filter_LINEAR_MIPMAP_LINEAR;
+    sampler.filterMag = Filter_LINEAR;
+    texOut->setSamplerDesc(sampler);
+    texOut->tag = texIn->tag;
+
+    std::vector<std::shared_ptr<Buffer<RGBA>>> buffers;
+    for (int face = 0; face < 6; face++) {
+        buffers.push_back(cubeIn->getImage((CubeMapFace)face).getBuffer(0)->buffer);
+    }
+    texOut->setImageData(buffers);
+    return texOut;
+}
+
+bool IBLGenerator::generateCubeMap(const std::function<bool(ShaderProgram& program)>& shaderFunc,
+                                   const std::shared_ptr<Texture>& texIn,
+                                   std::shared_ptr<Texture>& texOut,
+                                   MaterialTexType texType,
+                                   uint32_t levelCnt,
+                                   bool prefilter) {
+    auto paramsKey = getGenerateParamsKey(texIn, texOut, levelCnt, prefilter);
+    if (loadFromCache(texOut, paramsKey)) {
+        return true;
+    }
+
+    if (directSoft_ && renderer_->type() == Renderer_SOFT && texOut->format == TextureFormat_RGBA8) {
+        if (!generateCubeMapSoft(shaderFunc, texIn, texOut, texType, levelCnt, prefilter)) {
+            return false;
+        }
+        storeToCache(texOut, paramsKey);
         return true;
     }
+
+    // OpenGL只能在当前线程逐面绘制，软件渲染关闭directSoft_时同样逐面光栅化
     contextCache_.push_back(std::make_shared<CubeRenderContext>());
     CubeRenderContext& ctx = *contextCache_.back();
-    bool success = createCubeRenderContext(ctx,
-                                           shaderFunc,
-                                           std::dynamic_pointer_cast<Texture>(texIn),
-                                           MaterialTexType_CUBE);
+    ctx.renderer = renderer_;
+    bool success = createCubeRenderContext(ctx, shaderFunc, texIn, texType, prefilter);
     if (!success) {
         LOGE("create render context failed");
         return false;
     }
 
-    auto uniformsBlockPrefilter = renderer_->createUniformBlock("UniformsPrefilter", sizeof(UniformsIBLPrefilter));
-    ctx.modelSkybox.material->materialObj->shaderResources->blocks[UniformBlock_IBLPrefilter] = uniformsBlockPrefilter;
+    for (uint32_t level = 0; level < levelCnt; level++) {
+        for (int face = 0; face < 6; face++) {
+            drawCubeFace(ctx, texIn, texOut, face, level);
+        }
+    }
 
-    UniformsIBLPrefilter uniformsPrefilter{};
+    storeToCache(texOut, paramsKey);
+    return true;
+}
 
-    for (int level = 0; level < kPrefilterMaxMipLevels; level++) {
-        drawCubeFaces(ctx, texOut->getLevelWidth(level), texOut->getLevelHeight(level), texOut, level, [&]() -> void {
-            uniformsPrefilter.u_srcResolution = (float)texIn->width;
-            uniformsPrefilter.u_roughness = (float)level / (float)(kPrefilterMaxMipLevels - 1);
-            uniformsBlockPrefilter->setData(&uniformsPrefilter, sizeof(UniformsIBLPrefilter));
-        });
+bool IBLGenerator::generateCubeMapSoft(const std::function<bool(ShaderProgram& program)>& shaderFunc,
+                                       const std::shared_ptr<Texture>& texIn,
+                                       std::shared_ptr<Texture>& texOut,
+                                       MaterialTexType texType,
+                                       uint32_t levelCnt,
+                                       bool prefilter) {
+    auto* cubeOut = dynamic_cast<TextureSoft<RGBA> *>(texOut.get());
+    if (!cubeOut || cubeOut->type != TextureType_CUBE) {
+        LOGE("generate cube map failed: output is not a software RGBA8 cube map");
+        return false;
     }
-    storeToCache(texOut);
+
+    // 每个工作线程一个着色器程序：prefilter的粗糙度随级别变化，共享uniform缓冲会互相覆盖
+    struct Worker {
+        std::shared_ptr<ShaderProgramSoft> program;
+        std::shared_ptr<UniformSampler> sampler;
+        std::shared_ptr<float> varyings;
+        int prefilterLocation = -1;
+    };
+
+    // 每行的计算量随采样数变化，行块大小按约4096个texel划分，保证小尺寸的级别也能并行
+    constexpr int kTaskTexelCnt = 4096;
+    size_t taskCnt = 0;
+    for (uint32_t level = 0; level < levelCnt; level++) {
+        int width = texOut->getLevelWidth(level);
+        int height = texOut->getLevelHeight(level);
+        int rowsPerTask = std::max(1, kTaskTexelCnt / width);
+        taskCnt += 6 * (size_t)((height + rowsPerTask - 1) / rowsPerTask);
+    }
+    size_t workerCnt = std::min<size_t>(taskCnt, workerCnt_);
+
+    const char* samplerName = Material::samplerName(texType);
+    std::vector<Worker> workers(workerCnt);
+    for (auto& worker : workers) {
+        worker.program = std::dynamic_pointer_cast<ShaderProgramSoft>(renderer_->createShaderProgram());
+        worker.program->addDefines({ Material::samplerDefine(texType) });
+        if (!shaderFunc(*worker.program)) {
+            LOGE("create shader program failed");
+            return false;
+        }
+
+        worker.sampler = renderer_->createUniformSampler(samplerName, *texIn);
+        worker.sampler->setTexture(texIn);
+        worker.sampler->bindProgram(*worker.program, worker.sampler->getLocation(*worker.program));
+
+        if (prefilter) {
+            worker.prefilterLocation = worker.program->getUniformLocation("UniformsPrefilter");
+        }
+
+        // 顶点着色器输出的varyings直接作为片段着色器的输入
+        worker.varyings = MemoryUtils::makeAlignedBuffer<float>(
+            std::max<size_t>(1, worker.program->getShaderVaryingsSize() / sizeof(float)));
+        worker.program->bindVertexShaderVaryings(worker.varyings.get());
+        worker.program->bindFragmentShaderVaryings(worker.varyings.get());
+        worker.program->prepareFragmentShader();
+    }
+
+    const auto& kernels = SIMDDispatch::kernels();
+    ThreadPool pool(workerCnt);
+    // 高分辨率的级别耗时最长，先提交
+    for (uint32_t level = 0; level < levelCnt; level++) {
+        UniformsIBLPrefilter uniformsPrefilter{};
+        uniformsPrefilter.u_srcResolution = (float)texIn->width;
+        uniformsPrefilter.u_roughness = (float)level / (float)(kPrefilterMaxMipLevels - 1);
+
+        int width = texOut->getLevelWidth(level);
+        int height = texOut->getLevelHeight(level);
+        int rowsPerTask = std::max(1, kTaskTexelCnt / width);
+        for (int face = 0; face < 6; face++) {
+            auto& buffer = cubeOut->getImage((CubeMapFace)face).getBuffer(level)->buffer;
+            for (int rowStart = 0; rowStart < height; rowStart += rowsPerTask) {
+                int rowEnd = std::min(height, rowStart + rowsPerTask);
+                pool.pushTask([&, uniformsPrefilter, face, width, height, rowStart, rowEnd](size_t threadId) {
+                    Worker& worker = workers[threadId];
+                    auto& program = *worker.program;
+                    if (worker.prefilterLocation >= 0) {
+                        UniformsIBLPrefilter uniforms = uniformsPrefilter;
+                        program.bindUniformBlockBuffer(&uniforms, sizeof(UniformsIBLPrefilter), worker.prefilterLocation);
+                    }
+
+                    // 顶点着色器只把立方体上的位置写入v_worldPos，这里用texel中心对应的方向代替光栅化插值的结果
+                    Vertex vertex{};
+                    program.bindVertexAttributes(&vertex);
+                    auto& builtin = program.getShaderBuiltin();
+                    for (int y = rowStart; y < rowEnd; y++) {
+                        float v = ((float)y + 0.5f) / (float)height;
+                        for (int x = 0; x < width; x++) {
+                            float u = ((float)x + 0.5f) / (float)width;
+                            vertex.a_position = BaseSamplerCube<RGBA>::convertUV2XYZ(face, u, v);
+                            program.execVertexShader();
+
+                            builtin.FragCoord = glm::vec4((float)x + 0.5f, (float)y + 0.5f, 0.f, 1.f);
+                            program.execFragmentShader();
+                            kernels.storeColor(builtin.FragColor, buffer->get(x, y));
+                        }
+                    }
+                });
+            }
+        }
+    }
+    pool.waitTasksFinish();
     return true;
 }
 
 bool IBLGenerator::createCubeRenderContext(CubeRenderContext& ctx,
                                            const std::function<bool(ShaderProgram& program)>& shaderFunc,
                                            const std::shared_ptr<Texture>& texIn,
-                                           MaterialTexType texType) {
+                                           MaterialTexType texType,
+                                           bool prefilter) {
+    auto& renderer = ctx.renderer;
+
     // camera
     ctx.camera.setPerspective(glm::radians(90.f), 1.f, 0.1f, 10.f);
 
@@ -110,14 +375,14 @@ bool IBLGenerator::createCubeRenderContext(CubeRenderContext& ctx,
     ctx.modelSkybox.material->materialObj = std::make_shared<MaterialObject>();
 
     // fbo
-    ctx.fbo = renderer_->createFrameBuffer(true);
+    ctx.fbo = renderer->createFrameBuffer(true);
 
     // vao
-    ctx.modelSkybox.vao = renderer_->createVertexArrayObject(ctx.modelSkybox);
+    ctx.modelSkybox.vao = renderer->createVertexArrayObject(ctx.modelSkybox);
 
     // shader program
     std::set<std::string> shaderDefines = { Material::samplerDefine(texType) };
-    auto program = renderer_->createShaderProgram();
+    auto program = renderer->createShaderProgram();
     program->addDefines(shaderDefines);
     bool success = shaderFunc(*program);
     if (!success) {
@@ -129,22 +394,27 @@ bool IBLGenerator::createCubeRenderContext(CubeRenderContext& ctx,
 
     // uniforms
     const char* samplerName = Material::samplerName(texType);
-    auto uniform = renderer_->createUniformSampler(samplerName, *texIn);
+    auto uniform = renderer->createUniformSampler(samplerName, *texIn);
     uniform->setTexture(texIn);
     ctx.modelSkybox.material->materialObj->shaderResources->samplers[texType] = uniform;
 
-    ctx.uniformsBlockModel = renderer_->createUniformBlock("UniformsModel", sizeof(UniformsModel));
+    ctx.uniformsBlockModel = renderer->createUniformBlock("UniformsModel", sizeof(UniformsModel));
     ctx.modelSkybox.material->materialObj->shaderResources->blocks[UniformBlock_Model] = ctx.uniformsBlockModel;
 
+    if (prefilter) {
+        ctx.uniformsBlockPrefilter = renderer->createUniformBlock("UniformsPrefilter", sizeof(UniformsIBLPrefilter));
+        ctx.modelSkybox.material->materialObj->shaderResources->blocks[UniformBlock_IBLPrefilter] = ctx.uniformsBlockPrefilter;
+    }
+
     // pipeline
-    ctx.modelSkybox.material->materialObj->pipelineStates = renderer_->createPipelineStates({});
+    ctx.modelSkybox.material->materialObj->pipelineStates = renderer->createPipelineStates({});
 
     return true;
 }
 
-//为IBL生成立方体贴图的六个面，每个面使用不同的视角进行渲染
-void IBLGenerator::drawCubeFaces(CubeRenderContext& ctx, uint32_t width, uint32_t height, std::shared_ptr<Texture>& texOut,
-    uint32_t texOutLevel, const std::function<void()>& beforeDraw) {
+//使用对应的视角渲染立方体贴图一个面的一个mip级别
+void IBLGenerator::drawCubeFace(CubeRenderContext& ctx, const std::shared_ptr<Texture>& texIn, std::shared_ptr<Texture>& texOut,
+                                int face, uint32_t texOutLevel) {
     static LookAtParam captureViews[] = {
         {glm::vec3(0.0f, 0.0f, 0.0f), glm::vec3(1.0f, 0.0f, 0.0f), glm::vec3(0.0f, -1.0f, 0.0f)},
         {glm::vec3(0.0f, 0.0f, 0.0f), glm::vec3(-1.0f, 0.0f, 0.0f), glm::vec3(0.0f, -1.0f, 0.0f)},
@@ -157,36 +427,38 @@ void IBLGenerator::drawCubeFaces(CubeRenderContext& ctx, uint32_t width, uint32_
     UniformsModel uniformsModel{};
     glm::mat4 modelMatrix(1.f);
 
-    for (int i = 0; i < 6; i++) {
-        auto& param = captureViews[i];
-        ctx.camera.lookAt(param.eye, param.center, param.up);
-
-        // 更新 mvp
-        glm::mat4 viewMatrix = glm::mat3(ctx.camera.viewMatrix());  // only rotation
-        uniformsModel.u_modelViewProjectionMatrix = ctx.camera.projectionMatrix() * viewMatrix * modelMatrix;
-        ctx.uniformsBlockModel->setData(&uniformsModel, sizeof(UniformsModel));
+    auto& param = captureViews[face];
+    ctx.camera.lookAt(param.eye, param.center, param.up);
 
-        
-        if (beforeDraw) {
-            beforeDraw();//执行渲染前的回调函数
-        }
-
-        auto& materialObj = ctx.modelSkybox.material->materialObj;
-        ctx.fbo->setColorAttachment(texOut, CubeMapFace(TEXTURE_CUBE_MAP_POSITIVE_X + i), texOutLevel);
+    // 更新 mvp
+    glm::mat4 viewMatrix = glm::mat3(ctx.camera.viewMatrix());  // only rotation
+    uniformsModel.u_modelViewProjectionMatrix = ctx.camera.projectionMatrix() * viewMatrix * modelMatrix;
+    ctx.uniformsBlockModel->setData(&uniformsModel, sizeof(UniformsModel));
 
-        ClearStates clearStates{};
-        clearStates.colorFlag = true;// 只清除颜色缓冲
-         
-        // draw
-        renderer_->beginRenderPass(ctx.fbo, clearStates);
-        renderer_->setViewPort(0, 0, width, height);
-        renderer_->setVertexArrayObject(ctx.modelSkybox.vao);
-        renderer_->setShaderProgram(materialObj->shaderProgram);
-        renderer_->setShaderResources(materialObj->shaderResources);
-        renderer_->setPipelineStates(materialObj->pipelineStates);
-        renderer_->draw();
-        renderer_->endRenderPass();
+    // prefilter map每个mip级别对应不同的粗糙度
+    if (ctx.uniformsBlockPrefilter) {
+        UniformsIBLPrefilter uniformsPrefilter{};
+        uniformsPrefilter.u_srcResolution = (float)texIn->width;
+        uniformsPrefilter.u_roughness = (float)texOutLevel / (float)(kPrefilterMaxMipLevels - 1);
+        ctx.uniformsBlockPrefilter->setData(&uniformsPrefilter, sizeof(UniformsIBLPrefilter));
     }
+
+    auto& renderer = ctx.renderer;
+    auto& materialObj = ctx.modelSkybox.material->materialObj;
+    ctx.fbo->setColorAttachment(texOut, CubeMapFace(TEXTURE_CUBE_MAP_POSITIVE_X + face), texOutLevel);
+
+    ClearStates clearStates{};
+    clearStates.colorFlag = true;// 只清除颜色缓冲
+
+    // draw
+    renderer->beginRenderPass(ctx.fbo, clearStates);
+    renderer->setViewPort(0, 0, texOut->getLevelWidth(texOutLevel), texOut->getLevelHeight(texOutLevel));
+    renderer->setVertexArrayObject(ctx.modelSkybox.vao);
+    renderer->setShaderProgram(materialObj->shaderProgram);
+    renderer->setShaderResources(materialObj->shaderResources);
+    renderer->setPipelineStates(materialObj->pipelineStates);
+    renderer->draw();
+    renderer->endRenderPass();
 }
 
 std::string IBLGenerator::getTextureHashKey(std::shared_ptr<Texture>& tex) {
@@ -194,13 +466,24 @@ std::string IBLGenerator::getTextureHashKey(std::shared_ptr<Texture>& tex) {
 }
 
 std::string IBLGenerator::getCacheFilePath(const std::string& hashKey) {
-    // TODO make directories if not exist
     return IBL_TEX_CACHE_DIR + hashKey + ".tex";
 }
 
-bool IBLGenerator::loadFromCache(std::shared_ptr<Texture>& tex) {
+// 生成参数的摘要，写入缓存文件头；输入纹理尺寸、级别数或生成算法变化时旧缓存失效
+std::string IBLGenerator::getGenerateParamsKey(const std::shared_ptr<Texture>& texIn, std::shared_ptr<Texture>& texOut,
+                                               uint32_t levelCnt, bool prefilter) {
+    std::string params = texOut->tag
+        + "|generator:" + std::to_string(IBL_GENERATOR_VERSION)
+        + "|in:" + std::to_string(texIn->width) + "x" + std::to_string(texIn->height)
+        + "|out:" + std::to_string(texOut->width) + "x" + std::to_string(texOut->height)
+        + "|levels:" + std::to_string(levelCnt)
+        + "|prefilter:" + std::to_string(prefilter ? kPrefilterMaxMipLevels : 0);
+    return HashUtils::getHashMD5(params);
+}
+
+bool IBLGenerator::loadFromCache(std::shared_ptr<Texture>& tex, const std::string& paramsKey) {
     // only software renderer need cache
-    if (renderer_->type() != Renderer_SOFT) {
+    if (renderer_->type() != Renderer_SOFT || !cacheEnabled_) {
         return false;
     }
 
@@ -208,34 +491,32 @@ bool IBLGenerator::loadFromCache(std::shared_ptr<Texture>& tex) {
     if (!FileUtils::exists(cacheFilePath)) {
         return false;
     }
+    // 缓存过期或损坏时返回false，由调用方重新生成并覆盖
     if (tex->format == TextureFormat_RGBA8) {
         auto* texSoft = dynamic_cast<TextureSoft<RGBA> *>(tex.get());
-        return texSoft->loadFromFile(cacheFilePath.c_str());
+        return texSoft->loadFromFile(cacheFilePath.c_str(), paramsKey);
     }
     else {
         auto* texSoft = dynamic_cast<TextureSoft<float> *>(tex.get());
-        return texSoft->loadFromFile(cacheFilePath.c_str());
+        return texSoft->loadFromFile(cacheFilePath.c_str(), paramsKey);
     }
 }
 
-void IBLGenerator::storeToCache(std::shared_ptr<Texture>& tex) {
+void IBLGenerator::storeToCache(std::shared_ptr<Texture>& tex, const std::string& paramsKey) {
     // only software renderer need cache
-    if (renderer_->type() != Renderer_SOFT) {
+    if (renderer_->type() != Renderer_SOFT || !cacheEnabled_) {
         return;
     }
 
-    // TODO check md5
     auto cacheFilePath = getCacheFilePath(getTextureHashKey(tex));
     if (tex->format == TextureFormat_RGBA8) {
         auto* texSoft = dynamic_cast<TextureSoft<RGBA> *>(tex.get());
-        texSoft->storeToFile(cacheFilePath.c_str());
+        texSoft->storeToFile(cacheFilePath.c_str(), paramsKey);
     }
     else {
         auto* texSoft = dynamic_cast<TextureSoft<float> *>(tex.get());
-        texSoft->storeToFile(cacheFilePath.c_str());
+        texSoft->storeToFile(cacheFilePath.c_str(), paramsKey);
     }
 }
 
-
-
-}
\ No newline at end of file
+}
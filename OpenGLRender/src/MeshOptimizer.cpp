@@ -0,0 +1,437 @@
+#include "Viewer/MeshOptimizer.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <numeric>
+#include <unordered_map>
+#include "Base/hashUtils.h"
+
+namespace OpenGL {
+
+// overdraw统计的光栅化分辨率
+constexpr int kOverdrawViewport = 256;
+
+namespace {
+
+// 顶点各属性逐个比较（aligned vec3带有填充字节，不能整体memcmp）
+struct VertexHasher {
+	size_t operator()(const Vertex& v) const {
+		size_t seed = 0;
+		HashUtils::hashCombine(seed, v.a_position.x);
+		HashUtils::hashCombine(seed, v.a_position.y);
+		HashUtils::hashCombine(seed, v.a_position.z);
+		HashUtils::hashCombine(seed, v.a_texCoord.x);
+		HashUtils::hashCombine(seed, v.a_texCoord.y);
+		HashUtils::hashCombine(seed, v.a_normal.x);
+		HashUtils::hashCombine(seed, v.a_normal.y);
+		HashUtils::hashCombine(seed, v.a_normal.z);
+		HashUtils::hashCombine(seed, v.a_tangent.x);
+		HashUtils::hashCombine(seed, v.a_tangent.y);
+		HashUtils::hashCombine(seed, v.a_tangent.z);
+		return seed;
+	}
+};
+
+struct VertexEqual {
+	bool operator()(const Vertex& a, const Vertex& b) const {
+		return a.a_position == b.a_position && a.a_texCoord == b.a_texCoord
+			&& a.a_normal == b.a_normal && a.a_tangent == b.a_tangent;
+	}
+};
+
+// 每个顶点引用的三角形列表（CSR）
+struct TriangleAdjacency {
+	std::vector<uint32_t> offsets; // 顶点v的三角形为triangles[offsets[v], offsets[v + 1])
+	std::vector<uint32_t> triangles;
+
+	TriangleAdjacency(const std::vector<int32_t>& indices, size_t vertexCnt) {
+		offsets.assign(vertexCnt + 1, 0);
+		for (int32_t idx : indices) {
+			offsets[idx + 1]++;
+		}
+		std::partial_sum(offsets.begin(), offsets.end(), offsets.begin());
+
+		triangles.resize(indices.size());
+		std::vector<uint32_t> fill(offsets.begin(), offsets.end() - 1);
+		for (size_t i = 0; i < indices.size(); i++) {
+			triangles[fill[indices[i]]++] = (uint32_t)(i / 3);
+		}
+	}
+};
+
+// FIFO顶点缓存，用时间戳判断顶点是否还在缓存中
+class VertexCacheFIFO {
+public:
+	VertexCacheFIFO(size_t vertexCnt, size_t cacheSize)
+		: timestamps_(vertexCnt, 0), cacheSize_(cacheSize), time_(cacheSize + 1) {}
+
+	// 返回是否未命中
+	inline bool access(int32_t v) {
+		if (time_ - timestamps_[v] < cacheSize_) {
+			return false;
+		}
+		timestamps_[v] = time_++;
+		return true;
+	}
+
+	inline void reset() {
+		time_ += cacheSize_ + 1;
+	}
+
+private:
+	std::vector<size_t> timestamps_;
+	size_t cacheSize_;
+	size_t time_;
+};
+
+}
+
+void MeshOptimizer::optimize(std::vector<Vertex>& vertexes, std::vector<int32_t>& indices, MeshOptimizeStats* stats,
+                             bool overdrawStats) {
+	if (indices.size() < 3 || vertexes.empty()) {
+		return;
+	}
+
+	if (stats) {
+		stats->triangleCnt = indices.size() / 3;
+		stats->vertexCntBefore = vertexes.size();
+		stats->acmrBefore = analyzeVertexCache(indices, vertexes.size());
+		if (overdrawStats) {
+			stats->overdrawBefore = analyzeOverdraw(vertexes, indices);
+		}
+	}
+
+	weldVertexes(vertexes, indices);
+
+	optimizeVertexCache(indices, vertexes.size());
+	optimizeOverdraw(indices, vertexes);
+	optimizeVertexFetch(vertexes, indices);
+
+	if (stats) {
+		stats->vertexCntAfter = vertexes.size();
+		stats->acmrAfter = analyzeVertexCache(indices, vertexes.size());
+		if (overdrawStats) {
+			stats->overdrawAfter = analyzeOverdraw(vertexes, indices);
+		}
+	}
+}
+
+size_t MeshOptimizer::weldVertexes(std::vector<Vertex>& vertexes, std::vector<int32_t>& indices) {
+	std::unordered_map<Vertex, int32_t, VertexHasher, VertexEqual> uniqueMap;
+	uniqueMap.reserve(vertexes.size());
+
+	std::vector<int32_t> remap(vertexes.size());
+	std::vector<Vertex> welded;
+	welded.reserve(vertexes.size());
+	for (size_t i = 0; i < vertexes.size(); i++) {
+		auto it = uniqueMap.emplace(vertexes[i], (int32_t)welded.size());
+		if (it.second) {
+			welded.push_back(vertexes[i]);
+		}
+		remap[i] = it.first->second;
+	}
+
+	for (auto& idx : indices) {
+		idx = remap[idx];
+	}
+	vertexes = std::move(welded);
+	return vertexes.size();
+}
+
+void MeshOptimizer::optimizeVertexCache(std::vector<int32_t>& indices, size_t vertexCnt) {
+	const size_t triangleCnt = indices.size() / 3;
+	const int32_t cacheSize = (int32_t)kVertexCacheSize;
+	TriangleAdjacency adjacency(indices, vertexCnt);
+
+	std::vector<int32_t> liveCnt(vertexCnt);
+	for (size_t v = 0; v < vertexCnt; v++) {
+		liveCnt[v] = (int32_t)(adjacency.offsets[v + 1] - adjacency.offsets[v]);
+	}
+	std::vector<int32_t> cacheTime(vertexCnt, 0);
+	std::vector<bool> emitted(triangleCnt, false);
+	std::vector<int32_t> deadEnd;
+	std::vector<int32_t> candidates;
+
+	std::vector<int32_t> output;
+	output.reserve(indices.size());
+
+	int32_t time = cacheSize + 1;
+	size_t cursor = 0;
+	int32_t fanning = 0;
+	while (fanning >= 0) {
+		// 输出fanning顶点所有未输出的三角形，其顶点作为下一个fanning顶点的候选
+		candidates.clear();
+		for (uint32_t i = adjacency.offsets[fanning]; i < adjacency.offsets[fanning + 1]; i++) {
+			uint32_t tri = adjacency.triangles[i];
+			if (emitted[tri]) {
+				continue;
+			}
+			for (int k = 0; k < 3; k++) {
+				int32_t v = indices[tri * 3 + k];
+				output.push_back(v);
+				deadEnd.push_back(v);
+				candidates.push_back(v);
+				liveCnt[v]--;
+				if (time - cacheTime[v] > cacheSize) {
+					cacheTime[v] = time++;
+				}
+			}
+			emitted[tri] = true;
+		}
+
+		// 选择输出剩余三角形后仍在缓存中、且在缓存中时间最长的候选顶点
+		int32_t next = -1;
+		int32_t bestPriority = -1;
+		for (int32_t v : candidates) {
+			if (liveCnt[v] <= 0) {
+				continue;
+			}
+			int32_t priority = 0;
+			if (time - cacheTime[v] + 2 * liveCnt[v] <= cacheSize) {
+				priority = time - cacheTime[v];
+			}
+			if (priority > bestPriority) {
+				bestPriority = priority;
+				next = v;
+			}
+		}
+
+		// 没有可继续的候选顶点：从最近输出的顶点中回溯，再按顶点序号查找
+		if (next < 0) {
+			while (!deadEnd.empty()) {
+				int32_t v = deadEnd.back();
+				deadEnd.pop_back();
+				if (liveCnt[v] > 0) {
+					next = v;
+					break;
+				}
+			}
+			while (next < 0 && cursor < vertexCnt) {
+				if (liveCnt[cursor] > 0) {
+					next = (int32_t)cursor;
+				}
+				cursor++;
+			}
+		}
+		fanning = next;
+	}
+
+	indices = std::move(output);
+}
+
+void MeshOptimizer::optimizeOverdraw(std::vector<int32_t>& indices, const std::vector<Vertex>& vertexes, float threshold) {
+	const size_t triangleCnt = indices.size() / 3;
+	if (triangleCnt == 0) {
+		return;
+	}
+
+	// 3个顶点都未命中时，通常是开始处理网格中与之前不相连的一块
+	std::vector<size_t> clusters;
+	VertexCacheFIFO cache(vertexes.size(), kVertexCacheSize);
+	for (size_t tri = 0; tri < triangleCnt; tri++) {
+		size_t misses = 0;
+		for (int k = 0; k < 3; k++) {
+			misses += cache.access(indices[tri * 3 + k]);
+		}
+		if (tri == 0 || misses == 3) {
+			clusters.push_back(tri);
+		}
+	}
+
+	// 在每个簇内，当从簇起点开始的ACMR不超过整个簇ACMR * threshold时切分，切分后各簇的缓存命中率基本不变
+	std::vector<size_t> boundaries;
+	for (size_t c = 0; c < clusters.size(); c++) {
+		size_t start = clusters[c];
+		size_t end = c + 1 < clusters.size() ? clusters[c + 1] : triangleCnt;
+
+		cache.reset();
+		size_t clusterMisses = 0;
+		for (size_t i = start * 3; i < end * 3; i++) {
+			clusterMisses += cache.access(indices[i]);
+		}
+		float clusterAcmr = (float)clusterMisses / (float)(end - start);
+
+		cache.reset();
+		size_t subStart = start;
+		size_t misses = 0;
+		boundaries.push_back(start);
+		for (size_t tri = start; tri < end; tri++) {
+			for (int k = 0; k < 3; k++) {
+				misses += cache.access(indices[tri * 3 + k]);
+			}
+			size_t subEnd = tri + 1;
+			if (subEnd < end && (float)misses <= clusterAcmr * threshold * (float)(subEnd - subStart)) {
+				boundaries.push_back(subEnd);
+				subStart = subEnd;
+				misses = 0;
+				cache.reset();
+			}
+		}
+	}
+	boundaries.push_back(triangleCnt);
+
+	// 网格中心（按面积加权）
+	glm::vec3 meshCenter(0.f);
+	float meshArea = 0.f;
+	std::vector<glm::vec3> triCenters(triangleCnt);
+	std::vector<glm::vec3> triNormals(triangleCnt); // 长度为面积的两倍
+	for (size_t tri = 0; tri < triangleCnt; tri++) {
+		const glm::vec3& p0 = vertexes[indices[tri * 3 + 0]].a_position;
+		const glm::vec3& p1 = vertexes[indices[tri * 3 + 1]].a_position;
+		const glm::vec3& p2 = vertexes[indices[tri * 3 + 2]].a_position;
+		triCenters[tri] = (p0 + p1 + p2) / 3.f;
+		triNormals[tri] = glm::cross(p1 - p0, p2 - p0);
+		float area = glm::length(triNormals[tri]);
+		meshCenter += triCenters[tri] * area;
+		meshArea += area;
+	}
+	if (meshArea > 0.f) {
+		meshCenter /= meshArea;
+	}
+
+	// 簇的朝外程度：簇中心相对网格中心的偏移在簇平均法线上的投影，越大越可能遮挡其他簇
+	struct Cluster {
+		size_t start;
+		size_t end;
+		float sortKey;
+	};
+	std::vector<Cluster> sorted;
+	sorted.reserve(boundaries.size());
+	for (size_t b = 0; b + 1 < boundaries.size(); b++) {
+		Cluster cluster{ boundaries[b], boundaries[b + 1], 0.f };
+		if (cluster.start == cluster.end) {
+			continue;
+		}
+		glm::vec3 center(0.f);
+		glm::vec3 normal(0.f);
+		float area = 0.f;
+		for (size_t tri = cluster.start; tri < cluster.end; tri++) {
+			float triArea = glm::length(triNormals[tri]);
+			center += triCenters[tri] * triArea;
+			normal += triNormals[tri];
+			area += triArea;
+		}
+		float normalLen = glm::length(normal);
+		if (area > 0.f && normalLen > 0.f) {
+			cluster.sortKey = glm::dot(center / area - meshCenter, normal / normalLen);
+		}
+		sorted.push_back(cluster);
+	}
+	std::stable_sort(sorted.begin(), sorted.end(), [](const Cluster& a, const Cluster& b) -> bool {
+		return a.sortKey > b.sortKey;
+	});
+
+	std::vector<int32_t> output;
+	output.reserve(indices.size());
+	for (auto& cluster : sorted) {
+		output.insert(output.end(), indices.begin() + cluster.start * 3, indices.begin() + cluster.end * 3);
+	}
+	indices = std::move(output);
+}
+
+void MeshOptimizer::optimizeVertexFetch(std::vector<Vertex>& vertexes, std::vector<int32_t>& indices) {
+	std::vector<int32_t> remap(vertexes.size(), -1);
+	std::vector<Vertex> ordered;
+	ordered.reserve(vertexes.size());
+	for (auto& idx : indices) {
+		if (remap[idx] < 0) {
+			remap[idx] = (int32_t)ordered.size();
+			ordered.push_back(vertexes[idx]);
+		}
+		idx = remap[idx];
+	}
+	// 没有被引用的顶点直接丢弃
+	vertexes = std::move(ordered);
+}
+
+float MeshOptimizer::analyzeVertexCache(const std::vector<int32_t>& indices, size_t vertexCnt, size_t cacheSize) {
+	if (indices.size() < 3) {
+		return 0.f;
+	}
+	VertexCacheFIFO cache(vertexCnt, cacheSize);
+	size_t misses = 0;
+	for (int32_t idx : indices) {
+		misses += cache.access(idx);
+	}
+	return (float)misses / (float)(indices.size() / 3);
+}
+
+float MeshOptimizer::analyzeOverdraw(const std::vector<Vertex>& vertexes, const std::vector<int32_t>& indices) {
+	if (indices.size() < 3) {
+		return 0.f;
+	}
+
+	glm::vec3 bboxMin(std::numeric_limits<float>::max());
+	glm::vec3 bboxMax(std::numeric_limits<float>::lowest());
+	for (auto& v : vertexes) {
+		bboxMin = glm::min(bboxMin, v.a_position);
+		bboxMax = glm::max(bboxMax, v.a_position);
+	}
+	glm::vec3 center = (bboxMin + bboxMax) * 0.5f;
+	float extent = std::max(glm::length(bboxMax - bboxMin) * 0.5f, 1e-6f);
+	float scale = (float)kOverdrawViewport * 0.5f / extent;
+
+	// 视线方向与上方向，right = cross(forward, up)，屏幕空间逆时针为正面
+	const glm::vec3 views[6][2] = {
+		{ { 1.f, 0.f, 0.f }, { 0.f, 1.f, 0.f } },
+		{ { -1.f, 0.f, 0.f }, { 0.f, 1.f, 0.f } },
+		{ { 0.f, 1.f, 0.f }, { 0.f, 0.f, 1.f } },
+		{ { 0.f, -1.f, 0.f }, { 0.f, 0.f, 1.f } },
+		{ { 0.f, 0.f, 1.f }, { 0.f, 1.f, 0.f } },
+		{ { 0.f, 0.f, -1.f }, { 0.f, 1.f, 0.f } },
+	};
+
+	std::vector<float> depth(kOverdrawViewport * kOverdrawViewport);
+	std::vector<glm::vec3> projected(vertexes.size()); // 屏幕x, 屏幕y, 深度
+	size_t shaded = 0;
+	size_t covered = 0;
+	for (auto& view : views) {
+		glm::vec3 forward = view[0];
+		glm::vec3 up = view[1];
+		glm::vec3 right = glm::cross(forward, up);
+		for (size_t i = 0; i < vertexes.size(); i++) {
+			glm::vec3 p = vertexes[i].a_position - center;
+			projected[i] = { glm::dot(p, right) * scale + (float)kOverdrawViewport * 0.5f,
+			                 glm::dot(p, up) * scale + (float)kOverdrawViewport * 0.5f,
+			                 glm::dot(p, forward) };
+		}
+		std::fill(depth.begin(), depth.end(), std::numeric_limits<float>::max());
+
+		for (size_t tri = 0; tri < indices.size() / 3; tri++) {
+			const glm::vec3& v0 = projected[indices[tri * 3 + 0]];
+			const glm::vec3& v1 = projected[indices[tri * 3 + 1]];
+			const glm::vec3& v2 = projected[indices[tri * 3 + 2]];
+			float area = (v1.x - v0.x) * (v2.y - v0.y) - (v2.x - v0.x) * (v1.y - v0.y);
+			if (area <= 0.f) {
+				continue; // 背面或退化
+			}
+
+			int minX = std::max(0, (int)std::floor(std::min({ v0.x, v1.x, v2.x })));
+			int maxX = std::min(kOverdrawViewport - 1, (int)std::ceil(std::max({ v0.x, v1.x, v2.x })));
+			int minY = std::max(0, (int)std::floor(std::min({ v0.y, v1.y, v2.y })));
+			int maxY = std::min(kOverdrawViewport - 1, (int)std::ceil(std::max({ v0.y, v1.y, v2.y })));
+			for (int y = minY; y <= maxY; y++) {
+				float py = (float)y + 0.5f;
+				for (int x = minX; x <= maxX; x++) {
+					float px = (float)x + 0.5f;
+					float w0 = (v2.x - v1.x) * (py - v1.y) - (v2.y - v1.y) * (px - v1.x);
+					float w1 = (v0.x - v2.x) * (py - v2.y) - (v0.y - v2.y) * (px - v2.x);
+					float w2 = (v1.x - v0.x) * (py - v0.y) - (v1.y - v0.y) * (px - v0.x);
+					if (w0 < 0.f || w1 < 0.f || w2 < 0.f) {
+						continue;
+					}
+					float z = (w0 * v0.z + w1 * v1.z + w2 * v2.z) / area;
+					float& d = depth[y * kOverdrawViewport + x];
+					if (z < d) {
+						covered += d == std::numeric_limits<float>::max();
+						shaded++;
+						d = z;
+					}
+				}
+			}
+		}
+	}
+	return covered > 0 ? (float)shaded / (float)covered : 0.f;
+}
+
+}
@@ -0,0 +1,420 @@
+#include "Viewer/ModelCache.h"
+#include <cstring>
+#include <filesystem>
+#include <functional>
+#include <sstream>
+#include "json11/json11.hpp"
+#include "Base/FileUtils.h"
+#include "Base/hashUtils.h"
+#include "Base/Logger.h"
+#include "Base/MappedFile.h"
+#include "Base/StringUtils.h"
+
+namespace OpenGL {
+// 存储模型二进制缓存的路径
+const std::string MODEL_CACHE_DIR = "./cache/Model/";
+
+// Assimp导入参数、Vertex布局或缓存格式变化时递增，旧缓存随之失效
+constexpr uint32_t MODEL_CACHE_VERSION = 2;
+constexpr char MODEL_CACHE_MAGIC[4] = { 'S', 'G', 'M', 'C' };
+constexpr size_t MODEL_CACHE_KEY_LEN = 32; // MD5十六进制字符串长度
+
+/*
+ * 缓存文件布局（各段偏移记录在文件头中）：
+ * CacheHeader | CacheNode[] | CacheMesh[] | CacheTexture[] | 字符串表 | Vertex[]（按64字节对齐）| int32_t[]
+ * 节点按先序遍历展开，每个节点记录子节点数量；网格的索引相对于网格自身的顶点
+ */
+struct CacheHeader {
+	char magic[4];
+	uint32_t version;
+	uint32_t vertexSize;
+	uint32_t nodeCnt;
+	uint32_t meshCnt;
+	uint32_t textureCnt;
+	uint64_t fileSize;
+	uint64_t nodesOffset;
+	uint64_t meshesOffset;
+	uint64_t texturesOffset;
+	uint64_t stringsOffset;
+	uint64_t stringsSize;
+	uint64_t vertexesOffset;
+	uint64_t vertexCnt;
+	uint64_t indicesOffset;
+	uint64_t indexCnt;
+	uint64_t primitiveCnt;
+	float aabbMin[3];
+	float aabbMax[3];
+	char cacheKey[MODEL_CACHE_KEY_LEN];
+};
+
+struct CacheNode {
+	float transform[16];
+	uint32_t meshStart;
+	uint32_t meshCnt;
+	uint32_t childCnt;
+	uint32_t reserved;
+};
+
+struct CacheMesh {
+	uint64_t vertexStart;
+	uint64_t vertexCnt;
+	uint64_t indexStart;
+	uint64_t indexCnt;
+	float aabbMin[3];
+	float aabbMax[3];
+	int32_t shadingModel;
+	int32_t alphaMode;
+	int32_t doubleSided;
+	uint32_t textureStart;
+	uint32_t textureCnt;
+	uint32_t reserved;
+};
+
+struct CacheTexture {
+	int32_t texType;
+	int32_t wrapModeU;
+	int32_t wrapModeV;
+	uint32_t pathOffset; // 相对于模型目录的路径，位于字符串表中
+	uint32_t pathLength;
+	uint32_t reserved;
+};
+
+static size_t alignOffset(size_t offset, size_t alignment) {
+	return (offset + alignment - 1) / alignment * alignment;
+}
+
+// 检查[offset, offset + cnt * elemSize)是否在文件范围内
+static bool checkRange(uint64_t offset, uint64_t cnt, size_t elemSize, size_t fileSize) {
+	if (offset > fileSize) {
+		return false;
+	}
+	return cnt <= (fileSize - offset) / elemSize;
+}
+
+// 源文件引用的其他网格数据文件：glTF的外部buffer、obj的材质库
+static std::vector<std::string> getDependencyFiles(const std::string& filepath, const std::vector<uint8_t>& content) {
+	std::vector<std::string> ret;
+	std::string dir = filepath.substr(0, filepath.find_last_of('/') + 1);
+	std::string text((const char*)content.data(), content.size());
+	if (StringUtils::endsWith(filepath, ".gltf")) {
+		std::string err;
+		const auto json = json11::Json::parse(text, err);
+		for (auto& buffer : json["buffers"].array_items()) {
+			const std::string& uri = buffer["uri"].string_value();
+			if (!uri.empty() && !StringUtils::startsWith(uri, "data:")) {
+				ret.push_back(dir + uri);
+			}
+		}
+	}
+	else if (StringUtils::endsWith(filepath, ".obj")) {
+		std::istringstream stream(text);
+		std::string line;
+		while (std::getline(stream, line)) {
+			if (StringUtils::startsWith(line, "mtllib ")) {
+				std::string name = line.substr(7);
+				while (!name.empty() && (name.back() == '\r' || name.back() == ' ')) {
+					name.pop_back();
+				}
+				ret.push_back(dir + name);
+			}
+		}
+	}
+	return ret;
+}
+
+std::string ModelCache::getCacheKey(const std::string& filepath) {
+	auto content = FileUtils::readBytes(filepath);
+	if (content.empty()) {
+		return "";
+	}
+
+	std::string hashStr = HashUtils::getHashMD5((const char*)content.data(), content.size());
+	for (auto& path : getDependencyFiles(filepath, content)) {
+		auto depContent = FileUtils::readBytes(path);
+		hashStr += HashUtils::getHashMD5((const char*)depContent.data(), depContent.size());
+	}
+	return HashUtils::getHashMD5(hashStr);
+}
+
+std::string ModelCache::getCacheFilePath(const std::string& cacheKey) {
+	return MODEL_CACHE_DIR + cacheKey + ".mesh";
+}
+
+bool ModelCache::storeToCache(const std::string& cacheKey, const Model& model) {
+	if (cacheKey.size() != MODEL_CACHE_KEY_LEN) {
+		return false;
+	}
+
+	//--------------------------展开节点层级--------------------------
+	std::vector<CacheNode> nodes;
+	std::vector<CacheMesh> meshes;
+	std::vector<CacheTexture> textures;
+	std::vector<const ModelMesh*> meshPtrs;
+	std::string strings;
+	uint64_t vertexCnt = 0;
+	uint64_t indexCnt = 0;
+	const std::string texPathPrefix = model.resourcePath + "/";
+
+	std::function<bool(const ModelNode&)> flattenNode = [&](const ModelNode& node) -> bool {
+		CacheNode cacheNode{};
+		memcpy(cacheNode.transform, &node.transform[0][0], sizeof(cacheNode.transform));
+		cacheNode.meshStart = (uint32_t)meshes.size();
+		cacheNode.meshCnt = (uint32_t)node.meshes.size();
+		cacheNode.childCnt = (uint32_t)node.children.size();
+		nodes.push_back(cacheNode);
+
+		for (auto& mesh : node.meshes) {
+			CacheMesh cacheMesh{};
+			cacheMesh.vertexStart = vertexCnt;
+			cacheMesh.vertexCnt = mesh.vertexesBufferLength / sizeof(Vertex);
+			cacheMesh.indexStart = indexCnt;
+			cacheMesh.indexCnt = mesh.indexBufferLength / sizeof(int32_t);
+			memcpy(cacheMesh.aabbMin, &mesh.aabb.min[0], sizeof(cacheMesh.aabbMin));
+			memcpy(cacheMesh.aabbMax, &mesh.aabb.max[0], sizeof(cacheMesh.aabbMax));
+			cacheMesh.shadingModel = mesh.material->shadingModel;
+			cacheMesh.alphaMode = mesh.material->alphaMode;
+			cacheMesh.doubleSided = mesh.material->doubleSided ? 1 : 0;
+			cacheMesh.textureStart = (uint32_t)textures.size();
+			for (auto& kv : mesh.material->textureData) {
+				// 纹理路径均由模型目录拼接而成，缓存中只保存相对路径
+				if (!StringUtils::startsWith(kv.second.tag, texPathPrefix)) {
+					LOGW("store model cache failed: texture not in model directory: %s", kv.second.tag.c_str());
+					return false;
+				}
+				CacheTexture cacheTex{};
+				cacheTex.texType = kv.first;
+				cacheTex.wrapModeU = kv.second.wrapModeU;
+				cacheTex.wrapModeV = kv.second.wrapModeV;
+				cacheTex.pathOffset = (uint32_t)strings.size();
+				cacheTex.pathLength = (uint32_t)(kv.second.tag.size() - texPathPrefix.size());
+				strings += kv.second.tag.substr(texPathPrefix.size());
+				textures.push_back(cacheTex);
+			}
+			cacheMesh.textureCnt = (uint32_t)textures.size() - cacheMesh.textureStart;
+
+			vertexCnt += cacheMesh.vertexCnt;
+			indexCnt += cacheMesh.indexCnt;
+			meshes.push_back(cacheMesh);
+			meshPtrs.push_back(&mesh);
+		}
+
+		for (auto& child : node.children) {
+			if (!flattenNode(child)) {
+				return false;
+			}
+		}
+		return true;
+	};
+	if (!flattenNode(model.rootNode)) {
+		return false;
+	}
+
+	//--------------------------计算各段偏移--------------------------
+	CacheHeader header{};
+	memcpy(header.magic, MODEL_CACHE_MAGIC, sizeof(header.magic));
+	header.version = MODEL_CACHE_VERSION;
+	header.vertexSize = sizeof(Vertex);
+	header.nodeCnt = (uint32_t)nodes.size();
+	header.meshCnt = (uint32_t)meshes.size();
+	header.textureCnt = (uint32_t)textures.size();
+	header.nodesOffset = sizeof(CacheHeader);
+	header.meshesOffset = header.nodesOffset + nodes.size() * sizeof(CacheNode);
+	header.texturesOffset = header.meshesOffset + meshes.size() * sizeof(CacheMesh);
+	header.stringsOffset = header.texturesOffset + textures.size() * sizeof(CacheTexture);
+	header.stringsSize = strings.size();
+	header.vertexesOffset = alignOffset(header.stringsOffset + header.stringsSize, 64);
+	header.vertexCnt = vertexCnt;
+	header.indicesOffset = header.vertexesOffset + vertexCnt * sizeof(Vertex);
+	header.indexCnt = indexCnt;
+	header.fileSize = header.indicesOffset + indexCnt * sizeof(int32_t);
+	header.primitiveCnt = model.primitiveCnt;
+	memcpy(header.aabbMin, &model.rootAABB.min[0], sizeof(header.aabbMin));
+	memcpy(header.aabbMax, &model.rootAABB.max[0], sizeof(header.aabbMax));
+	memcpy(header.cacheKey, cacheKey.c_str(), MODEL_CACHE_KEY_LEN);
+
+	//--------------------------写入数据--------------------------
+	std::vector<uint8_t> fileData(header.fileSize, 0);
+	memcpy(fileData.data(), &header, sizeof(header));
+	if (!nodes.empty()) {
+		memcpy(&fileData[header.nodesOffset], nodes.data(), nodes.size() * sizeof(CacheNode));
+	}
+	if (!meshes.empty()) {
+		memcpy(&fileData[header.meshesOffset], meshes.data(), meshes.size() * sizeof(CacheMesh));
+	}
+	if (!textures.empty()) {
+		memcpy(&fileData[header.texturesOffset], textures.data(), textures.size() * sizeof(CacheTexture));
+	}
+	if (!strings.empty()) {
+		memcpy(&fileData[header.stringsOffset], strings.data(), strings.size());
+	}
+	for (size_t i = 0; i < meshes.size(); i++) {
+		const ModelMesh* mesh = meshPtrs[i];
+		if (mesh->vertexesBufferLength > 0) {
+			memcpy(&fileData[header.vertexesOffset + meshes[i].vertexStart * sizeof(Vertex)],
+				   mesh->vertexesBuffer, mesh->vertexesBufferLength);
+		}
+		if (mesh->indexBufferLength > 0) {
+			memcpy(&fileData[header.indicesOffset + meshes[i].indexStart * sizeof(int32_t)],
+				   mesh->indexBuffer, mesh->indexBufferLength);
+		}
+	}
+
+	// 先写入临时文件再重命名，避免其他进程读到写了一半的缓存
+	std::error_code ec;
+	std::filesystem::create_directories(MODEL_CACHE_DIR, ec);
+	auto cacheFilePath = getCacheFilePath(cacheKey);
+	auto tmpFilePath = cacheFilePath + ".tmp";
+	if (!FileUtils::writeBytes(tmpFilePath, (const char*)fileData.data(), fileData.size())) {
+		return false;
+	}
+	std::filesystem::rename(tmpFilePath, cacheFilePath, ec);
+	if (ec) {
+		LOGW("store model cache failed: %s", ec.message().c_str());
+		std::filesystem::remove(tmpFilePath, ec);
+		return false;
+	}
+	return true;
+}
+
+bool ModelCache::loadFromCache(const std::string& cacheKey, Model& model) {
+	auto cacheFilePath = getCacheFilePath(cacheKey);
+	if (cacheKey.size() != MODEL_CACHE_KEY_LEN || !FileUtils::exists(cacheFilePath)) {
+		return false;
+	}
+
+	auto file = std::make_shared<MappedFile>();
+	if (!file->open(cacheFilePath)) {
+		return false;
+	}
+	const uint8_t* data = file->data();
+	const size_t fileSize = file->size();
+
+	//--------------------------校验文件头与各段范围--------------------------
+	CacheHeader header{};
+	if (fileSize < sizeof(CacheHeader)) {
+		LOGW("invalid model cache: %s", cacheFilePath.c_str());
+		return false;
+	}
+	memcpy(&header, data, sizeof(CacheHeader));
+	if (0 != memcmp(header.magic, MODEL_CACHE_MAGIC, sizeof(header.magic))
+		|| header.version != MODEL_CACHE_VERSION
+		|| header.vertexSize != sizeof(Vertex)
+		|| header.fileSize != fileSize
+		|| 0 != memcmp(header.cacheKey, cacheKey.c_str(), MODEL_CACHE_KEY_LEN)) {
+		LOGW("model cache outdated or corrupted: %s", cacheFilePath.c_str());
+		return false;
+	}
+	if (header.nodeCnt == 0
+		|| header.nodesOffset % 8 != 0 || header.meshesOffset % 8 != 0 || header.texturesOffset % 8 != 0
+		|| header.vertexesOffset % alignof(Vertex) != 0 || header.indicesOffset % sizeof(int32_t) != 0
+		|| !checkRange(header.nodesOffset, header.nodeCnt, sizeof(CacheNode), fileSize)
+		|| !checkRange(header.meshesOffset, header.meshCnt, sizeof(CacheMesh), fileSize)
+		|| !checkRange(header.texturesOffset, header.textureCnt, sizeof(CacheTexture), fileSize)
+		|| !checkRange(header.stringsOffset, header.stringsSize, 1, fileSize)
+		|| !checkRange(header.vertexesOffset, header.vertexCnt, sizeof(Vertex), fileSize)
+		|| !checkRange(header.indicesOffset, header.indexCnt, sizeof(int32_t), fileSize)) {
+		LOGW("model cache corrupted: %s", cacheFilePath.c_str());
+		return false;
+	}
+
+	const auto* nodes = (const CacheNode*)(data + header.nodesOffset);
+	const auto* meshes = (const CacheMesh*)(data + header.meshesOffset);
+	const auto* textures = (const CacheTexture*)(data + header.texturesOffset);
+	const auto* strings = (const char*)(data + header.stringsOffset);
+	const auto* vertexes = (const Vertex*)(data + header.vertexesOffset);
+	const auto* indices = (const int32_t*)(data + header.indicesOffset);
+
+	// 校验网格数据，索引越界会导致渲染时访问非法内存
+	for (uint32_t i = 0; i < header.meshCnt; i++) {
+		const CacheMesh& mesh = meshes[i];
+		if (mesh.vertexStart > header.vertexCnt || mesh.vertexCnt > header.vertexCnt - mesh.vertexStart
+			|| mesh.indexStart > header.indexCnt || mesh.indexCnt > header.indexCnt - mesh.indexStart
+			|| mesh.indexCnt % 3 != 0
+			|| mesh.textureStart > header.textureCnt || mesh.textureCnt > header.textureCnt - mesh.textureStart) {
+			LOGW("model cache corrupted: %s", cacheFilePath.c_str());
+			return false;
+		}
+		for (uint64_t j = 0; j < mesh.indexCnt; j++) {
+			int32_t index = indices[mesh.indexStart + j];
+			if (index < 0 || (uint64_t)index >= mesh.vertexCnt) {
+				LOGW("model cache corrupted: %s", cacheFilePath.c_str());
+				return false;
+			}
+		}
+		for (uint32_t j = 0; j < mesh.textureCnt; j++) {
+			const CacheTexture& tex = textures[mesh.textureStart + j];
+			if (tex.texType <= MaterialTexType_NONE || tex.texType >= MaterialTexType_CUBE
+				|| tex.wrapModeU < Wrap_REPEAT || tex.wrapModeU > Wrap_CLAMP_TO_BORDER
+				|| tex.wrapModeV < Wrap_REPEAT || tex.wrapModeV > Wrap_CLAMP_TO_BORDER
+				|| tex.pathOffset > header.stringsSize || tex.pathLength > header.stringsSize - tex.pathOffset) {
+				LOGW("model cache corrupted: %s", cacheFilePath.c_str());
+				return false;
+			}
+		}
+	}
+
+	//--------------------------重建节点层级--------------------------
+	Model cached;
+	cached.resourcePath = model.resourcePath;
+	uint32_t nodeIdx = 0;
+	std::function<bool(ModelNode&)> buildNode = [&](ModelNode& outNode) -> bool {
+		const CacheNode& cacheNode = nodes[nodeIdx++];
+		if (cacheNode.meshStart > header.meshCnt || cacheNode.meshCnt > header.meshCnt - cacheNode.meshStart
+			|| cacheNode.childCnt > header.nodeCnt - nodeIdx) {
+			return false;
+		}
+		memcpy(&outNode.transform[0][0], cacheNode.transform, sizeof(cacheNode.transform));
+
+		outNode.meshes.resize(cacheNode.meshCnt);
+		for (uint32_t i = 0; i < cacheNode.meshCnt; i++) {
+			const CacheMesh& cacheMesh = meshes[cacheNode.meshStart + i];
+			ModelMesh& mesh = outNode.meshes[i];
+			mesh.primitiveType = Primitive_TRIANGLE;
+			mesh.primitiveCnt = cacheMesh.indexCnt / 3;
+			mesh.aabb = BoundingBox(glm::vec3(cacheMesh.aabbMin[0], cacheMesh.aabbMin[1], cacheMesh.aabbMin[2]),
+									glm::vec3(cacheMesh.aabbMax[0], cacheMesh.aabbMax[1], cacheMesh.aabbMax[2]));
+
+			mesh.material = std::make_shared<Material>();
+			mesh.material->shadingModel = (ShadingModel)cacheMesh.shadingModel;
+			mesh.material->alphaMode = (AlphaMode)cacheMesh.alphaMode;
+			mesh.material->doubleSided = cacheMesh.doubleSided != 0;
+			for (uint32_t j = 0; j < cacheMesh.textureCnt; j++) {
+				const CacheTexture& cacheTex = textures[cacheMesh.textureStart + j];
+				auto& texData = mesh.material->textureData[cacheTex.texType];
+				texData.tag = model.resourcePath + "/" + std::string(strings + cacheTex.pathOffset, cacheTex.pathLength);
+				texData.wrapModeU = (WrapMode)cacheTex.wrapModeU;
+				texData.wrapModeV = (WrapMode)cacheTex.wrapModeV;
+			}
+
+			// 顶点属性描述与InitVertexes一致，缓冲区指向只读的映射数据
+			mesh.InitVertexes();
+			mesh.vertexesBuffer = (uint8_t*)(vertexes + cacheMesh.vertexStart);
+			mesh.vertexesBufferLength = cacheMesh.vertexCnt * sizeof(Vertex);
+			mesh.indexBuffer = (int32_t*)(indices + cacheMesh.indexStart);
+			mesh.indexBufferLength = cacheMesh.indexCnt * sizeof(int32_t);
+		}
+
+		outNode.children.resize(cacheNode.childCnt);
+		for (auto& child : outNode.children) {
+			if (!buildNode(child)) {
+				return false;
+			}
+		}
+		return true;
+	};
+	if (!buildNode(cached.rootNode) || nodeIdx != header.nodeCnt) {
+		LOGW("model cache corrupted: %s", cacheFilePath.c_str());
+		return false;
+	}
+
+	cached.meshCnt = header.meshCnt;
+	cached.primitiveCnt = header.primitiveCnt;
+	cached.vertexCnt = header.vertexCnt;
+	cached.rootAABB = BoundingBox(glm::vec3(header.aabbMin[0], header.aabbMin[1], header.aabbMin[2]),
+								  glm::vec3(header.aabbMax[0], header.aabbMax[1], header.aabbMax[2]));
+	cached.cacheData = std::move(file);
+	model = std::move(cached);
+	return true;
+}
+
+}
@@ -1,12 +1,12 @@
 #include "Viewer/ModelLoader.h"
+#include "Viewer/ModelCache.h"
+#include "Viewer/MeshOptimizer.h"
 #include "Base/Logger.h"
 #include "Base/ImageUtils.h"
 #include "Base/ThreadPool.h"
 #include "Viewer/Material.h"
-#include "Viewer/Cube.h"
 #include "Base/StringUtils.h"
 #include <glm/glm/gtc/matrix_transform.hpp>
-#include <set>
 #include <assimp/Importer.hpp>
 #include <assimp/postprocess.h>
 #include <assimp/GltfMaterial.h>
@@ -19,24 +19,6 @@ ModelLoader::ModelLoader(Config& config) : config_(config) {
 	loadFloor();
 }
 
-void ModelLoader::loadCubeMesh(ModelVertexes& mesh) {
-	const float* cubeVertexes = Cube::getCubeVertexes();
-
-	mesh.primitiveType = Primitive_TRIANGLE;
-	mesh.primitiveCnt = 12;
-	for (int i = 0; i < 12; i++) {
-		for (int j = 0; j < 3; j++) {
-			Vertex vertex{};
-			vertex.a_position.x = cubeVertexes[i * 9 + j * 3 + 0];
-			vertex.a_position.y = cubeVertexes[i * 9 + j * 3 + 1];
-			vertex.a_position.z = cubeVertexes[i * 9 + j * 3 + 2];
-			mesh.vertexes.push_back(vertex);
-			mesh.indices.push_back(i * 3 + j);
-		}
-	}
-	mesh.InitVertexes();
-}
-
 void ModelLoader::loadWorldAxis() {
 	// 网格平面高度（略低于地面）
 	float axisY = -0.01f;
@@ -199,6 +181,15 @@ bool ModelLoader::loadModel(const std::string& filepath) {
 	modelCache_[filepath] = std::make_shared<Model>();
 	scene_.model = modelCache_[filepath];
 	LOGD("开始加载模型: %s", filepath.c_str());
+	// 提取文件目录
+	scene_.model->resourcePath = filepath.substr(0, filepath.find_last_of('/'));
+	//-------------------------二进制缓存读取--------------------------------
+	std::string cacheKey = ModelCache::getCacheKey(filepath);
+	if (!cacheKey.empty() && loadModelFromCache(cacheKey)) {
+		LOGD("从缓存加载模型: %s", filepath.c_str());
+		scene_.model->centeredTransform = adjustModelCenter(scene_.model->rootAABB);
+		return true;
+	}
 	//-------------------------Assimp模型读取--------------------------------
 	Assimp::Importer importer;
 	// 设置模型处理标志（重要！）
@@ -216,22 +207,80 @@ bool ModelLoader::loadModel(const std::string& filepath) {
 		LOGE("模型加载失败: %s", importer.GetErrorString());
 		return false;
 	}
-		
-	// 提取文件目录
-	scene_.model->resourcePath = filepath.substr(0, filepath.find_last_of('/'));
 	//-------------------------纹理预加载--避免重复加载-----------------------------------
 	preloadTextureFiles(scene, scene_.model->resourcePath);
 	//------------------------节点层级处理-----------------------------------
+	importStats_ = {};
 	glm::mat4 currTransform = glm::mat4(1.0f);  // 初始化为单位矩阵
 	if (!processNode(scene->mRootNode, scene, scene_.model->rootNode, currTransform)) {
 		LOGE("节点处理失败");
 		return false;
 	}
+	if (importStats_.triangleCnt > 0) {
+		float triangleCnt = (float)importStats_.triangleCnt;
+		LOGD("网格优化: 顶点 %zu -> %zu, ACMR %.3f -> %.3f",
+			 importStats_.vertexCntBefore, importStats_.vertexCntAfter,
+			 importStats_.acmrBefore / triangleCnt, importStats_.acmrAfter / triangleCnt);
+		if (config_.meshOverdrawStats) {
+			LOGD("网格优化: overdraw %.3f -> %.3f",
+				 importStats_.overdrawBefore / triangleCnt, importStats_.overdrawAfter / triangleCnt);
+		}
+	}
 
 	//----------------------模块中心化处理--------------------------
 	scene_.model->centeredTransform = adjustModelCenter(scene_.model->rootAABB);
+
+	//----------------------写入二进制缓存，下次加载跳过Assimp--------------------------
+	if (!cacheKey.empty()) {
+		ModelCache::storeToCache(cacheKey, *scene_.model);
+	}
 	return true;
+}
 
+bool ModelLoader::loadModelFromCache(const std::string& cacheKey) {
+	if (!ModelCache::loadFromCache(cacheKey, *scene_.model)) {
+		return false;
+	}
+
+	// 收集所有网格
+	std::vector<ModelMesh*> meshes;
+	std::function<void(ModelNode&)> collectMeshes = [&](ModelNode& node) {
+		for (auto& mesh : node.meshes) {
+			meshes.push_back(&mesh);
+		}
+		for (auto& child : node.children) {
+			collectMeshes(child);
+		}
+	};
+	collectMeshes(scene_.model->rootNode);
+
+	// 并发加载所有纹理，再填充到各网格的材质中
+	std::set<std::string> texPaths;
+	for (auto* mesh : meshes) {
+		for (auto& kv : mesh->material->textureData) {
+			texPaths.insert(kv.second.tag);
+		}
+	}
+	preloadTextureFiles(texPaths);
+
+	for (auto* mesh : meshes) {
+		auto& textureData = mesh->material->textureData;
+		for (auto it = textureData.begin(); it != textureData.end();) {
+			auto& texData = it->second;
+			std::shared_ptr<Buffer<RGBA>> buffer = loadTextureFile(texData.tag);
+			if (buffer) {
+				texData.width = buffer->getWidth();
+				texData.height = buffer->getHeight();
+				texData.data = { buffer };
+				++it;
+			}
+			else {
+				LOGE("load texture failed: %s, path: %s", Material::materialTexTypeStr((MaterialTexType)it->first), texData.tag.c_str());
+				it = textureData.erase(it);
+			}
+		}
+	}
+	return true;
 }
 
 bool ModelLoader::processNode(const aiNode* ai_node,
@@ -275,7 +324,9 @@ bool ModelLoader::processNode(const aiNode* ai_node,
 
 bool ModelLoader::processMesh(const aiMesh* ai_mesh, const aiScene* ai_scene, ModelMesh& outMesh) {
 	std::vector<Vertex> vertexes;
-	std::vector<int> indices;
+	std::vector<int32_t> indices;
+	vertexes.reserve(ai_mesh->mNumVertices);
+	indices.reserve(ai_mesh->mNumFaces * 3);
 	// ----------------------------顶点数据处理-----------------------------
 	for (size_t i = 0; i < ai_mesh->mNumVertices; i++) {
 		Vertex vertex;
@@ -317,10 +368,22 @@ bool ModelLoader::processMesh(const aiMesh* ai_mesh, const aiScene* ai_scene, Mo
 			return false;
 		}
 		for (size_t j = 0; j < face.mNumIndices; j++) {
-			indices.push_back((int)(face.mIndices[j]));
+			indices.push_back((int32_t)(face.mIndices[j]));
 		}
 	}
 
+	//------------------------------网格优化---------------------------------------
+	// Assimp按文件中的顺序输出顶点和索引：焊接重复顶点，再重排三角形与顶点
+	MeshOptimizeStats stats;
+	MeshOptimizer::optimize(vertexes, indices, &stats, config_.meshOverdrawStats);
+	importStats_.triangleCnt += stats.triangleCnt;
+	importStats_.vertexCntBefore += stats.vertexCntBefore;
+	importStats_.vertexCntAfter += stats.vertexCntAfter;
+	importStats_.acmrBefore += stats.acmrBefore * (float)stats.triangleCnt;
+	importStats_.acmrAfter += stats.acmrAfter * (float)stats.triangleCnt;
+	importStats_.overdrawBefore += stats.overdrawBefore * (float)stats.triangleCnt;
+	importStats_.overdrawAfter += stats.overdrawAfter * (float)stats.triangleCnt;
+
 	//--------------------------------材质初始化---------------------------------------
 	outMesh.material = std::make_shared<Material>();
 	outMesh.material->baseColor = glm::vec4(1.f);
@@ -463,6 +526,10 @@ void ModelLoader::preloadTextureFiles(const aiScene* scene, const std::string& r
 		}
 	}
 
+	preloadTextureFiles(texPaths);
+}
+
+void ModelLoader::preloadTextureFiles(const std::set<std::string>& texPaths) {
 	if (texPaths.empty()) {
 		return;
 	}
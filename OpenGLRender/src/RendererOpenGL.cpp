@@ -4,11 +4,9 @@
 #include "Render/OpenGL/UniformOpenGL.h"
 #include "Render/PipelineStates.h"
 #include "Render/OpenGL/OpenGLUtils.h"
+#include "Render/OpenGL/StateCacheOpenGL.h"
 #include <memory>
 
-//根据布尔变量值自动启用或禁用对应的 OpenGL 功能状态
-#define GL_STATE_SET(var, gl_state) if (var) GL_CHECK(glEnable(gl_state)); else GL_CHECK(glDisable(gl_state));
-
 
 namespace OpenGL {
 
@@ -52,12 +50,15 @@ namespace OpenGL {
 
     // pipeline
     void RendererOpenGL::beginRenderPass(std::shared_ptr<FrameBuffer>& frameBuffer, const ClearStates& states) {
+        // 渲染通道之间可能有后端之外的GL调用（ImGui、窗口绘制），状态缓存从这里重新开始
+        StateCacheOpenGL::get().invalidate();
+
         auto* fbo = dynamic_cast<FrameBufferOpenGL*>(frameBuffer.get());
         fbo->bind();//绑定fboShadow_中fbo_。
 
         GLbitfield clearBit = 0;
         if (states.colorFlag) {
-            GL_CHECK(glClearColor(states.clearColor.r, states.clearColor.g, states.clearColor.b, states.clearColor.a));
+            StateCacheOpenGL::get().clearColor(states.clearColor);
             clearBit |= GL_COLOR_BUFFER_BIT;
         }
         if (states.depthFlag) {
@@ -67,7 +68,7 @@ namespace OpenGL {
     }
 
     void RendererOpenGL::setViewPort(int x, int y, int width, int height) {
-        GL_CHECK(glViewport(x, y, width, height));
+        StateCacheOpenGL::get().viewport(x, y, width, height);
     }
 
     void RendererOpenGL::setVertexArrayObject(std::shared_ptr<VertexArrayObject>& vao) {
@@ -102,25 +103,26 @@ namespace OpenGL {
         pipelineStates_ = states.get();
 
         auto& renderStates = states->renderStates;
+        auto& cache = StateCacheOpenGL::get();
         // blend
-        GL_STATE_SET(renderStates.blend, GL_BLEND)
-            GL_CHECK(glBlendEquationSeparate(OpenGL::cvtBlendFunction(renderStates.blendParams.blendFuncRgb),
-                OpenGL::cvtBlendFunction(renderStates.blendParams.blendFuncAlpha)));
-        GL_CHECK(glBlendFuncSeparate(OpenGL::cvtBlendFactor(renderStates.blendParams.blendSrcRgb),
+        cache.enable(GL_BLEND, renderStates.blend);
+        cache.blendEquationSeparate(OpenGL::cvtBlendFunction(renderStates.blendParams.blendFuncRgb),
+            OpenGL::cvtBlendFunction(renderStates.blendParams.blendFuncAlpha));
+        cache.blendFuncSeparate(OpenGL::cvtBlendFactor(renderStates.blendParams.blendSrcRgb),
             OpenGL::cvtBlendFactor(renderStates.blendParams.blendDstRgb),
             OpenGL::cvtBlendFactor(renderStates.blendParams.blendSrcAlpha),
-            OpenGL::cvtBlendFactor(renderStates.blendParams.blendDstAlpha)));
+            OpenGL::cvtBlendFactor(renderStates.blendParams.blendDstAlpha));
 
         // depth
-        GL_STATE_SET(renderStates.depthTest, GL_DEPTH_TEST)
-            GL_CHECK(glDepthMask(renderStates.depthMask));
-        GL_CHECK(glDepthFunc(OpenGL::cvtDepthFunc(renderStates.depthFunc)));
+        cache.enable(GL_DEPTH_TEST, renderStates.depthTest);
+        cache.depthMask(renderStates.depthMask);
+        cache.depthFunc(OpenGL::cvtDepthFunc(renderStates.depthFunc));
 
-        GL_STATE_SET(renderStates.cullFace, GL_CULL_FACE)
-            GL_CHECK(glPolygonMode(GL_FRONT_AND_BACK, OpenGL::cvtPolygonMode(renderStates.polygonMode)));
+        cache.enable(GL_CULL_FACE, renderStates.cullFace);
+        cache.polygonMode(OpenGL::cvtPolygonMode(renderStates.polygonMode));
 
-        GL_CHECK(glLineWidth(renderStates.lineWidth));
-        GL_CHECK(glEnable(GL_PROGRAM_POINT_SIZE));
+        cache.lineWidth(renderStates.lineWidth);
+        cache.enable(GL_PROGRAM_POINT_SIZE, true);
     }
 
     void RendererOpenGL::draw() {
@@ -130,16 +132,25 @@ namespace OpenGL {
 
     void RendererOpenGL::endRenderPass() {
         // reset gl states
-        GL_CHECK(glDisable(GL_BLEND));
-        GL_CHECK(glDisable(GL_DEPTH_TEST));
-        GL_CHECK(glDepthMask(true));
-        GL_CHECK(glDisable(GL_CULL_FACE));
-        GL_CHECK(glPolygonMode(GL_FRONT_AND_BACK, GL_FILL));
+        auto& cache = StateCacheOpenGL::get();
+        cache.enable(GL_BLEND, false);
+        cache.enable(GL_DEPTH_TEST, false);
+        cache.depthMask(true);
+        cache.enable(GL_CULL_FACE, false);
+        cache.polygonMode(GL_FILL);
     }
 
     void RendererOpenGL::waitIdle() {
         GL_CHECK(glFinish());
     }
 
+    const StateCacheStats& RendererOpenGL::getGlobalStateCacheStats() {
+        return StateCacheOpenGL::get().getStats();
+    }
+
+    void RendererOpenGL::resetGlobalStateCacheStats() {
+        StateCacheOpenGL::get().resetStats();
+    }
+
 
 }
\ No newline at end of file
@@ -1,6 +1,6 @@
 #include "Render/Software/RendererSoft.h"
 #include "Base/SIMD.h"
-#include "Base/HashUtils.h"
+#include "Base/hashUtils.h"
 #include "Render/Software/FramebufferSoft.h"
 #include "Render/Software/TextureSoft.h"
 #include "Render/Software/UniformSoft.h"
@@ -65,26 +65,23 @@ void RendererSoft::beginRenderPass(std::shared_ptr<FrameBuffer>& frameBuffer, co
 
     //清理颜色缓冲
     if (states.colorFlag && fboColor_) {
+        fboColor_->setSampleCompression(sampleCompression_);
         RGBA color = RGBA(states.clearColor.r * 255,
                           states.clearColor.g * 255,
                           states.clearColor.b * 255,
                           states.clearColor.a * 255);
-        if (fboColor_->multiSample) {
-            fboColor_->bufferMs4x->setAll(glm::tvec4<RGBA>(color));
-        }
-        else {
-            fboColor_->buffer->setAll(color);
-        }
+        clearImageBuffer(*fboColor_, color);
     }
 
     //清理深度缓冲
+    depthPyramid_.attach(fboDepth_.get(), rasterBlockSize_);
     if (states.depthFlag && fboDepth_) {
-        if (fboDepth_->multiSample) {
-            fboDepth_->bufferMs4x->setAll(glm::tvec4<float>(states.clearDepth));
-        }
-        else {
-            fboDepth_->buffer->setAll(states.clearDepth);
-        }
+        clearImageBuffer(*fboDepth_, states.clearDepth);
+        depthPyramid_.reset(states.clearDepth);
+    }
+    else {
+        // 渲染通道之间深度缓冲可能被其他渲染器修改
+        depthPyramid_.invalidate();
     }
 }
 
@@ -124,6 +121,7 @@ void RendererSoft::setVertexArrayObject(std::shared_ptr<VertexArrayObject>& vao)
 
 void RendererSoft::setShaderProgram(std::shared_ptr<ShaderProgram>& program) {
     shaderProgram_ = dynamic_cast<ShaderProgramSoft*>(program.get());
+    shaderProgramRef_ = program;
 }
 
 void RendererSoft::setShaderResources(std::shared_ptr<ShaderResources>& resources) {
@@ -151,6 +149,7 @@ void RendererSoft::draw() {
 
     if (fboColor_) {// 优先使用颜色缓冲的采样数
         rasterSamples_ = fboColor_->sampleCnt;
+        fboColor_->setSampleCompression(sampleCompression_);
     }
     else if (fboDepth_) {
         rasterSamples_ = fboDepth_->sampleCnt;
@@ -159,6 +158,14 @@ void RendererSoft::draw() {
         rasterSamples_ = 1;
     }
 
+    // 分层深度剔除与early z一样只是提前执行深度测试，片元着色器不会修改深度，结果与逐像素测试一致
+    depthPyramid_.attach(fboDepth_.get(), rasterBlockSize_);
+    depthCulling_ = earlyZ_ && renderState_->depthTest && fboDepth_ != nullptr;
+    rasterPixelQuad_ = selectRasterKernel();
+    simd_ = &SIMDDispatch::kernels();
+    prepareClearTiles();
+
+    initThreadContexts();
     processVertexShader();
     processPrimitiveAssembly();
     processClipping();
@@ -172,37 +179,124 @@ void RendererSoft::draw() {
     }
 }
 
-void RendererSoft::endRenderPass() {}
+// 单采样附件在渲染通道结束后可能作为纹理被读取，填充剩余待清除的tile。
+// 多重采样附件只在渲染器内部访问，保持延迟清除状态，解析时直接使用清除值
+void RendererSoft::endRenderPass() {
+    if (fboColor_ && !fboColor_->multiSample) {
+        fboColor_->materializeAll(true);
+    }
+    if (fboDepth_ && !fboDepth_->multiSample) {
+        fboDepth_->materializeAll(true);
+    }
+}
+
+template<typename T>
+void RendererSoft::clearImageBuffer(ImageBufferSoft<T>& image, const T& value) {
+    if (fastClear_) {
+        image.clearTiles(value, rasterBlockSize_);
+        return;
+    }
+    image.materializeAll(false);
+    if (image.multiSample) {
+        image.bufferMs->setAll(value);
+        image.setAllSampleUniform();
+    }
+    else {
+        image.buffer->setAll(value);
+    }
+}
+
+/*光栅化写入前的准备：所有图元都按tile光栅化，在prepareTile中逐tile填充待清除区域，
+  tile大小与清除时不一致时在draw开始时全部填充*/
+void RendererSoft::prepareClearTiles() {
+    if (fboColor_ && fboColor_->hasClearTiles() && fboColor_->getClearTileSize() != rasterBlockSize_) {
+        fboColor_->materializeAll(false);
+    }
+    if (fboDepth_ && fboDepth_->hasClearTiles() && fboDepth_->getClearTileSize() != rasterBlockSize_) {
+        fboDepth_->materializeAll(false);
+    }
+}
 
 void RendererSoft::waitIdle() {}
 
-/*初始化顶点着色器（varyings）存储空间,遍历所有顶点数据，执行顶点着色器程序*/
+/*初始化顶点着色器（varyings）存储空间，将顶点分块交给线程池，每个线程用自己的着色器副本批量执行顶点着色器*/
 void RendererSoft::processVertexShader() {
     //初始化varyings缓冲区
     varyingsCnt_ = shaderProgram_->getShaderVaryingsSize() / sizeof(float);
     varyingsAlignedSize_ = MemoryUtils::alignedSize(varyingsCnt_ * sizeof(float)); 
     varyingsAlignedCnt_ = varyingsAlignedSize_ / sizeof(float);
 
-    // 为所有顶点的输出分配空间
-    varyings_ = MemoryUtils::makeAlignedBuffer<float>(vao_->vertexCnt * varyingsAlignedCnt_); 
-    float* varyingBuffer = varyings_.get();
+    // 只为索引引用到的顶点（变换后顶点缓存的槽位）分配输出空间，缓冲区只增不减，避免每次draw重新分配
+    size_t vertexCnt = vao_->slotVertexes.size();
+    vertexCacheStats_.hits += vao_->cacheStats.hits;
+    vertexCacheStats_.misses += vao_->cacheStats.misses;
+    if (vertexCnt * varyingsAlignedCnt_ > varyingsCapacity_) {
+        varyingsCapacity_ = vertexCnt * varyingsAlignedCnt_;
+        varyings_ = MemoryUtils::makeAlignedBuffer<float>(varyingsCapacity_);
+    }
+    vertexes_.resize(vertexCnt);
 
-    // 准备顶点数据输入
-    uint8_t* vertexPtr = vao_->vertexes.data();
-    vertexes_.resize(vao_->vertexCnt);
+    // 顶点较少时直接在当前线程处理
+    size_t threadCnt = threadPool_.getThreadCnt();
+    if (vertexCnt <= vertexBatchSize_ || threadCnt <= 1) {
+        processVertexShaderBatch(shaderProgram_, 0, vertexCnt);
+        return;
+    }
 
-    // 逐顶点处理
-    for (int idx = 0; idx < vao_->vertexCnt; idx++) {
+    // 每个线程大约分到4个任务，便于负载均衡
+    size_t batchSize = std::max(vertexBatchSize_, (vertexCnt + threadCnt * 4 - 1) / (threadCnt * 4));
+    for (size_t start = 0; start < vertexCnt; start += batchSize) {
+        size_t end = std::min(start + batchSize, vertexCnt);
+        threadPool_.pushTask([&, start, end](int thread_id) {
+            processVertexShaderBatch(threadQuadCtx_[thread_id].shaderProgram.get(), start, end);
+            });
+    }
+    threadPool_.waitTasksFinish();
+}
+
+// 对[start, end)范围内的槽位执行顶点着色器
+void RendererSoft::processVertexShaderBatch(ShaderProgramSoft* program, size_t start, size_t end) {
+    if (start >= end) {
+        return;
+    }
+
+    float* varyingBuffer = varyings_.get();
+    const int32_t* slotVertexes = vao_->slotVertexes.data();
+    for (size_t idx = start; idx < end; idx++) {
         VertexHolder& holder = vertexes_[idx];
         holder.discard = false;
         holder.index = idx;
-        holder.vertex = vertexPtr;
+        holder.vertex = vao_->vertexes.data() + slotVertexes[idx] * vao_->vertexStride;
         holder.varyings = (varyingsAlignedSize_ > 0) ? (varyingBuffer + idx * varyingsAlignedCnt_) : nullptr;
-        vertexShaderImpl(holder);
-        vertexPtr += vao_->vertexStride;
+    }
+
+    ShaderBatch batch;
+    batch.attributes = vao_->vertexes.data();
+    batch.attributesStride = vao_->vertexStride;
+    if (vao_->slotIdentity) {
+        batch.attributes += start * vao_->vertexStride;
+    }
+    else {
+        batch.indices = slotVertexes + start;
+    }
+    batch.varyings = (uint8_t*)vertexes_[start].varyings;
+    batch.varyingsStride = varyingsAlignedSize_;
+    batch.positions = (uint8_t*)&vertexes_[start].clipPos;
+    batch.positionsStride = sizeof(VertexHolder);
+    batch.count = end - start;
+    program->execVertexShaderBatch(batch);
+
+    for (size_t idx = start; idx < end; idx++) {
+        VertexHolder& holder = vertexes_[idx];
+        holder.clipMask = countFrustumClipMask(holder.clipPos);
+    }
+
+    // 与逐顶点执行保持一致：使用最后一个顶点输出的点大小
+    if (end == vertexes_.size()) {
+        pointSize_ = batch.pointSize;
     }
 }
-    
+
 // 根据图元类型进行图元装配处理，存储在primitives_
 void RendererSoft::processPrimitiveAssembly() {
     switch (primitiveType_) {
@@ -220,6 +314,10 @@ void RendererSoft::processPrimitiveAssembly() {
 
 // 根据图元类型（点/线/三角形）分发到对应的裁剪函数，
 void RendererSoft::processClipping() {
+    // 上一次draw裁剪产生的顶点已被processVertexShader截断，这里回收它们的varyings
+    clipVaryings_.Reset();
+    clipAppendPrimitives_.clear();
+
     size_t primitiveCnt = primitives_.size();
     for (int i = 0; i < primitiveCnt; i++) {
         auto& primitive = primitives_[i];
@@ -238,12 +336,11 @@ void RendererSoft::processClipping() {
             if (renderState_->polygonMode != PolygonMode_FILL) {
                 continue;
             }
-            std::vector<PrimitiveHolder> appendPrimitives;
-            clippingTriangle(primitive, appendPrimitives);// 执行三角形裁剪（可能向appendPrimitives添加新图元）
-            primitives_.insert(primitives_.end(), appendPrimitives.begin(), appendPrimitives.end());
+            clippingTriangle(primitive, clipAppendPrimitives_);// 执行三角形裁剪（可能向clipAppendPrimitives_添加新图元）
             break;
         }
     }
+    primitives_.insert(primitives_.end(), clipAppendPrimitives_.begin(), clipAppendPrimitives_.end());
 
     // 先标记所有顶点为丢弃状态（后续只启用可见顶点），因为在裁剪过程中可能添加了新的顶点
     for (auto& vertex : vertexes_) {
@@ -320,47 +417,24 @@ void RendererSoft::processFaceCulling() {
 
 // 多类型图元光栅化分发处理
 void RendererSoft::processRasterization() {
+    // 点、线只输出颜色，不写深度，没有颜色缓冲时无需分箱和派发任务（如线框模式的阴影pass）
+    bool fillTriangles = primitiveType_ == Primitive_TRIANGLE && renderState_->polygonMode == PolygonMode_FILL;
+    if (!fboColor_ && !fillTriangles) {
+        return;
+    }
+
     switch (primitiveType_) {
     case Primitive_POINT:
-        for (auto& primitive : primitives_) {
-            if (primitive.discard) {
-                continue;
-            }
-            auto* vert0 = &vertexes_[primitive.indices[0]];
-            rasterizationPoint(vert0, pointSize_);
-        }
+        rasterizationPoints(primitives_, pointSize_);
         break;
     case Primitive_LINE:
-        for (auto& primitive : primitives_) {
-            if (primitive.discard) {
-                continue;
-            }
-            auto* vert0 = &vertexes_[primitive.indices[0]];
-            auto* vert1 = &vertexes_[primitive.indices[1]];
-            rasterizationLine(vert0, vert1, renderState_->lineWidth);
-        }
+        rasterizationLines(primitives_, renderState_->lineWidth);
         break;
     case Primitive_TRIANGLE:
-        // 初始化多线程上下文（每个线程独立副本）
-        threadQuadCtx_.resize(threadPool_.getThreadCnt());
-        for (auto& ctx : threadQuadCtx_) {
-            ctx.SetVaryingsSize(varyingsAlignedCnt_);
-
-            // 克隆着色器程序（保证线程安全）
-            ctx.shaderProgram = shaderProgram_->clone();
-            ctx.shaderProgram->prepareFragmentShader();
-
-            // 设置导数计算上下文（用于ddx/ddy指令）
-            DerivativeContext& df_ctx = ctx.shaderProgram->getShaderBuiltin().dfCtx;
-            df_ctx.p0 = ctx.pixels[0].varyingsFrag;
-            df_ctx.p1 = ctx.pixels[1].varyingsFrag;
-            df_ctx.p2 = ctx.pixels[2].varyingsFrag;
-            df_ctx.p3 = ctx.pixels[3].varyingsFrag;
-        }
         rasterizationPolygons(primitives_);
-        threadPool_.waitTasksFinish();
         break;
     }
+    threadPool_.waitTasksFinish();
 }
 
 /*执行片段着色器处理流程*/
@@ -378,6 +452,26 @@ void RendererSoft::processFragmentShader(glm::aligned_vec4& screenPos, bool fron
     shader->execFragmentShader();
 }
 
+/*以2x2像素块为单位执行片段着色器，结果写入quad.shaderQuad.fragColor*/
+void RendererSoft::processFragmentShaderQuad(PixelQuadContext& quad) {
+    if (!fboColor_) {
+        return;
+    }
+
+    auto& shaderQuad = quad.shaderQuad;
+    shaderQuad.frontFacing = quad.frontFacing;
+    shaderQuad.activeMask = 0;
+    for (int i = 0; i < QUAD_LANES; i++) {
+        auto& pixel = quad.pixels[i];
+        shaderQuad.varyings[i] = pixel.varyingsFrag;
+        shaderQuad.fragCoord[i] = pixel.sampleShading->position;
+        if (pixel.inside) {
+            shaderQuad.activeMask |= 1u << i;
+        }
+    }
+    quad.shaderProgram->execFragmentShaderQuad(shaderQuad);
+}
+
 /*执行逐采样点的片元操作，进行深度测试、blend、写入fbo, sample = 0 表示无MSAA*/
 void RendererSoft::processPerSampleOperations(int x, int y, float depth, const glm::vec4& color, int sample) {
     // depth test
@@ -413,6 +507,7 @@ bool RendererSoft::processDepthTest(int x, int y, float depth, int sample, bool
         // depth attachment writes
         if (!skipWrite && renderState_->depthMask) {
             *zPtr = depth;
+            depthPyramid_.onDepthWrite(x, y, depth);
         }
         return true;
     }
@@ -436,7 +531,7 @@ void RendererSoft::processPointAssembly() {
     primitives_.resize(vao_->indicesCnt);
     for (int idx = 0; idx < primitives_.size(); idx++) {
         auto& point = primitives_[idx];
-        point.indices[0] = vao_->indices[idx];
+        point.indices[0] = vao_->slotIndices[idx];
         point.discard = false;
     }
 }
@@ -447,8 +542,8 @@ void RendererSoft::processLineAssembly() {
     for (int idx = 0; idx < primitives_.size(); idx++) {
         auto& line = primitives_[idx];
 
-        line.indices[0] = vao_->indices[idx * 2];
-        line.indices[1] = vao_->indices[idx * 2 + 1];
+        line.indices[0] = vao_->slotIndices[idx * 2];
+        line.indices[1] = vao_->slotIndices[idx * 2 + 1];
         line.discard = false;
     }
 }
@@ -458,10 +553,10 @@ void RendererSoft::processPolygonAssembly() {
     primitives_.resize(vao_->indicesCnt / 3);
     for (int idx = 0; idx < primitives_.size(); idx++) {
         auto& triangle = primitives_[idx];
-        //装配三角形顶点索引
-        triangle.indices[0] = vao_->indices[idx * 3];
-        triangle.indices[1] = vao_->indices[idx * 3 + 1];
-        triangle.indices[2] = vao_->indices[idx * 3 + 2];
+        //装配三角形顶点索引（指向变换后顶点缓存的槽位）
+        triangle.indices[0] = vao_->slotIndices[idx * 3];
+        triangle.indices[1] = vao_->slotIndices[idx * 3 + 1];
+        triangle.indices[2] = vao_->slotIndices[idx * 3 + 2];
         triangle.discard = false;
     }
 }
@@ -517,11 +612,14 @@ void RendererSoft::clippingLine(PrimitiveHolder& line, bool postVertexProcess) {
         return;
     }
 
+    // t0、t1都是相对原始线段的参数，两端都需裁剪时不能使用已替换的端点
+    size_t idx0 = line.indices[0];
+    size_t idx1 = line.indices[1];
     if (clipMaskV0) {
-        line.indices[0] = clippingNewVertex(line.indices[0], line.indices[1], t0, postVertexProcess);
+        line.indices[0] = clippingNewVertex(idx0, idx1, t0, postVertexProcess);
     }
     if (clipMaskV1) {
-        line.indices[1] = clippingNewVertex(line.indices[0], line.indices[1], t1, postVertexProcess);
+        line.indices[1] = clippingNewVertex(idx0, idx1, t1, postVertexProcess);
     }
 }
 
@@ -537,59 +635,77 @@ void RendererSoft::clippingTriangle(PrimitiveHolder& triangle, std::vector<Primi
         return;
     }
 
-    //初始化裁剪状态
+    //初始化裁剪状态（顶点数有上限，使用栈上数组避免堆分配）
     bool fullClip = false;// 完全裁剪标志
-    std::vector<size_t> indicesIn;// 当前裁剪阶段的输入顶点索引
-    std::vector<size_t> indicesOut;// 当前裁剪阶段的输出顶点索引
+    size_t indicesBuffer[2][CLIP_MAX_POLYGON_VERTEX];
+    size_t* indicesIn = indicesBuffer[0];// 当前裁剪阶段的输入顶点索引
+    size_t* indicesOut = indicesBuffer[1];// 当前裁剪阶段的输出顶点索引
+    int inCnt = 0;
+    int outCnt = 0;
 
-    indicesIn.push_back(v0->index);
-    indicesIn.push_back(v1->index);
-    indicesIn.push_back(v2->index);
+    indicesIn[inCnt++] = v0->index;
+    indicesIn[inCnt++] = v1->index;
+    indicesIn[inCnt++] = v2->index;
 
     // 逐平面裁剪 
     for (int planeIdx = 0; planeIdx < 6; planeIdx++) {
         // 只处理当前三角形涉及的裁剪平面
         if (mask & FrustumClipMaskArray[planeIdx]) {
-            if (indicesIn.size() < 3) {
+            if (inCnt < 3) {
                 fullClip = true;
                 break;
             }
-            indicesOut.clear();
+            outCnt = 0;
             size_t idxPre = indicesIn[0];
-            // 计算前一个顶点到裁剪平面的距离
+            // 计算前一个顶点到裁剪平面的距离，保留与相交判断使用同一个可见性条件（-0.0在可见侧）
             float dPre = glm::dot(FrustumClipPlane[planeIdx], glm::vec4(vertexes_[idxPre].clipPos));
+            bool insidePre = dPre >= 0;
 
             // 闭合多边形：将第一个顶点再次加入尾部
-            indicesIn.push_back(idxPre);
+            indicesIn[inCnt++] = idxPre;
 
             // 遍历每对相邻顶点（包括闭合边）
-            for (int i = 1; i < indicesIn.size(); i++) {
+            for (int i = 1; i < inCnt; i++) {
                 size_t idx = indicesIn[i];
                 float d = glm::dot(FrustumClipPlane[planeIdx], glm::vec4(vertexes_[idx].clipPos));
+                bool inside = d >= 0;
+
+                // 精确计算时每个平面最多增加一个顶点，但近退化/近共面三角形的距离符号可能因舍入沿多边形交替变化，
+                // 输出顶点数超出上限（保留闭合用的位置）时丢弃该三角形，这类三角形几乎没有面积
+                int emitCnt = (insidePre ? 1 : 0) + (insidePre != inside ? 1 : 0);
+                if (outCnt + emitCnt > CLIP_MAX_POLYGON_VERTEX - 1) {
+                    fullClip = true;
+                    break;
+                }
 
                 // 规则1：前一个顶点在可见侧 → 加入输出列表
-                if (dPre >= 0) {
-                    indicesOut.push_back(idxPre);
+                if (insidePre) {
+                    indicesOut[outCnt++] = idxPre;
                 }
 
                 // 规则2：线段与裁剪平面相交 → 计算交点
-                if (std::signbit(dPre) != std::signbit(d)) {
-                    float t = d < 0 ? dPre / (dPre - d) : -dPre / (d - dPre); // 保证分母为正，减小浮点误差
+                if (insidePre != inside) {
+                    float t = insidePre ? dPre / (dPre - d) : -dPre / (d - dPre); // 保证分母为正，减小浮点误差
                     // 创建新顶点（插值顶点属性）
                     auto vertIdx = clippingNewVertex(idxPre, idx, t);
-                    indicesOut.push_back(vertIdx);
+                    indicesOut[outCnt++] = vertIdx;
                 }
 
                 // 更新前一个顶点状态
                 idxPre = idx;
                 dPre = d;
+                insidePre = inside;
+            }
+            if (fullClip) {
+                break;
             }
 
             std::swap(indicesIn, indicesOut);
+            inCnt = outCnt;
         }
     }
     // 情况1：完全不可见
-    if (fullClip || indicesIn.empty()) {
+    if (fullClip || inCnt < 3) {
         triangle.discard = true;
         return;
     }
@@ -600,7 +716,7 @@ void RendererSoft::clippingTriangle(PrimitiveHolder& triangle, std::vector<Primi
     triangle.indices[2] = indicesIn[2];
 
     // 情况3：被裁剪为凸多边形（需要三角化）
-    for (int i = 3; i < indicesIn.size(); i++) {
+    for (int i = 3; i < inCnt; i++) {
         appendPrimitives.emplace_back();
         PrimitiveHolder& ph = appendPrimitives.back();
         ph.discard = false;
@@ -626,13 +742,20 @@ void RendererSoft::rasterizationPolygons(std::vector<PrimitiveHolder>& primitive
     }
 }
 
-// 多边形点模式光栅化处理
+// 多边形点模式光栅化处理：共享顶点只绘制一次，裁剪后与点图元一样分tile光栅化
 void RendererSoft::rasterizationPolygonsPoint(std::vector<PrimitiveHolder>& primitives) {
+    polygonPrimitives_.clear();
+    pointVisited_.assign(vertexes_.size(), 0);
     for (auto& triangle : primitives) {
         if (triangle.discard) {
             continue;
         }
         for (size_t idx : triangle.indices) {
+            if (pointVisited_[idx]) {
+                continue;
+            }
+            pointVisited_[idx] = 1;
+
             PrimitiveHolder point;
             point.discard = false;
             point.frontFacing = triangle.frontFacing;
@@ -643,75 +766,279 @@ void RendererSoft::rasterizationPolygonsPoint(std::vector<PrimitiveHolder>& prim
             if (point.discard) {
                 continue;
             }
-
-            // rasterization
-            rasterizationPoint(&vertexes_[point.indices[0]], pointSize_);
+            polygonPrimitives_.push_back(point);
         }
     }
+
+    // rasterization
+    rasterizationPoints(polygonPrimitives_, pointSize_);
 }
 
-// 多边形线框模式光栅化处理
+// 多边形线框模式光栅化处理：相邻三角形的共享边只绘制一次，裁剪后与线段图元一样分tile光栅化
 void RendererSoft::rasterizationPolygonsLine(std::vector<PrimitiveHolder>& primitives) {
+    // 按两个顶点下标在开放寻址哈希表中去重，装载率不超过1/2，保持每条边第一次出现的顺序
+    size_t capacity = 64;
+    while (capacity < primitives.size() * 3 * 2) {
+        capacity <<= 1;
+    }
+    edgeSet_.assign(capacity, EDGE_EMPTY);
+
+    polygonPrimitives_.clear();
     for (auto& triangle : primitives) {
         if (triangle.discard) {
             continue;
         }
         for (size_t i = 0; i < 3; i++) {
+            size_t idx0 = triangle.indices[i];
+            size_t idx1 = triangle.indices[(i + 1) % 3];
+            if (!insertEdge(std::min(idx0, idx1), std::max(idx0, idx1))) {
+                continue;
+            }
+
             PrimitiveHolder line;
             line.discard = false;
             line.frontFacing = triangle.frontFacing;
-            line.indices[0] = triangle.indices[i];
-            line.indices[1] = triangle.indices[(i + 1) % 3];
+            line.indices[0] = idx0;
+            line.indices[1] = idx1;
 
             // clipping
             clippingLine(line, true); //true: 表示在视口空间执行裁剪（已透视除法）
             if (line.discard) {
                 continue;
             }
+            polygonPrimitives_.push_back(line);
+        }
+    }
+
+    // rasterization
+    rasterizationLines(polygonPrimitives_, renderState_->lineWidth);
+}
 
-            // rasterization
-            rasterizationLine(&vertexes_[line.indices[0]],
-                &vertexes_[line.indices[1]],
-                renderState_->lineWidth);
+// 将边(idx0, idx1)（idx0 <= idx1）加入edgeSet_，已存在时返回false
+bool RendererSoft::insertEdge(size_t idx0, size_t idx1) {
+    uint64_t key = ((uint64_t)idx0 << 32) | (uint64_t)idx1;
+    uint64_t hash = key * 0x9E3779B97F4A7C15ull;
+    size_t mask = edgeSet_.size() - 1;
+    size_t slot = (size_t)(hash ^ (hash >> 32)) & mask;
+    while (edgeSet_[slot] != EDGE_EMPTY) {
+        if (edgeSet_[slot] == key) {
+            return false;
         }
+        slot = (slot + 1) & mask;
     }
+    edgeSet_[slot] = key;
+    return true;
+}
+
+// 点图元光栅化：按点的屏幕范围分箱后以tile为单位并行绘制
+void RendererSoft::rasterizationPoints(std::vector<PrimitiveHolder>& points, float pointSize) {
+    binningPrimitives(points, 1, pointSize);
+    rasterizationTiles([this, &points, pointSize](int tileX, int tileY, PixelQuadContext& quad) {
+        rasterizationTilePoints(tileX, tileY, quad, points, pointSize);
+    });
 }
 
-// 三角形图元光栅化
+// 线段图元光栅化：按线段（含线宽）的屏幕范围分箱后以tile为单位并行绘制
+void RendererSoft::rasterizationLines(std::vector<PrimitiveHolder>& lines, float lineWidth) {
+    binningPrimitives(lines, 2, lineWidth);
+    rasterizationTiles([this, &lines, lineWidth](int tileX, int tileY, PixelQuadContext& quad) {
+        rasterizationTileLines(tileX, tileY, quad, lines, lineWidth);
+    });
+}
+
+// 三角形图元光栅化：先按屏幕tile分箱，再以tile为单位派发任务，每个任务按提交顺序绘制该tile内的全部三角形
 void RendererSoft::rasterizationPolygonsTriangle(std::vector<PrimitiveHolder>& primitives) {
-    for (auto& triangle : primitives) {
+    binningTriangles(primitives);
+    rasterizationTiles([this](int tileX, int tileY, PixelQuadContext& quad) {
+        rasterizationTile(tileX, tileY, quad);
+    });
+}
+
+// 为每个非空tile派发一个任务，同一tile只由一个线程处理，tile内的图元按提交顺序绘制。
+// 任务在processRasterization结束时才等待完成，rasterTile按值复制到每个任务中，其引用的图元数组需保持有效
+template<typename Func>
+void RendererSoft::rasterizationTiles(const Func& rasterTile) {
+    for (int tileY = 0; tileY < tileCntY_; tileY++) {
+        for (int tileX = 0; tileX < tileCntX_; tileX++) {
+            if (tileBins_[tileY * tileCntX_ + tileX].empty()) {
+                continue;
+            }
+#ifdef RASTER_MULTI_THREAD
+            threadPool_.pushTask([rasterTile, this, tileX, tileY](int thread_id) {
+                auto& pixelQuad = threadQuadCtx_[thread_id];
+#else
+            auto& pixelQuad = threadQuadCtx_[0];
+#endif
+            rasterTile(tileX, tileY, pixelQuad);
+#ifdef RASTER_MULTI_THREAD
+                });
+#endif
+        }
+    }
+}
+
+// 按当前视口重新计算tile数量并清空分箱，复用上一次draw的分箱内存
+void RendererSoft::resetTileBins() {
+    auto tileSize = rasterBlockSize_;
+    tileCntX_ = ((int)viewport_.width + tileSize - 1) / tileSize;
+    tileCntY_ = ((int)viewport_.height + tileSize - 1) / tileSize;
+
+    tileBins_.resize(tileCntX_ * tileCntY_);
+    for (auto& bin : tileBins_) {
+        bin.clear();
+    }
+}
+
+// 将图元下标加入屏幕包围盒覆盖的所有tile
+void RendererSoft::binningBounds(size_t idx, const BoundingBox& bounds) {
+    if (bounds.max.x < bounds.min.x || bounds.max.y < bounds.min.y) {
+        return;
+    }
+    auto tileSize = rasterBlockSize_;
+    int tileMinX = (int)bounds.min.x / tileSize;
+    int tileMinY = (int)bounds.min.y / tileSize;
+    int tileMaxX = std::min((int)bounds.max.x / tileSize, tileCntX_ - 1);
+    int tileMaxY = std::min((int)bounds.max.y / tileSize, tileCntY_ - 1);
+    for (int tileY = tileMinY; tileY <= tileMaxY; tileY++) {
+        for (int tileX = tileMinX; tileX <= tileMaxX; tileX++) {
+            tileBins_[tileY * tileCntX_ + tileX].push_back(idx);
+        }
+    }
+}
+
+// 点、线分箱：包围盒为各顶点处边长为size的正方形的并集，与rasterizationPoint绘制的像素范围一致
+void RendererSoft::binningPrimitives(std::vector<PrimitiveHolder>& primitives, int vertexCnt, float size) {
+    resetTileBins();
+
+    for (size_t idx = 0; idx < primitives.size(); idx++) {
+        auto& primitive = primitives[idx];
+        if (primitive.discard) {
+            continue;
+        }
+        float minX = std::numeric_limits<float>::max();
+        float minY = std::numeric_limits<float>::max();
+        float maxX = -std::numeric_limits<float>::max();
+        float maxY = -std::numeric_limits<float>::max();
+        for (int i = 0; i < vertexCnt; i++) {
+            auto& pos = vertexes_[primitive.indices[i]].fragPos;
+            // 线段按整数像素坐标绘制，与rasterizationLine一致先取整
+            float x = vertexCnt > 1 ? (float)(int)pos.x : pos.x;
+            float y = vertexCnt > 1 ? (float)(int)pos.y : pos.y;
+            minX = std::min(minX, x);
+            minY = std::min(minY, y);
+            maxX = std::max(maxX, x);
+            maxY = std::max(maxY, y);
+        }
+        // 多扩展1个像素，覆盖(int)截断带来的误差
+        float half = size / 2.f + 1.f;
+        BoundingBox bounds;
+        bounds.min = glm::vec3(std::max(minX - half, 0.f), std::max(minY - half, 0.f), 0.f);
+        bounds.max = glm::vec3(std::min(maxX + half, viewport_.width - 1.f), std::min(maxY + half, viewport_.height - 1.f), 0.f);
+        binningBounds(idx, bounds);
+    }
+}
+
+// 三角形分箱：根据屏幕包围盒将三角形下标加入其覆盖的所有tile
+void RendererSoft::binningTriangles(std::vector<PrimitiveHolder>& primitives) {
+    resetTileBins();
+
+    for (size_t idx = 0; idx < primitives.size(); idx++) {
+        auto& triangle = primitives[idx];
         if (triangle.discard) {
             continue;
         }
-        rasterizationTriangle(&vertexes_[triangle.indices[0]],
+        glm::aligned_vec4 screenPos[3] = { vertexes_[triangle.indices[0]].fragPos,
+                                           vertexes_[triangle.indices[1]].fragPos,
+                                           vertexes_[triangle.indices[2]].fragPos };
+        binningBounds(idx, triangleBoundingBox(screenPos, viewport_.width, viewport_.height));
+    }
+}
+
+// 第一次写入tile前填充延迟清除的值，随后的光栅化马上会访问，使用普通存储
+void RendererSoft::prepareTile(int tileX, int tileY) {
+    if (fboColor_ && fboColor_->isTileCleared(tileX, tileY)) {
+        fboColor_->materializeTile(tileX, tileY, false);
+    }
+    if (fboDepth_ && renderState_->depthTest && fboDepth_->isTileCleared(tileX, tileY)) {
+        fboDepth_->materializeTile(tileX, tileY, false);
+    }
+}
+
+// 光栅化单个tile内的所有三角形，同一tile只由一个线程处理，因此无需对帧缓冲加锁
+void RendererSoft::rasterizationTile(int tileX, int tileY, PixelQuadContext& quad) {
+    prepareTile(tileX, tileY);
+
+    for (size_t idx : tileBins_[tileY * tileCntX_ + tileX]) {
+        auto& triangle = primitives_[idx];
+        rasterizationTriangle(quad,
+            &vertexes_[triangle.indices[0]],
             &vertexes_[triangle.indices[1]],
             &vertexes_[triangle.indices[2]],
-            triangle.frontFacing);
+            triangle.frontFacing, tileX, tileY);
+        if (depthCulling_) {
+            depthPyramid_.refreshTile(tileX, tileY);
+        }
     }
 }
 
-// 点图元光栅化处理
-void RendererSoft::rasterizationPoint(VertexHolder* v, float pointSize) {
+// 光栅化单个tile内的所有点图元
+void RendererSoft::rasterizationTilePoints(int tileX, int tileY, PixelQuadContext& quad,
+                                           std::vector<PrimitiveHolder>& points, float pointSize) {
+    prepareTile(tileX, tileY);
+    glm::ivec4 tileRect = getTileRect(tileX, tileY);
+    for (size_t idx : tileBins_[tileY * tileCntX_ + tileX]) {
+        auto* v = &vertexes_[points[idx].indices[0]];
+        rasterizationPoint(quad, v->fragPos, v->varyings, pointSize, tileRect);
+    }
+}
+
+// 光栅化单个tile内的所有线段图元
+void RendererSoft::rasterizationTileLines(int tileX, int tileY, PixelQuadContext& quad,
+                                          std::vector<PrimitiveHolder>& lines, float lineWidth) {
+    prepareTile(tileX, tileY);
+    glm::ivec4 tileRect = getTileRect(tileX, tileY);
+    for (size_t idx : tileBins_[tileY * tileCntX_ + tileX]) {
+        auto& line = lines[idx];
+        rasterizationLine(quad, &vertexes_[line.indices[0]], &vertexes_[line.indices[1]], lineWidth, tileRect);
+    }
+}
+
+// tile(tileX, tileY)在屏幕上的像素范围[x, z) x [y, w)
+glm::ivec4 RendererSoft::getTileRect(int tileX, int tileY) {
+    int tileSize = rasterBlockSize_;
+    return { tileX * tileSize, tileY * tileSize,
+             std::min((tileX + 1) * tileSize, (int)viewport_.width),
+             std::min((tileY + 1) * tileSize, (int)viewport_.height) };
+}
+
+// 点图元光栅化处理，只绘制tileRect范围内的像素，使用线程自己的着色器程序
+void RendererSoft::rasterizationPoint(PixelQuadContext& quad, const glm::aligned_vec4& fragPos, float* varyings,
+                                      float pointSize, const glm::ivec4& tileRect) {
     if (!fboColor_) {
         return;
     }
 
     // 计算点图元的屏幕空间包围盒，+0.5f 是为了将坐标从像素索引转换为像素中心坐标 
-    float left = v->fragPos.x - pointSize / 2.f + 0.5f;
+    float left = fragPos.x - pointSize / 2.f + 0.5f;
     float right = left + pointSize;
-    float top = v->fragPos.y - pointSize / 2.f + 0.5f;
+    float top = fragPos.y - pointSize / 2.f + 0.5f;
     float bottom = top + pointSize;
 
-    // 获取屏幕空间位置引用（用于后续修改）
-    glm::aligned_vec4& screenPos = v->fragPos;
+    int startX = std::max((int)left, tileRect.x);
+    int endX = std::min((int)right, tileRect.z);
+    int startY = std::max((int)top, tileRect.y);
+    int endY = std::min((int)bottom, tileRect.w);
 
-    for (int x = (int)left; x < (int)right; x++) {
-        for (int y = (int)top; y < (int)bottom; y++) {
+    // 顶点可能被多个tile同时读取，在副本上修改屏幕坐标
+    glm::aligned_vec4 screenPos = fragPos;
+    ShaderProgramSoft* program = quad.shaderProgram.get();
+    for (int x = startX; x < endX; x++) {
+        for (int y = startY; y < endY; y++) {
             screenPos.x = (float)x;
             screenPos.y = (float)y;
             // 执行片段着色器
-            processFragmentShader(screenPos, true, v->varyings, shaderProgram_);
-            auto& builtIn = shaderProgram_->getShaderBuiltin();
+            processFragmentShader(screenPos, true, varyings, program);
+            auto& builtIn = program->getShaderBuiltin();
             if (!builtIn.discard) {
                 // TODO MSAA
                 for (int idx = 0; idx < rasterSamples_; idx++) {
@@ -722,8 +1049,9 @@ void RendererSoft::rasterizationPoint(VertexHolder* v, float pointSize) {
     }
 }
 
-// 直线光栅化处理
-void RendererSoft::rasterizationLine(VertexHolder* v0, VertexHolder* v1, float lineWidth) {
+// 直线光栅化处理，只绘制tileRect范围内的像素
+void RendererSoft::rasterizationLine(PixelQuadContext& quad, VertexHolder* v0, VertexHolder* v1, float lineWidth,
+                                     const glm::ivec4& tileRect) {
     // TODO diamond-exit rule
     //  提取屏幕空间整数坐标（像素位置）
     int x0 = (int)v0->fragPos.x, y0 = (int)v0->fragPos.y;
@@ -735,11 +1063,17 @@ void RendererSoft::rasterizationLine(VertexHolder* v0, VertexHolder* v1, float l
     float w0 = v0->fragPos.w;
     float w1 = v1->fragPos.w;
 
+    // tile在主方向（x）与次方向（y）上的范围，陡峭线段交换后同样交换
+    int majorMin = tileRect.x, majorMax = tileRect.z;
+    int minorMin = tileRect.y, minorMax = tileRect.w;
+
     // 检测是否为陡峭线段（斜率>1）
     bool steep = false;
     if (std::abs(x0 - x1) < std::abs(y0 - y1)) {// 交换x/y坐标（将陡峭线段转换为平缓线段处理）
         std::swap(x0, y0);
         std::swap(x1, y1);
+        std::swap(majorMin, minorMin);
+        std::swap(majorMax, minorMax);
         steep = true;
     }
 
@@ -758,136 +1092,376 @@ void RendererSoft::rasterizationLine(VertexHolder* v0, VertexHolder* v1, float l
     int dy = y1 - y0;
 
     //Bresenham算法核心
-    int error = 0;// 误差累加器
     int dError = 2 * std::abs(dy);// 误差增量
+    int yStep = y1 > y0 ? 1 : -1;
 
-    int y = y0;
+    // 只遍历以线宽扩展后可能落在tile内的点，多扩展1个像素覆盖取整误差
+    int extent = (int)(lineWidth / 2.f) + 1;
+    int startX = std::max(x0, majorMin - extent);
+    int endX = std::min(x1, majorMax - 1 + extent);
+    if (startX > endX) {
+        return;
+    }
 
-    // 创建临时顶点用于插值结果存储
-    auto varyings = MemoryUtils::makeBuffer<float>(varyingsCnt_);
+    // 直接求出startX处的y与误差累加器：前k步中y共前进n次，n为使误差落在(-dx, dx]内的整数
+    int64_t k = startX - x0;
+    int64_t num = k * dError - dx;
+    int64_t n = num <= 0 ? 0 : (num + 2 * (int64_t)dx - 1) / (2 * (int64_t)dx);
+    int y = y0 + (int)n * yStep;
+    int error = (int)(k * dError - n * 2 * dx);// 误差累加器
+
+    // 插值结果存储在线程自己的varyings缓冲中，避免每条线段分配内存
     VertexHolder pt{};
-    pt.varyings = varyings.get();
+    pt.varyings = quad.pixels[0].varyingsFrag;
 
     //--------------------- 主循环：遍历x方向每个像素----------------- 
     float t = 0;// 插值系数
-    for (int x = x0; x <= x1; x++) {
-        // 计算当前点在线段中的比例t ∈ [0,1]
-        t = (float)(x - x0) / (float)dx;
-        pt.fragPos = glm::vec4(x, y, glm::mix(z0, z1, t), glm::mix(w0, w1, t));
-
-        // 如果是陡峭线段，交换回原始坐标空间
-        if (steep) {
-            std::swap(pt.fragPos.x, pt.fragPos.y);
-        }
+    for (int x = startX; x <= endX; x++) {
+        // 次方向上以线宽扩展后与tile不相交的点直接跳过
+        if (y + extent >= minorMin && y - extent < minorMax) {
+            // 计算当前点在线段中的比例t ∈ [0,1]
+            t = (float)(x - x0) / (float)dx;
+            pt.fragPos = glm::vec4(x, y, glm::mix(z0, z1, t), glm::mix(w0, w1, t));
+
+            // 如果是陡峭线段，交换回原始坐标空间
+            if (steep) {
+                std::swap(pt.fragPos.x, pt.fragPos.y);
+            }
 
-        // 插值顶点属性（颜色/纹理坐标等）
-        interpolateLinear(pt.varyings, varyingsIn, varyingsCnt_, t);
+            // 插值顶点属性（颜色/纹理坐标等）
+            interpolateLinear(pt.varyings, varyingsIn, varyingsCnt_, t);
 
-        // 以当前点为中心绘制线宽（扩展为圆形/方形）
-        rasterizationPoint(&pt, lineWidth);
+            // 以当前点为中心绘制线宽（扩展为圆形/方形）
+            rasterizationPoint(quad, pt.fragPos, pt.varyings, lineWidth, tileRect);
+        }
 
         // Bresenham误差更新
         error += dError;
         if (error > dx) {
-            y += (y1 > y0 ? 1 : -1);// 根据斜率方向调整y
+            y += yStep;// 根据斜率方向调整y
             error -= 2 * dx;
         }
     }
 }
 
-/*三角形光栅化处理， 分块处理*/
-void RendererSoft::rasterizationTriangle(VertexHolder* v0, VertexHolder* v1, VertexHolder* v2, bool frontFacing) {
-    // TODO top-left rule
+/*三角形光栅化处理，只处理三角形包围盒与tile(tileX, tileY)相交的部分*/
+void RendererSoft::rasterizationTriangle(PixelQuadContext& quad, VertexHolder* v0, VertexHolder* v1, VertexHolder* v2,
+                                         bool frontFacing, int tileX, int tileY) {
     VertexHolder* vert[3] = { v0, v1, v2 };
     glm::aligned_vec4 screenPos[3] = { vert[0]->fragPos, vert[1]->fragPos, vert[2]->fragPos };
     BoundingBox bounds = triangleBoundingBox(screenPos, viewport_.width, viewport_.height);
-    bounds.min -= 1.f;// 扩展1像素避免边界误差
 
-    auto blockSize = rasterBlockSize_;// 分块大小（默认32x32）
-    // 计算x/y方向的分块数量（向上取整）
-    int blockCntX = (bounds.max.x - bounds.min.x + blockSize - 1.f) / blockSize;
-    int blockCntY = (bounds.max.y - bounds.min.y + blockSize - 1.f) / blockSize;
+    // 包围盒与tile求交，起点对齐到偶数像素，保证2x2像素块在屏幕上对齐且不跨tile
+    auto tileSize = rasterBlockSize_;
+    int startX = std::max((int)bounds.min.x, tileX * tileSize) & ~1;
+    int startY = std::max((int)bounds.min.y, tileY * tileSize) & ~1;
+    int endX = std::min((int)bounds.max.x, (tileX + 1) * tileSize - 1);
+    int endY = std::min((int)bounds.max.y, (tileY + 1) * tileSize - 1);
+    if (startX > endX || startY > endY) {
+        return;
+    }
 
-    // 分块遍历
-    for (int blockY = 0; blockY < blockCntY; blockY++) {
-        for (int blockX = 0; blockX < blockCntX; blockX++) {
-#ifdef RASTER_MULTI_THREAD
-            threadPool_.pushTask([&, vert, bounds, blockSize, blockX, blockY](int thread_id) {
-                // init pixel quad
-                auto pixelQuad = threadQuadCtx_[thread_id];
-#else
-            auto pixelQuad = threadQuadCtx_[0];
-#endif
-            pixelQuad.frontFacing = frontFacing;
-            // 填充顶点数据（位置、深度、透视校正系数、插值变量）
-            for (int i = 0; i < 3; i++) {
-                pixelQuad.vertPos[i] = vert[i]->fragPos;
-                pixelQuad.vertZ[i] = &vert[i]->fragPos.z;
-                pixelQuad.vertW[i] = vert[i]->fragPos.w;// 1/w（用于透视校正）
-                pixelQuad.vertVaryings[i] = vert[i]->varyings;// 顶点着色器输出变量
+    // 三角形的深度范围即顶点深度范围，在tile内一定无法通过深度测试时整个跳过
+    bool cullDepth = depthCulling_ && std::isfinite(screenPos[0].z) && std::isfinite(screenPos[1].z)
+        && std::isfinite(screenPos[2].z);
+    float triZMin = std::min(std::min(screenPos[0].z, screenPos[1].z), screenPos[2].z);
+    float triZMax = std::max(std::max(screenPos[0].z, screenPos[1].z), screenPos[2].z);
+    if (cullDepth) {
+        float tileZMin, tileZMax;
+        depthPyramid_.getTileRange(tileX, tileY, tileZMin, tileZMax);
+        if (depthRangeOccluded(triZMin, triZMax, tileZMin, tileZMax)) {
+            return;
+        }
+    }
+
+    quad.frontFacing = frontFacing;
+    // 填充顶点数据（位置、深度、透视校正系数、插值变量）
+    for (int i = 0; i < 3; i++) {
+        quad.vertPos[i] = vert[i]->fragPos;
+        quad.vertZ[i] = &vert[i]->fragPos.z;
+        quad.vertW[i] = vert[i]->fragPos.w;// 1/w（用于透视校正）
+        quad.vertVaryings[i] = vert[i]->varyings;// 顶点着色器输出变量
+    }
+
+    // 定点数边函数超出int32范围（超大三角形）时，回退到浮点重心坐标
+    if (!rasterizationSetupEdges(quad, startX, startY, endX, endY)) {
+        // 优化数据布局（SIMD友好）重心坐标的系数 (α, β, γ) 默认对应三角形的三个顶点时，其计算顺序与 ​​顶点顺序相反​​，所以按v2,v1,v0的顺序存储
+        glm::aligned_vec4* vertPos = quad.vertPos;
+        quad.vertPosFlat[0] = { vertPos[2].x, vertPos[1].x, vertPos[0].x, 0.f };
+        quad.vertPosFlat[1] = { vertPos[2].y, vertPos[1].y, vertPos[0].y, 0.f };
+        quad.vertPosFlat[2] = { vertPos[0].z, vertPos[1].z, vertPos[2].z, 0.f };// 注意z顺序反转
+        quad.vertPosFlat[3] = { vertPos[0].w, vertPos[1].w, vertPos[2].w, 0.f };
+
+        for (int y = startY; y <= endY; y += 2) {
+            for (int x = startX; x <= endX; x += 2) {
+                quad.Init((float)x, (float)y, rasterSamples_);
+                for (auto& pixel : quad.pixels) {
+                    for (auto& sample : pixel.samples) {
+                        sample.inside = barycentric(quad.vertPosFlat, quad.vertPos[0], sample.position, sample.barycentric);
+                    }
+                    pixel.InitCoverage();
+                    pixel.InitShadingSample();
+                }
+                (this->*rasterPixelQuad_)(quad);
             }
+        }
+        return;
+    }
+    if (quad.edges.degenerate) {
+        return;
+    }
+
+    // 一次边函数求值处理一个像素块：无MSAA时为4x2像素（两个2x2像素块，8个lane），
+    // MSAA时为2x2像素（如4x为16个采样点+4个像素中心，3组8个lane，见RasterLaneCount）
+    const bool multiSample = rasterSamples_ > 1;
+    const int blockW = multiSample ? 2 : 4;
+    const int32_t* a = quad.edges.a;
+    const int32_t* b = quad.edges.b;
 
-            // 优化数据布局（SIMD友好）重心坐标的系数 (α, β, γ) 默认对应三角形的三个顶点时，其计算顺序与 ​​顶点顺序相反​​，所以按v2,v1,v0的顺序存储
-            glm::aligned_vec4* vertPos = pixelQuad.vertPos;
-            pixelQuad.vertPosFlat[0] = { vertPos[2].x, vertPos[1].x, vertPos[0].x, 0.f };
-            pixelQuad.vertPosFlat[1] = { vertPos[2].y, vertPos[1].y, vertPos[0].y, 0.f };
-            pixelQuad.vertPosFlat[2] = { vertPos[0].z, vertPos[1].z, vertPos[2].z, 0.f };// 注意z顺序反转
-            pixelQuad.vertPosFlat[3] = { vertPos[0].w, vertPos[1].w, vertPos[2].w, 0.f };
-
-            // 处理当前分块
-            int blockStartX = bounds.min.x + blockX * blockSize;
-            int blockStartY = bounds.min.y + blockY * blockSize;
-            // 以2x2像素为单元遍历（提高缓存命中率）
-            for (int y = blockStartY + 1; y < blockStartY + blockSize && y <= bounds.max.y; y += 2) {
-                for (int x = blockStartX + 1; x < blockStartX + blockSize && x <= bounds.max.x; x += 2) {
-                    pixelQuad.Init((float)x, (float)y, rasterSamples_);
-                    rasterizationPixelQuad(pixelQuad);
+    // 按与分层深度对齐的8x8区域遍历，先整块判断覆盖与遮挡，通过后再逐像素块求边函数
+    const int cullSize = DepthPyramidSoft::BLOCK_SIZE;
+    for (int cullY = startY & ~(cullSize - 1); cullY <= endY; cullY += cullSize) {
+        for (int cullX = startX & ~(cullSize - 1); cullX <= endX; cullX += cullSize) {
+            if (!rasterizationBlockVisible(quad, cullX, cullY, startX, startY, cullDepth, triZMin, triZMax)) {
+                continue;
+            }
+            // startX、startY为偶数，区域起点仍与2x2像素块对齐
+            int regionStartX = std::max(cullX, startX);
+            int regionEndX = std::min(cullX + cullSize - 1, endX);
+            int regionEndY = std::min(cullY + cullSize - 1, endY);
+            for (int y = std::max(cullY, startY); y <= regionEndY; y += 2) {
+                int32_t blockValue[3];
+                for (int i = 0; i < 3; i++) {
+                    blockValue[i] = (int32_t)(quad.edges.originValue[i]
+                        + ((int64_t)a[i] * (regionStartX - startX) + (int64_t)b[i] * (y - startY)) * RASTER_SUBPIXEL_ONE);
+                }
+                for (int x = regionStartX; x <= regionEndX; x += blockW) {
+                    rasterizationBlock(quad, blockValue, x, y, regionEndX);
+                    for (int i = 0; i < 3; i++) {
+                        blockValue[i] += a[i] * blockW * RASTER_SUBPIXEL_ONE;
+                    }
                 }
             }
-#ifdef RASTER_MULTI_THREAD
-                });
-#endif
+            if (cullDepth) {
+                depthPyramid_.refreshBlock(cullX >> DepthPyramidSoft::BLOCK_SHIFT, cullY >> DepthPyramidSoft::BLOCK_SHIFT);
+            }
         }
     }
 }
 
-/*执行像素四边形光栅化处理 ，处理流程包含：覆盖测试、深度插值、Early Z测试、变量插值和片段着色*/
-void RendererSoft::rasterizationPixelQuad(PixelQuadContext& quad) {
+/*光栅化一个边函数求值块：无MSAA时为4x2像素，MSAA时为2x2像素，(x, y)为块左上角，只处理不超过endX的像素*/
+void RendererSoft::rasterizationBlock(PixelQuadContext& quad, const int32_t* blockValue, int x, int y, int endX) {
+    const bool multiSample = rasterSamples_ > 1;
+    const int blockW = multiSample ? 2 : 4;
+    const int sampleLanes = 4 * rasterSamples_; // 多重采样时采样点占用的lane数，之后4个lane为像素中心
+
+    uint64_t mask = simd_->edgeCoverage(quad.edges, blockValue, quad.edgeLaneOffset, quad.laneBarycentric,
+                                        RasterLaneCount(rasterSamples_));
+    for (int q = 0; q < blockW / 2 && mask != 0; q++) {
+        int qx = x + q * 2;
+        if (qx > endX) {
+            break;
+        }
+        // 只要有一个采样点被覆盖就需要处理整个2x2像素块（导数计算需要全部4个像素）
+        uint64_t quadMask = multiSample ? (mask & ((1ull << sampleLanes) - 1)) : ((mask >> (q * 4)) & 0xF);
+        if (quadMask == 0) {
+            continue;
+        }
 
-    glm::aligned_vec4* vert = quad.vertPosFlat;
-    glm::aligned_vec4& v0 = quad.vertPos[0];
+        quad.Init((float)qx, (float)y, rasterSamples_);
+        for (int p = 0; p < 4; p++) {
+            auto& pixel = quad.pixels[p];
+            if (multiSample) {
+                for (int s = 0; s <= rasterSamples_; s++) {
+                    int lane = s < rasterSamples_ ? p * rasterSamples_ + s : sampleLanes + p;
+                    auto& sample = pixel.samples[s];
+                    sample.inside = (mask >> lane) & 1;
+                    sample.barycentric = { quad.laneBarycentric[0][lane], quad.laneBarycentric[1][lane],
+                                           quad.laneBarycentric[2][lane], 0.f };
+                }
+            }
+            else {
+                int lane = q * 4 + p;
+                auto& sample = pixel.samples[0];
+                sample.inside = (mask >> lane) & 1;
+                sample.barycentric = { quad.laneBarycentric[0][lane], quad.laneBarycentric[1][lane],
+                                       quad.laneBarycentric[2][lane], 0.f };
+            }
+            pixel.InitCoverage();
+            pixel.InitShadingSample();
+        }
+        (this->*rasterPixelQuad_)(quad);
+    }
+}
 
-    // -----------------------------重心坐标计算与覆盖测试----------------------------------
-    for (auto& pixel : quad.pixels) {
-        for (auto& sample : pixel.samples) {
-            sample.inside = barycentric(vert, v0, sample.position, sample.barycentric);
+/*8x8区域的整块剔除：区域内没有采样点被覆盖，或三角形在区域内的深度范围一定无法通过深度测试时返回false*/
+bool RendererSoft::rasterizationBlockVisible(PixelQuadContext& quad, int blockX, int blockY, int startX, int startY,
+                                             bool cullDepth, float triZMin, float triZMax) {
+    auto& edges = quad.edges;
+    const int size = DepthPyramidSoft::BLOCK_SIZE;
+
+    // 边函数是线性的，区域内的最值出现在四个角点上
+    int64_t cornerValue[3][4];
+    for (int i = 0; i < 3; i++) {
+        int64_t maxValue = std::numeric_limits<int64_t>::min();
+        for (int c = 0; c < 4; c++) {
+            int cx = blockX + (c & 1) * size - startX;
+            int cy = blockY + (c >> 1) * size - startY;
+            cornerValue[i][c] = edges.originValue[i] + ((int64_t)edges.a[i] * cx + (int64_t)edges.b[i] * cy) * RASTER_SUBPIXEL_ONE;
+            maxValue = std::max(maxValue, cornerValue[i][c]);
+        }
+        if (maxValue <= edges.threshold[i]) {
+            return false;
         }
-        pixel.InitCoverage();
-        pixel.InitShadingSample();
     }
-    if (!quad.CheckInside()) {
-        return;
+
+    if (!cullDepth) {
+        return true;
     }
 
-    // ------------------------------深度值插值与裁剪------------------------------------------
-    for (auto& pixel : quad.pixels) {
-        for (auto& sample : pixel.samples) {
-            if (!sample.inside) {
-                continue;
-            }
+    // 深度在屏幕空间线性，由角点处的重心坐标求出三角形平面在区域内的深度范围
+    float zMin = std::numeric_limits<float>::max();
+    float zMax = -std::numeric_limits<float>::max();
+    for (int c = 0; c < 4; c++) {
+        double z = 0.0;
+        for (int i = 0; i < 3; i++) {
+            z += (double)cornerValue[i][c] * *quad.vertZ[i];
+        }
+        z *= edges.invArea;
+        zMin = std::min(zMin, (float)z);
+        zMax = std::max(zMax, (float)z);
+    }
+    // 覆盖的采样点深度是顶点深度的凸组合
+    zMin = std::max(zMin, triZMin);
+    zMax = std::min(zMax, triZMax);
+
+    float blockZMin, blockZMax;
+    depthPyramid_.getBlockRange(blockX >> DepthPyramidSoft::BLOCK_SHIFT, blockY >> DepthPyramidSoft::BLOCK_SHIFT,
+                                blockZMin, blockZMax);
+    return !depthRangeOccluded(zMin, zMax, blockZMin, blockZMax);
+}
 
-            // interpolate z, w
-            interpolateBarycentric(&sample.position.z, quad.vertZ, 2, sample.barycentric);
+/*片元深度范围[zMin, zMax]与深度缓冲中范围为[dMin, dMax]的区域比较，所有片元一定无法通过深度测试时返回true*/
+bool RendererSoft::depthRangeOccluded(float zMin, float zMax, float dMin, float dMax) {
+    // 插值存在舍入误差，放宽片元深度范围以保证剔除是保守的；深度测试前片元深度会被限制在视口深度范围内
+    const float margin = 1e-5f;
+    zMin = glm::clamp(zMin - margin, viewport_.absMinDepth, viewport_.absMaxDepth);
+    zMax = glm::clamp(zMax + margin, viewport_.absMinDepth, viewport_.absMaxDepth);
+    return DepthPyramidSoft::rejectRange(zMin, zMax, dMin, dMax, renderState_->depthFunc);
+}
 
-            // 深度裁剪
-            if (sample.position.z < viewport_.absMinDepth || sample.position.z > viewport_.absMaxDepth) {
-                sample.inside = false;
+/*建立三角形的定点数边函数，以(startX, startY)为原点，返回false表示区域内边函数值超出int32安全范围*/
+bool RendererSoft::rasterizationSetupEdges(PixelQuadContext& quad, int startX, int startY, int endX, int endY) {
+    // 顶点坐标超出此范围时定点数系数可能溢出（也能排除NaN）
+    const float maxCoord = (float)(1 << 16);
+    const int64_t maxValue = (int64_t)1 << 30;
+
+    int64_t px[3], py[3];
+    for (int i = 0; i < 3; i++) {
+        if (!(std::abs(quad.vertPos[i].x) < maxCoord && std::abs(quad.vertPos[i].y) < maxCoord)) {
+            return false;
+        }
+        px[i] = std::llround(quad.vertPos[i].x * RASTER_SUBPIXEL_ONE);
+        py[i] = std::llround(quad.vertPos[i].y * RASTER_SUBPIXEL_ONE);
+    }
+
+    // 边i为顶点i的对边 (i+1)->(i+2)，E_i在顶点i处的值即为三角形面积的两倍
+    int64_t a[3], b[3], c[3];
+    for (int i = 0; i < 3; i++) {
+        int i0 = (i + 1) % 3;
+        int i1 = (i + 2) % 3;
+        a[i] = py[i0] - py[i1];
+        b[i] = px[i1] - px[i0];
+        c[i] = px[i0] * py[i1] - px[i1] * py[i0];
+    }
+    int64_t area2 = c[0] + c[1] + c[2];
+
+    auto& edges = quad.edges;
+    edges.degenerate = (area2 == 0);
+    if (edges.degenerate) {
+        return true;
+    }
+
+    // 统一为三角形内部边函数为正（正反面均使用同一套覆盖规则）
+    if (area2 < 0) {
+        for (int i = 0; i < 3; i++) {
+            a[i] = -a[i];
+            b[i] = -b[i];
+            c[i] = -c[i];
+        }
+        area2 = -area2;
+    }
+
+    // 线性函数在矩形区域内的最值出现在角点，检查遍历过程中所有lane的边函数值不会溢出
+    const int64_t x0 = (int64_t)startX * RASTER_SUBPIXEL_ONE;
+    const int64_t y0 = (int64_t)startY * RASTER_SUBPIXEL_ONE;
+    const int64_t x1 = (int64_t)(endX + 4) * RASTER_SUBPIXEL_ONE;
+    const int64_t y1 = (int64_t)(endY + 2) * RASTER_SUBPIXEL_ONE;
+    for (int i = 0; i < 3; i++) {
+        int64_t corners[4] = {
+            a[i] * x0 + b[i] * y0 + c[i],
+            a[i] * x1 + b[i] * y0 + c[i],
+            a[i] * x0 + b[i] * y1 + c[i],
+            a[i] * x1 + b[i] * y1 + c[i],
+        };
+        for (int64_t value : corners) {
+            if (std::abs(value) >= maxValue) {
+                return false;
             }
+        }
+    }
 
-            // 透视校正：调整重心坐标（用于后续变量插值）
-            sample.barycentric *= (1.f / sample.position.w * quad.vertW);
+    for (int i = 0; i < 3; i++) {
+        edges.a[i] = (int32_t)a[i];
+        edges.b[i] = (int32_t)b[i];
+        edges.originValue[i] = (int32_t)(a[i] * x0 + b[i] * y0 + c[i]);
+        // top-left规则：左边（a > 0）和上边（a == 0 && b > 0）上的采样点属于该三角形，共享边只会被光栅化一次
+        edges.threshold[i] = (a[i] > 0 || (a[i] == 0 && b[i] > 0)) ? -1 : 0;
+    }
+    edges.invArea = 1.f / (float)area2;
+
+    // 每个lane的采样位置（相对像素块原点，单位1/16像素），与PixelContext::Init中的采样点一一对应
+    int laneX[RASTER_MAX_LANES] = { 0 };
+    int laneY[RASTER_MAX_LANES] = { 0 };
+    const int half = RASTER_SUBPIXEL_ONE / 2;
+    if (rasterSamples_ > 1) {
+        const int sampleCnt = rasterSamples_;
+        glm::vec2* location = PixelContext::GetSampleLocation(sampleCnt);
+        for (int p = 0; p < 4; p++) {
+            int pixelX = (p & 1) * RASTER_SUBPIXEL_ONE;
+            int pixelY = (p >> 1) * RASTER_SUBPIXEL_ONE;
+            for (int s = 0; s < sampleCnt; s++) {
+                laneX[p * sampleCnt + s] = pixelX + (int)(location[s].x * RASTER_SUBPIXEL_ONE);
+                laneY[p * sampleCnt + s] = pixelY + (int)(location[s].y * RASTER_SUBPIXEL_ONE);
+            }
+            laneX[4 * sampleCnt + p] = pixelX + half;
+            laneY[4 * sampleCnt + p] = pixelY + half;
+        }
+        // 补齐到8的倍数的lane为空位，结果不会被读取
+    }
+    else {
+        for (int lane = 0; lane < 8; lane++) {
+            int q = lane / 4;
+            int p = lane % 4;
+            laneX[lane] = (q * 2 + (p & 1)) * RASTER_SUBPIXEL_ONE + half;
+            laneY[lane] = (p >> 1) * RASTER_SUBPIXEL_ONE + half;
         }
     }
+    for (int i = 0; i < 3; i++) {
+        for (int lane = 0; lane < RASTER_MAX_LANES; lane++) {
+            quad.edgeLaneOffset[i][lane] = edges.a[i] * laneX[lane] + edges.b[i] * laneY[lane];
+        }
+    }
+    return true;
+}
+
+/*执行像素四边形光栅化处理 ，处理流程包含：深度插值、Early Z测试、变量插值和片段着色，调用前需已完成覆盖测试与重心坐标计算*/
+void RendererSoft::rasterizationPixelQuad(PixelQuadContext& quad) {
+    if (!quad.CheckInside()) {
+        return;
+    }
+
+    interpolatePixelQuadDepth(quad);
 
     // early z
     if (earlyZ_ && renderState_->depthTest) {
@@ -896,23 +1470,17 @@ void RendererSoft::rasterizationPixelQuad(PixelQuadContext& quad) {
         }
     }
 
-    // 变量插值（用于片段着色）
-    // note: all quad pixels should perform varying interpolate to enable varying partial derivative
-    for (auto& pixel : quad.pixels) {
-        interpolateBarycentric((float*)pixel.varyingsFrag, quad.vertVaryings, varyingsCnt_, pixel.sampleShading->barycentric);
-    }
+    shadingPixelQuad(quad);
 
     //-------------------------------------- 片段着色与逐采样点操作----------------------------------------------
-    for (auto& pixel : quad.pixels) {
+    for (int i = 0; i < 4; i++) {
+        auto& pixel = quad.pixels[i];
         if (!pixel.inside) {
             continue;
         }
 
-        // fragment shader
-        processFragmentShader(pixel.sampleShading->position, quad.frontFacing, pixel.varyingsFrag, quad.shaderProgram.get());
-
-        // 获取着色器输出颜色
-        auto& builtIn = quad.shaderProgram->getShaderBuiltin();
+        // fragment shader，获取着色器输出颜色
+        const glm::vec4& fragColor = shadingPixel(quad, i);
 
         // 处理每个采样点（MSAA）或主采样点（非MSAA）
         if (pixel.sampleCount > 1) {
@@ -921,16 +1489,103 @@ void RendererSoft::rasterizationPixelQuad(PixelQuadContext& quad) {
                 if (!sample.inside) {
                     continue;
                 }
-                processPerSampleOperations(sample.fboCoord.x, sample.fboCoord.y, sample.position.z, builtIn.FragColor, idx);
+                processPerSampleOperations(sample.fboCoord.x, sample.fboCoord.y, sample.position.z, fragColor, idx);
             }
         }   
         else {
             auto& sample = *pixel.sampleShading;
-            processPerSampleOperations(sample.fboCoord.x, sample.fboCoord.y, sample.position.z, builtIn.FragColor, 0);
+            processPerSampleOperations(sample.fboCoord.x, sample.fboCoord.y, sample.position.z, fragColor, 0);
+        }
+    }
+}
+
+/*按编译期管线状态特化的像素块处理，流程与rasterizationPixelQuad一致。
+  深度测试只在early z中做一次（同一像素块在early z与写入之间不会被其他三角形修改），逐采样点阶段直接写入*/
+template<typename State>
+void RendererSoft::rasterizationPixelQuadKernel(PixelQuadContext& quad) {
+    if (!quad.CheckInside()) {
+        return;
+    }
+
+    interpolatePixelQuadDepth(quad);
+
+    if constexpr (State::depthTest) {
+        if (!earlyZTestKernel<State>(quad)) {
+            return;
+        }
+    }
+
+    // 只写深度时（如阴影贴图）不需要插值varyings和执行片段着色器
+    if constexpr (State::colorWrite) {
+        shadingPixelQuad(quad);
+    }
+
+    for (int i = 0; i < 4; i++) {
+        auto& pixel = quad.pixels[i];
+        if (!pixel.inside) {
+            continue;
+        }
+
+        const glm::vec4* fragColor = nullptr;
+        if constexpr (State::colorWrite) {
+            fragColor = &shadingPixel(quad, i);
+        }
+
+        if constexpr (State::multiSample) {
+            processPixelSamplesKernel<State>(pixel, fragColor);
+        }
+        else {
+            auto& sample = *pixel.sampleShading;
+            processPerSampleKernel<State>(sample.fboCoord.x, sample.fboCoord.y, sample.position.z, fragColor, 0);
+        }
+    }
+}
+
+/*插值像素块所有覆盖采样点的深度，裁剪超出深度范围的采样点，并对重心坐标做透视校正*/
+void RendererSoft::interpolatePixelQuadDepth(PixelQuadContext& quad) {
+    for (auto& pixel : quad.pixels) {
+        for (auto& sample : pixel.samples) {
+            if (!sample.inside) {
+                continue;
+            }
+
+            // interpolate z, w
+            interpolateBarycentric(&sample.position.z, quad.vertZ, 2, sample.barycentric);
+
+            // 深度裁剪
+            if (sample.position.z < viewport_.absMinDepth || sample.position.z > viewport_.absMaxDepth) {
+                sample.inside = false;
+            }
+
+            // 透视校正：调整重心坐标（用于后续变量插值）
+            sample.barycentric *= (1.f / sample.position.w * quad.vertW);
         }
     }
 }
 
+/*插值像素块的varyings，着色器支持时打包执行片段着色器*/
+void RendererSoft::shadingPixelQuad(PixelQuadContext& quad) {
+    // note: all quad pixels should perform varying interpolate to enable varying partial derivative
+    for (auto& pixel : quad.pixels) {
+        interpolateBarycentric((float*)pixel.varyingsFrag, quad.vertVaryings, varyingsCnt_, pixel.sampleShading->barycentric);
+    }
+
+    if (quad.quadShading) {
+        processFragmentShaderQuad(quad);
+    }
+}
+
+/*获取像素块中第idx个像素的着色结果，未打包执行时在这里逐像素执行片段着色器*/
+const glm::vec4& RendererSoft::shadingPixel(PixelQuadContext& quad, int idx) {
+    if (quad.quadShading) {
+        return quad.shaderQuad.fragColor[idx];
+    }
+
+    auto& pixel = quad.pixels[idx];
+    processFragmentShader(pixel.sampleShading->position, quad.frontFacing, pixel.varyingsFrag, quad.shaderProgram.get());
+    return quad.shaderProgram->getShaderBuiltin().FragColor;
+}
+
 /* 执行early_z，提前剔除被遮挡的像素*/
 bool RendererSoft::earlyZTest(PixelQuadContext& quad) {
     // 遍历四边形中的每个像素
@@ -961,35 +1616,211 @@ bool RendererSoft::earlyZTest(PixelQuadContext& quad) {
     return quad.CheckInside();
 }
 
-/*多重采样抗锯齿(MSAA)解析函数 ，将多重采样缓冲区(MSAA)解析为单采样颜色缓冲区*/
+/* 特化版本的early z，深度比较函数与采样数在编译期确定*/
+template<typename State>
+bool RendererSoft::earlyZTestKernel(PixelQuadContext& quad) {
+    for (auto& pixel : quad.pixels) {
+        if (!pixel.inside) {
+            continue;
+        }
+        if constexpr (State::multiSample) {
+            bool inside = false;
+            for (int idx = 0; idx < pixel.sampleCount; idx++) {
+                auto& sample = pixel.samples[idx];
+                if (!sample.inside) {
+                    continue;
+                }
+                sample.inside = depthTestKernel<State>(sample.fboCoord.x, sample.fboCoord.y, sample.position.z, idx);
+                inside = inside || sample.inside;
+            }
+            pixel.inside = inside;
+        }
+        else {
+            auto& sample = *pixel.sampleShading;
+            sample.inside = depthTestKernel<State>(sample.fboCoord.x, sample.fboCoord.y, sample.position.z, 0);
+            pixel.inside = sample.inside;
+        }
+    }
+    return quad.CheckInside();
+}
+
+template<typename State>
+bool RendererSoft::depthTestKernel(int x, int y, float depth, int sample) {
+    float* zPtr = getFrameDepthKernel<State>(x, y, sample);
+    depth = glm::clamp(depth, viewport_.absMinDepth, viewport_.absMaxDepth);
+    return zPtr && DepthTest<State::depthFunc>(depth, *zPtr);
+}
+
+/*特化版本的逐采样点操作，调用前已通过深度测试：写入深度、混合并写入颜色*/
+template<typename State>
+void RendererSoft::processPerSampleKernel(int x, int y, float depth, const glm::vec4* color, int sample) {
+    if constexpr (State::depthWrite) {
+        writeDepthKernel<State>(x, y, depth, sample);
+    }
+
+    if constexpr (State::colorWrite) {
+        RGBA* ptr = fboColor_->buffer->get(x, y);
+        if (!ptr) {
+            return;
+        }
+        storeColorKernel<State>(*color, ptr);
+    }
+}
+
+/*特化版本的多重采样像素写入，调用前已通过深度测试。颜色缓冲开启采样点压缩时，
+  所有采样点都被覆盖的像素只写入第一个采样点并标记为压缩，部分覆盖的像素先展开再逐采样点写入*/
+template<typename State>
+void RendererSoft::processPixelSamplesKernel(PixelContext& pixel, const glm::vec4* color) {
+    const int x = pixel.samples[0].fboCoord.x;
+    const int y = pixel.samples[0].fboCoord.y;
+    int covered = 0;
+    for (int idx = 0; idx < pixel.sampleCount; idx++) {
+        auto& sample = pixel.samples[idx];
+        if (!sample.inside) {
+            continue;
+        }
+        covered++;
+        if constexpr (State::depthWrite) {
+            writeDepthKernel<State>(x, y, sample.position.z, idx);
+        }
+    }
+
+    if constexpr (State::colorWrite) {
+        if (covered == pixel.sampleCount && fboColor_->hasSampleCompression()) {
+            RGBA* ptr = fboColor_->getSamples(x, y);
+            if (!ptr) {
+                return;
+            }
+            // 混合时只有原本已压缩的像素（所有采样点的dst相同）混合后仍然相同
+            if (!State::blendAlpha || fboColor_->isSampleUniform(x, y)) {
+                storeColorKernel<State>(*color, ptr);
+                fboColor_->setSampleUniform(x, y);
+                return;
+            }
+        }
+
+        RGBA* ptr = fboColor_->expandSamples(x, y);
+        if (!ptr) {
+            return;
+        }
+        for (int idx = 0; idx < pixel.sampleCount; idx++) {
+            if (pixel.samples[idx].inside) {
+                storeColorKernel<State>(*color, ptr + idx);
+            }
+        }
+    }
+}
+
+template<typename State>
+void RendererSoft::writeDepthKernel(int x, int y, float depth, int sample) {
+    float* zPtr = getFrameDepthKernel<State>(x, y, sample);
+    if (zPtr) {
+        depth = glm::clamp(depth, viewport_.absMinDepth, viewport_.absMaxDepth);
+        *zPtr = depth;
+        depthPyramid_.onDepthWrite(x, y, depth);
+    }
+}
+
+template<typename State>
+void RendererSoft::storeColorKernel(const glm::vec4& color, RGBA* ptr) {
+    if constexpr (State::blendAlpha) {
+        simd_->storeColorBlendAlpha(color, ptr);
+    }
+    else {
+        simd_->storeColor(color, ptr);
+    }
+}
+
+template<typename State>
+float* RendererSoft::getFrameDepthKernel(int x, int y, int sample) {
+    if constexpr (State::multiSample) {
+        float* ptr = fboDepth_->getSamples(x, y);
+        return ptr ? ptr + sample : nullptr;
+    }
+    else {
+        return fboDepth_->buffer->get(x, y);
+    }
+}
+
+/*根据当前draw的管线状态选择光栅化像素块的实现，特化版本未覆盖的状态使用通用的rasterizationPixelQuad*/
+RendererSoft::RasterQuadFunc RendererSoft::selectRasterKernel() {
+    const RasterQuadFunc generic = &RendererSoft::rasterizationPixelQuad;
+    if (!rasterKernels_) {
+        return generic;
+    }
+
+    // 特化版本假设颜色与深度附件的采样数一致
+    if ((fboColor_ && fboColor_->sampleCnt != rasterSamples_) || (fboDepth_ && fboDepth_->sampleCnt != rasterSamples_)) {
+        return generic;
+    }
+
+    if (renderState_->blend && !isBlendAlpha(renderState_->blendParams)) {
+        return generic;
+    }
+
+    if (!renderState_->depthTest || !fboDepth_) {
+        return selectRasterKernelColor<false, DepthFunc_ALWAYS, false>();
+    }
+
+    // 特化版本在early z阶段完成深度测试
+    if (!earlyZ_) {
+        return generic;
+    }
+
+    switch (renderState_->depthFunc) {
+        case DepthFunc_LESS:    return selectRasterKernelDepthWrite<DepthFunc_LESS>();
+        case DepthFunc_LEQUAL:  return selectRasterKernelDepthWrite<DepthFunc_LEQUAL>();
+        case DepthFunc_GREATER: return selectRasterKernelDepthWrite<DepthFunc_GREATER>();
+        case DepthFunc_GEQUAL:  return selectRasterKernelDepthWrite<DepthFunc_GEQUAL>();
+        default:
+            break;
+    }
+    return generic;
+}
+
+template<DepthFunction DepthFn>
+RendererSoft::RasterQuadFunc RendererSoft::selectRasterKernelDepthWrite() {
+    if (renderState_->depthMask) {
+        return selectRasterKernelColor<true, DepthFn, true>();
+    }
+    return selectRasterKernelColor<true, DepthFn, false>();
+}
+
+template<bool DepthTest, DepthFunction DepthFn, bool DepthWrite>
+RendererSoft::RasterQuadFunc RendererSoft::selectRasterKernelColor() {
+    if (!fboColor_) {
+        return selectRasterKernelSamples<DepthTest, DepthFn, DepthWrite, false, false>();
+    }
+    if (renderState_->blend) {
+        return selectRasterKernelSamples<DepthTest, DepthFn, DepthWrite, true, true>();
+    }
+    return selectRasterKernelSamples<DepthTest, DepthFn, DepthWrite, true, false>();
+}
+
+template<bool DepthTest, DepthFunction DepthFn, bool DepthWrite, bool ColorWrite, bool BlendAlpha>
+RendererSoft::RasterQuadFunc RendererSoft::selectRasterKernelSamples() {
+    if (rasterSamples_ > 1) {
+        return &RendererSoft::rasterizationPixelQuadKernel<RasterKernelState<DepthTest, DepthFn, DepthWrite, ColorWrite, BlendAlpha, true>>;
+    }
+    return &RendererSoft::rasterizationPixelQuadKernel<RasterKernelState<DepthTest, DepthFn, DepthWrite, ColorWrite, BlendAlpha, false>>;
+}
+
+/*多重采样抗锯齿(MSAA)解析函数 ，将多重采样缓冲区(MSAA)解析为单采样颜色缓冲区，每个任务处理一行tile*/
 void RendererSoft::multiSampleResolve() {
     if (!fboColor_->buffer) {
         fboColor_->buffer = Buffer<RGBA>::makeDefault(fboColor_->width, fboColor_->height);
     }
 
-    auto* srcPtr = fboColor_->bufferMs4x->getRawDataPtr();  // MSAA源数据指针
     auto* dstPtr = fboColor_->buffer->getRawDataPtr();      // 目标单采样缓冲区指针
 
-    // ----------------------------遍历所有像素行------------------------
-    for (size_t row = 0; row < fboColor_->height; row++) {
-        // 计算当前行的起始指针
-        auto* rowSrc = srcPtr + row * fboColor_->width;
-        auto* rowDst = dstPtr + row * fboColor_->width;
+    // ----------------------------按tile行遍历所有像素行------------------------
+    for (int rowStart = 0; rowStart < fboColor_->height; rowStart += rasterBlockSize_) {
+        int rowEnd = std::min(rowStart + rasterBlockSize_, fboColor_->height);
 #ifdef RASTER_MULTI_THREAD
-        threadPool_.pushTask([&, rowSrc, rowDst](int thread_id) {
+        threadPool_.pushTask([&, dstPtr, rowStart, rowEnd](int thread_id) {
 #endif
-            // 处理当前行的每个像素
-            auto* src = rowSrc; 
-            auto* dst = rowDst;
-            for (size_t idx = 0; idx < fboColor_->width; idx++) {
-                glm::vec4 color(0.f);
-                for (int i = 0; i < fboColor_->sampleCnt; i++) {
-                    color += (glm::vec4)(*src)[i];
-                }
-                color /= fboColor_->sampleCnt;
-                *dst = color;
-                src++;
-                dst++;
+            for (int row = rowStart; row < rowEnd; row++) {
+                multiSampleResolveRow(fboColor_->getSamplesRow(row), dstPtr + (size_t)row * fboColor_->width, row);
             }
 #ifdef RASTER_MULTI_THREAD
             });
@@ -999,6 +1830,83 @@ void RendererSoft::multiSampleResolve() {
     threadPool_.waitTasksFinish();
 }
 
+/*解析一行像素，待清除的tile所有采样点都是清除值，解析结果直接写入清除值*/
+void RendererSoft::multiSampleResolveRow(const RGBA* src, RGBA* dst, int row) {
+    size_t width = fboColor_->width;
+    if (!fboColor_->hasClearTiles()) {
+        multiSampleResolveSpan(src, dst, row, 0, width);
+        return;
+    }
+
+    // 按是否待清除把一行分成若干段，每段包含连续的tile
+    int tileSize = fboColor_->getClearTileSize();
+    int tileY = row / tileSize;
+    int tileCnt = ((int)width + tileSize - 1) / tileSize;
+    int tileX = 0;
+    while (tileX < tileCnt) {
+        bool cleared = fboColor_->isTileCleared(tileX, tileY);
+        int endX = tileX + 1;
+        while (endX < tileCnt && fboColor_->isTileCleared(endX, tileY) == cleared) {
+            endX++;
+        }
+        size_t x = (size_t)tileX * tileSize;
+        size_t cnt = std::min((size_t)endX * tileSize, width) - x;
+        if (cleared) {
+            MemoryUtils::fill(dst + x, cnt, fboColor_->getClearValue(), true);
+        }
+        else {
+            multiSampleResolveSpan(src, dst, row, x, cnt);
+        }
+        tileX = endX;
+    }
+    MemoryUtils::streamFence();
+}
+
+/*解析一行中[x, x + cnt)范围的像素：压缩的像素直接复制第一个采样点，其余像素对所有采样点取平均*/
+void RendererSoft::multiSampleResolveSpan(const RGBA* src, RGBA* dst, int row, size_t x, size_t cnt) {
+    const int sampleCnt = fboColor_->sampleCnt;
+    const uint8_t* uniform = fboColor_->getSampleUniformRow(row);
+    const size_t end = x + cnt;
+    if (!uniform) {
+        resolveSamples(src + x * sampleCnt, dst + x, cnt, sampleCnt);
+        return;
+    }
+
+    while (x < end) {
+        // 连续的压缩/未压缩像素合并处理
+        uint8_t flag = uniform[x];
+        size_t runEnd = x + 1;
+        while (runEnd < end && uniform[runEnd] == flag) {
+            runEnd++;
+        }
+        if (flag) {
+            for (size_t idx = x; idx < runEnd; idx++) {
+                dst[idx] = src[idx * sampleCnt];
+            }
+        }
+        else {
+            resolveSamples(src + x * sampleCnt, dst + x, runEnd - x, sampleCnt);
+        }
+        x = runEnd;
+    }
+}
+
+/*对count个像素的采样点取平均，结果向下取整，与4x的SIMD实现一致*/
+void RendererSoft::resolveSamples(const RGBA* src, RGBA* dst, size_t count, int sampleCnt) {
+    if (sampleCnt == 4) {
+        simd_->resolveColor4x((const glm::tvec4<RGBA>*)src, dst, count);
+        return;
+    }
+    for (size_t idx = 0; idx < count; idx++) {
+        const RGBA* samples = src + idx * sampleCnt;
+        glm::uvec4 sum(0);
+        for (int s = 0; s < sampleCnt; s++) {
+            sum += glm::uvec4(samples[s]);
+        }
+        dst[idx] = RGBA(sum / (uint32_t)sampleCnt);
+    }
+}
+
 // 获取帧缓冲区指定像素位置的颜色指针，sample表示像素的第几个采样点，0表示主采样
 RGBA* RendererSoft::getFrameColor(int x, int y, int sample) {
     if (!fboColor_) {
@@ -1007,9 +1915,10 @@ RGBA* RendererSoft::getFrameColor(int x, int y, int sample) {
 
     RGBA* ptr = nullptr;
     if (fboColor_->multiSample) {
-        auto* ptrMs = fboColor_->bufferMs4x->get(x, y);
+        // 单独访问采样点前需要展开压缩的像素
+        RGBA* ptrMs = fboColor_->expandSamples(x, y);
         if (ptrMs) {
-            ptr = (RGBA*)ptrMs + sample;
+            ptr = ptrMs + sample;
         }
     }
     else {
@@ -1026,9 +1935,9 @@ float* RendererSoft::getFrameDepth(int x, int y, int sample) {
 
     float* depthPtr = nullptr;
     if (fboDepth_->multiSample) {
-        auto* ptr = fboDepth_->bufferMs4x->get(x, y);
+        float* ptr = fboDepth_->getSamples(x, y);
         if (ptr) {
-            depthPtr = &ptr->x + sample;
+            depthPtr = ptr + sample;
         }
     }
     else {
@@ -1046,12 +1955,62 @@ void RendererSoft::setFrameColor(int x, int y, const RGBA& color, int sample) {
     }
 }
 
-/*在裁剪过程中生成新的顶点*/
+/*初始化每个线程的上下文，绑定该线程的着色器程序副本（保证线程安全），顶点着色和光栅化阶段共用*/
+void RendererSoft::initThreadContexts() {
+    threadQuadCtx_.resize(std::max<size_t>(1, threadPool_.getThreadCnt())); // 没有工作线程时任务在当前线程以编号0执行
+    auto& programs = getThreadPrograms(threadQuadCtx_.size());
+    for (size_t i = 0; i < threadQuadCtx_.size(); i++) {
+        auto& ctx = threadQuadCtx_[i];
+        ctx.SetVaryingsSize(MemoryUtils::alignedSize(shaderProgram_->getShaderVaryingsSize()) / sizeof(float));
+        ctx.shaderProgram = programs[i];
+        ctx.quadShading = quadShading_ && ctx.shaderProgram->supportQuadShading();
+
+        // 设置导数计算上下文（用于ddx/ddy指令），varyings内存可能随程序切换重新分配，每次draw都需要更新
+        DerivativeContext& df_ctx = ctx.shaderProgram->getShaderBuiltin().dfCtx;
+        df_ctx.p0 = ctx.pixels[0].varyingsFrag;
+        df_ctx.p1 = ctx.pixels[1].varyingsFrag;
+        df_ctx.p2 = ctx.pixels[2].varyingsFrag;
+        df_ctx.p3 = ctx.pixels[3].varyingsFrag;
+    }
+}
+
+/*获取当前程序的每线程副本，副本与原程序共享uniform缓冲，只在首次使用或程序重新设置着色器后克隆*/
+std::vector<std::shared_ptr<ShaderProgramSoft>>& RendererSoft::getThreadPrograms(size_t threadCnt) {
+    auto it = threadPrograms_.find(shaderProgram_->getId());
+    if (it != threadPrograms_.end() && !it->second.source.expired()
+        && it->second.version == shaderProgram_->getVersion() && it->second.programs.size() == threadCnt) {
+        return it->second.programs;
+    }
+
+    // 未命中时顺便清理已销毁程序的副本
+    for (auto iter = threadPrograms_.begin(); iter != threadPrograms_.end();) {
+        if (iter->second.source.expired()) {
+            iter = threadPrograms_.erase(iter);
+        }
+        else {
+            ++iter;
+        }
+    }
+
+    auto& entry = threadPrograms_[shaderProgram_->getId()];
+    entry.source = shaderProgramRef_;
+    entry.version = shaderProgram_->getVersion();
+    entry.programs.resize(threadCnt);
+    for (auto& program : entry.programs) {
+        program = shaderProgram_->clone();
+        program->prepareFragmentShader();
+    }
+    return entry.programs;
+}
+
+/*在裁剪过程中生成新的顶点，varyings分配在clipVaryings_中*/
 size_t RendererSoft::clippingNewVertex(size_t idx0, size_t idx1, float t, bool postVertexProcess) {
     vertexes_.emplace_back();
     VertexHolder& vh = vertexes_.back();
     vh.discard = false;
     vh.index = vertexes_.size() - 1;
+    vh.vertex = nullptr; // 不再需要顶点属性
+    vh.varyings = clipVaryings_.Allocate(varyingsAlignedCnt_);
     interpolateVertex(vh, vertexes_[idx0], vertexes_[idx1], t);
 
     if (postVertexProcess) {
@@ -1062,18 +2021,6 @@ size_t RendererSoft::clippingNewVertex(size_t idx0, size_t idx1, float t, bool p
     return vh.index; // 新顶点的索引
 }
 
-/*执行顶点着色器处理，进行mvp变换之类的，转换到裁剪空间*/
-void RendererSoft::vertexShaderImpl(VertexHolder& vertex) {
-    shaderProgram_->bindVertexAttributes(vertex.vertex); // 将原始顶点数据（vertex.vertex）传递给着色器程序
-    shaderProgram_->bindVertexShaderVaryings(vertex.varyings);// 为着色器指定varying变量的输出内存位置
-    shaderProgram_->execVertexShader();
-
-    //-----------------------------------获取着色器输出---------------------------------
-    pointSize_ = shaderProgram_->getShaderBuiltin().PointSize;
-    vertex.clipPos = shaderProgram_->getShaderBuiltin().Position;
-    vertex.clipMask = countFrustumClipMask(vertex.clipPos);
-}
-
 /*执行透视除法*/
 void RendererSoft::perspectiveDivideImpl(VertexHolder& vertex) {
     vertex.fragPos = vertex.clipPos;
@@ -1163,20 +2110,13 @@ bool RendererSoft::barycentric(glm::aligned_vec4* vert, glm::aligned_vec4& v0, g
     return true;
 }
 
-/*顶点插值函数，在两个顶点之间进行插值。 最后调用了顶点着色器执行*/
+/*顶点插值函数，在两个顶点之间对裁剪空间坐标和varyings进行线性插值（裁剪空间中线性插值即为透视正确的结果）*/
 void RendererSoft::interpolateVertex(VertexHolder& out, VertexHolder& v0, VertexHolder& v1, float t) {
-    //--------------------内存分配---------------------------------------
-    out.vertexHolder = MemoryUtils::makeBuffer<uint8_t>(vao_->vertexStride);
-    out.vertex = out.vertexHolder.get();
-    out.varyingsHolder = MemoryUtils::makeAlignedBuffer<float>(varyingsAlignedCnt_);
-    out.varyings = out.varyingsHolder.get();
+    out.clipPos = glm::mix(v0.clipPos, v1.clipPos, t);
+    out.clipMask = countFrustumClipMask(out.clipPos);
 
-    // interpolate vertex (only support float element right now)
-    const float* vertexIn[2] = { (float*)v0.vertex, (float*)v1.vertex };
-    interpolateLinear((float*)out.vertex, vertexIn, vao_->vertexStride / sizeof(float), t);
-
-    // vertex shader
-    vertexShaderImpl(out);
+    const float* varyingsIn[2] = { v0.varyings, v1.varyings };
+    interpolateLinear(out.varyings, varyingsIn, varyingsCnt_, t);
 }
 
 /*线性插值*/
@@ -1203,81 +2143,15 @@ void RendererSoft::interpolateBarycentric(float* varsOut, const float* varsIn[3]
         return;
     }
 
-    bool simd_enabled = false;
-#ifdef SOFTGL_SIMD_OPT
-    // 检查所有输入/输出指针的内存地址是否满足SIMD对齐要求
-    if ((PTR_ADDR(inVar0) % SOFTGL_ALIGNMENT == 0) &&
-        (PTR_ADDR(inVar1) % SOFTGL_ALIGNMENT == 0) &&
-        (PTR_ADDR(inVar2) % SOFTGL_ALIGNMENT == 0) &&
-        (PTR_ADDR(varsOut) % SOFTGL_ALIGNMENT == 0)) {
-        simd_enabled = true;
-    }
-#endif
-
-    if (simd_enabled) {
-        interpolateBarycentricSIMD(varsOut, varsIn, elemCnt, bc);
-    }
-    else {
-        for (int i = 0; i < elemCnt; i++) {
-            varsOut[i] = glm::dot(glm::vec4(bc), glm::vec4(*(inVar0 + i), *(inVar1 + i), *(inVar2 + i), 0.f));
-        }
-    }
-}
-
-/*  elemCnt: 每个顶点的属性元素数量（如RGBA = 4，UV = 2等）
-    bc: 重心坐标（bc[0],bc[1],bc[2]对应三个顶点的权重）*/ 
-void RendererSoft::interpolateBarycentricSIMD(float* varsOut, const float* varsIn[3], size_t elemCnt, glm::aligned_vec4& bc) {
-#ifdef SOFTGL_SIMD_OPT
-    // 解引用输入属性指针（三个顶点的属性数组）
-    const float* inVar0 = varsIn[0];
-    const float* inVar1 = varsIn[1];
-    const float* inVar2 = varsIn[2];
-
-    uint32_t idx = 0;// 当前处理元素索引
-    uint32_t end; // 分段处理结束位置
-
-    //----------------------------第一阶段：AVX-256处理（每次处理8个float）------------------------
-    end = elemCnt & (~7); // 计算能被8整除的最大元素数量（按8对齐）
-    if (end > 0) {
-        // 将重心坐标广播到AVX寄存器（bc0=8个bc[0]，bc1=8个bc[1]，bc2=8个bc[2]）
-        __m256 bc0 = _mm256_set1_ps(bc[0]);
-        __m256 bc1 = _mm256_set1_ps(bc[1]);
-        __m256 bc2 = _mm256_set1_ps(bc[2]);
-
-        // 主循环：每次处理8个元素
-        for (; idx < end; idx += 8) {
-            // 计算 varsOut = varsIn[0]*bc[0] + varsIn[1]*bc[1] + varsIn[2]*bc[2]
-            __m256 sum = _mm256_mul_ps(_mm256_load_ps(inVar0 + idx), bc0);// sum = inVar0 * bc0
-            sum = _mm256_fmadd_ps(_mm256_load_ps(inVar1 + idx), bc1, sum);// sum += inVar1 * bc1
-            sum = _mm256_fmadd_ps(_mm256_load_ps(inVar2 + idx), bc2, sum);// sum += inVar2 * bc2
-            _mm256_store_ps(varsOut + idx, sum);// 存储结果
-        }
-    }
-
-    // -------------------------------第二阶段：SSE处理（每次处理4个float）---------------------------------------
-    // 处理剩余元素（当总元素数不是8的倍数时）
-    end = (elemCnt - idx) & (~3);
-    if (end > 0) {
-        __m128 bc0 = _mm_set1_ps(bc[0]);
-        __m128 bc1 = _mm_set1_ps(bc[1]);
-        __m128 bc2 = _mm_set1_ps(bc[2]);
-
-        for (; idx < end; idx += 4) {
-            __m128 sum = _mm_mul_ps(_mm_load_ps(inVar0 + idx), bc0);
-            sum = _mm_fmadd_ps(_mm_load_ps(inVar1 + idx), bc1, sum);
-            sum = _mm_fmadd_ps(_mm_load_ps(inVar2 + idx), bc2, sum);
-            _mm_store_ps(varsOut + idx, sum);
-        }
+    // SIMD内核要求所有输入/输出指针的内存地址满足对齐要求，否则使用标量版本
+    auto* kernel = simd_;
+    if ((PTR_ADDR(inVar0) % SOFTGL_ALIGNMENT != 0) ||
+        (PTR_ADDR(inVar1) % SOFTGL_ALIGNMENT != 0) ||
+        (PTR_ADDR(inVar2) % SOFTGL_ALIGNMENT != 0) ||
+        (PTR_ADDR(varsOut) % SOFTGL_ALIGNMENT != 0)) {
+        kernel = &SIMDDispatch::kernels(SIMDLevel_SCALAR);
     }
-
-    //----------------------------------第三阶段：标量处理（处理最后1-3个剩余元素）---------------------------------------
-    for (; idx < elemCnt; idx++) {
-        varsOut[idx] = 0;
-        varsOut[idx] += *(inVar0 + idx) * bc[0];
-        varsOut[idx] += *(inVar1 + idx) * bc[1];
-        varsOut[idx] += *(inVar2 + idx) * bc[2];
-    }
-#endif
+    kernel->interpolateBarycentric(varsOut, varsIn, elemCnt, bc);
 }
 
 
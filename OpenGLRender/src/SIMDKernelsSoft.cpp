@@ -0,0 +1,385 @@
+#include "Render/Software/SIMDKernelsSoft.h"
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include "Base/Logger.h"
+#include "Base/SIMD.h"
+
+// 工程以基础x86-64指令集编译，SSE4.1及以上的内核逐函数指定目标指令集，只在CPU支持时通过分发表调用。
+// MSVC不需要编译选项即可使用各级intrinsics
+#if defined(__GNUC__) || defined(__clang__)
+#define SOFTGL_TARGET_SSE41 __attribute__((target("sse4.1")))
+#define SOFTGL_TARGET_AVX2 __attribute__((target("avx2,fma")))
+#define SOFTGL_TARGET_AVX512 __attribute__((target("avx512f,avx512bw,avx2,fma")))
+#else
+#define SOFTGL_TARGET_SSE41
+#define SOFTGL_TARGET_AVX2
+#define SOFTGL_TARGET_AVX512
+#endif
+
+namespace OpenGL {
+
+/*******************************  标量  *********************************/
+static void interpolateBarycentricScalar(float* varsOut, const float* varsIn[3], size_t elemCnt, const glm::aligned_vec4& bc) {
+    const float* inVar0 = varsIn[0];
+    const float* inVar1 = varsIn[1];
+    const float* inVar2 = varsIn[2];
+    for (size_t i = 0; i < elemCnt; i++) {
+        varsOut[i] = glm::dot(glm::vec4(bc), glm::vec4(inVar0[i], inVar1[i], inVar2[i], 0.f));
+    }
+}
+
+static uint64_t edgeCoverageScalar(const EdgeFunctions& edges, const int32_t* blockValue,
+                                   const int32_t (*laneOffset)[RASTER_MAX_LANES], float (*laneBarycentric)[RASTER_MAX_LANES],
+                                   int laneCnt) {
+    uint64_t mask = 0;
+    for (int lane = 0; lane < laneCnt; lane++) {
+        bool inside = true;
+        for (int i = 0; i < 3; i++) {
+            int32_t value = blockValue[i] + laneOffset[i][lane];
+            inside = inside && (value > edges.threshold[i]);
+            laneBarycentric[i][lane] = (float)value * edges.invArea;
+        }
+        if (inside) {
+            mask |= 1ull << lane;
+        }
+    }
+    return mask;
+}
+
+static void storeColorScalar(const glm::vec4& color, RGBA* dst) {
+    *dst = RGBA(glm::clamp(color, 0.f, 1.f) * 255.f);
+}
+
+static void storeColorBlendAlphaScalar(const glm::vec4& color, RGBA* dst) {
+    glm::vec4 src = glm::clamp(color, 0.f, 1.f);
+    glm::vec4 dstColor = glm::vec4(*dst) / 255.f;
+    auto retRgb = glm::vec3(src) * glm::vec3(src.a) + glm::vec3(dstColor) * glm::vec3(1.f - src.a);
+    auto retAlpha = src.a * src.a + dstColor.a * (1.f - src.a);
+    *dst = RGBA(glm::vec4(retRgb, retAlpha) * 255.f);
+}
+
+static void resolveColor4xScalar(const glm::tvec4<RGBA>* src, RGBA* dst, size_t count) {
+    for (size_t idx = 0; idx < count; idx++) {
+        glm::vec4 color(0.f);
+        for (int i = 0; i < 4; i++) {
+            color += (glm::vec4)src[idx][i];
+        }
+        dst[idx] = color / 4.f;
+    }
+}
+
+#ifdef SOFTGL_SIMD_OPT
+/*******************************  SSE4.1  *********************************/
+SOFTGL_TARGET_SSE41
+static void interpolateBarycentricSSE41(float* varsOut, const float* varsIn[3], size_t elemCnt, const glm::aligned_vec4& bc) {
+    const float* inVar0 = varsIn[0];
+    const float* inVar1 = varsIn[1];
+    const float* inVar2 = varsIn[2];
+
+    size_t idx = 0;
+    size_t end = elemCnt & (~3);
+    __m128 bc0 = _mm_set1_ps(bc[0]);
+    __m128 bc1 = _mm_set1_ps(bc[1]);
+    __m128 bc2 = _mm_set1_ps(bc[2]);
+    for (; idx < end; idx += 4) {
+        __m128 sum = _mm_mul_ps(_mm_load_ps(inVar0 + idx), bc0);
+        sum = _mm_add_ps(sum, _mm_mul_ps(_mm_load_ps(inVar1 + idx), bc1));
+        sum = _mm_add_ps(sum, _mm_mul_ps(_mm_load_ps(inVar2 + idx), bc2));
+        _mm_store_ps(varsOut + idx, sum);
+    }
+
+    for (; idx < elemCnt; idx++) {
+        varsOut[idx] = inVar0[idx] * bc[0] + inVar1[idx] * bc[1] + inVar2[idx] * bc[2];
+    }
+}
+
+SOFTGL_TARGET_SSE41
+static uint64_t edgeCoverageSSE41(const EdgeFunctions& edges, const int32_t* blockValue,
+                                  const int32_t (*laneOffset)[RASTER_MAX_LANES], float (*laneBarycentric)[RASTER_MAX_LANES],
+                                  int laneCnt) {
+    uint64_t mask = 0;
+    __m128 invArea = _mm_set1_ps(edges.invArea);
+    for (int lane = 0; lane < laneCnt; lane += 4) {
+        __m128i inside = _mm_set1_epi32(-1);
+        for (int i = 0; i < 3; i++) {
+            __m128i offset = _mm_load_si128((const __m128i*)&laneOffset[i][lane]);
+            __m128i value = _mm_add_epi32(_mm_set1_epi32(blockValue[i]), offset);
+            inside = _mm_and_si128(inside, _mm_cmpgt_epi32(value, _mm_set1_epi32(edges.threshold[i])));
+            _mm_store_ps(&laneBarycentric[i][lane], _mm_mul_ps(_mm_cvtepi32_ps(value), invArea));
+        }
+        mask |= (uint64_t)_mm_movemask_ps(_mm_castsi128_ps(inside)) << lane;
+    }
+    return mask;
+}
+
+// 截断到[0, 1]的颜色乘255后转为RGBA8，与glm的float到uint8转换一样向零取整
+SOFTGL_TARGET_SSE41
+static inline void storeRGBA8(__m128 color, RGBA* dst) {
+    __m128i value = _mm_cvttps_epi32(_mm_mul_ps(color, _mm_set1_ps(255.f)));
+    value = _mm_packus_epi32(value, value);
+    value = _mm_packus_epi16(value, value);
+    int32_t packed = _mm_cvtsi128_si32(value);
+    memcpy(dst, &packed, sizeof(packed));
+}
+
+SOFTGL_TARGET_SSE41
+static inline __m128 clampColor(const glm::vec4& color) {
+    return _mm_max_ps(_mm_min_ps(_mm_loadu_ps(&color.x), _mm_set1_ps(1.f)), _mm_setzero_ps());
+}
+
+SOFTGL_TARGET_SSE41
+static void storeColorSSE41(const glm::vec4& color, RGBA* dst) {
+    storeRGBA8(clampColor(color), dst);
+}
+
+SOFTGL_TARGET_SSE41
+static void storeColorBlendAlphaSSE41(const glm::vec4& color, RGBA* dst) {
+    __m128 src = clampColor(color);
+    int32_t packed;
+    memcpy(&packed, dst, sizeof(packed));
+    __m128 dstColor = _mm_div_ps(_mm_cvtepi32_ps(_mm_cvtepu8_epi32(_mm_cvtsi32_si128(packed))), _mm_set1_ps(255.f));
+
+    // rgb和alpha的混合因子相同：src * srcA + dst * (1 - srcA)
+    __m128 srcAlpha = _mm_shuffle_ps(src, src, _MM_SHUFFLE(3, 3, 3, 3));
+    __m128 ret = _mm_add_ps(_mm_mul_ps(src, srcAlpha), _mm_mul_ps(dstColor, _mm_sub_ps(_mm_set1_ps(1.f), srcAlpha)));
+    storeRGBA8(ret, dst);
+}
+
+// 一个像素的4个采样点（16字节），和除以4向下取整，与标量版本的float平均后截断结果一致
+SOFTGL_TARGET_SSE41
+static inline int32_t resolvePixel4x(__m128i samples) {
+    __m128i sum = _mm_add_epi16(_mm_cvtepu8_epi16(samples), _mm_cvtepu8_epi16(_mm_srli_si128(samples, 8)));
+    sum = _mm_add_epi16(sum, _mm_srli_si128(sum, 8));
+    sum = _mm_srli_epi16(sum, 2);
+    return _mm_cvtsi128_si32(_mm_packus_epi16(sum, sum));
+}
+
+SOFTGL_TARGET_SSE41
+static void resolveColor4xSSE41(const glm::tvec4<RGBA>* src, RGBA* dst, size_t count) {
+    for (size_t idx = 0; idx < count; idx++) {
+        int32_t packed = resolvePixel4x(_mm_loadu_si128((const __m128i*)&src[idx]));
+        memcpy(&dst[idx], &packed, sizeof(packed));
+    }
+}
+
+/*******************************  AVX2  *********************************/
+SOFTGL_TARGET_AVX2
+static void interpolateBarycentricAVX2(float* varsOut, const float* varsIn[3], size_t elemCnt, const glm::aligned_vec4& bc) {
+    const float* inVar0 = varsIn[0];
+    const float* inVar1 = varsIn[1];
+    const float* inVar2 = varsIn[2];
+
+    size_t idx = 0;
+    size_t end = elemCnt & (~7);
+    if (end > 0) {
+        __m256 bc0 = _mm256_set1_ps(bc[0]);
+        __m256 bc1 = _mm256_set1_ps(bc[1]);
+        __m256 bc2 = _mm256_set1_ps(bc[2]);
+        for (; idx < end; idx += 8) {
+            __m256 sum = _mm256_mul_ps(_mm256_load_ps(inVar0 + idx), bc0);
+            sum = _mm256_fmadd_ps(_mm256_load_ps(inVar1 + idx), bc1, sum);
+            sum = _mm256_fmadd_ps(_mm256_load_ps(inVar2 + idx), bc2, sum);
+            _mm256_store_ps(varsOut + idx, sum);
+        }
+    }
+
+    end = idx + ((elemCnt - idx) & (~3));
+    if (end > idx) {
+        __m128 bc0 = _mm_set1_ps(bc[0]);
+        __m128 bc1 = _mm_set1_ps(bc[1]);
+        __m128 bc2 = _mm_set1_ps(bc[2]);
+        for (; idx < end; idx += 4) {
+            __m128 sum = _mm_mul_ps(_mm_load_ps(inVar0 + idx), bc0);
+            sum = _mm_fmadd_ps(_mm_load_ps(inVar1 + idx), bc1, sum);
+            sum = _mm_fmadd_ps(_mm_load_ps(inVar2 + idx), bc2, sum);
+            _mm_store_ps(varsOut + idx, sum);
+        }
+    }
+
+    for (; idx < elemCnt; idx++) {
+        varsOut[idx] = 0;
+        varsOut[idx] += inVar0[idx] * bc[0];
+        varsOut[idx] += inVar1[idx] * bc[1];
+        varsOut[idx] += inVar2[idx] * bc[2];
+    }
+}
+
+SOFTGL_TARGET_AVX2
+static inline uint64_t edgeCoverage8(const EdgeFunctions& edges, const int32_t* blockValue,
+                                     const int32_t (*laneOffset)[RASTER_MAX_LANES], float (*laneBarycentric)[RASTER_MAX_LANES],
+                                     int lane) {
+    __m256 invArea = _mm256_set1_ps(edges.invArea);
+    __m256i inside = _mm256_set1_epi32(-1);
+    for (int i = 0; i < 3; i++) {
+        __m256i offset = _mm256_load_si256((const __m256i*)&laneOffset[i][lane]);
+        __m256i value = _mm256_add_epi32(_mm256_set1_epi32(blockValue[i]), offset);
+        inside = _mm256_and_si256(inside, _mm256_cmpgt_epi32(value, _mm256_set1_epi32(edges.threshold[i])));
+        _mm256_store_ps(&laneBarycentric[i][lane], _mm256_mul_ps(_mm256_cvtepi32_ps(value), invArea));
+    }
+    return (uint64_t)_mm256_movemask_ps(_mm256_castsi256_ps(inside)) << lane;
+}
+
+SOFTGL_TARGET_AVX2
+static uint64_t edgeCoverageAVX2(const EdgeFunctions& edges, const int32_t* blockValue,
+                                 const int32_t (*laneOffset)[RASTER_MAX_LANES], float (*laneBarycentric)[RASTER_MAX_LANES],
+                                 int laneCnt) {
+    uint64_t mask = 0;
+    for (int lane = 0; lane < laneCnt; lane += 8) {
+        mask |= edgeCoverage8(edges, blockValue, laneOffset, laneBarycentric, lane);
+    }
+    return mask;
+}
+
+// 每次解析2个像素，每个128位通道内处理一个像素，做法同resolvePixel4x
+SOFTGL_TARGET_AVX2
+static void resolveColor4xAVX2(const glm::tvec4<RGBA>* src, RGBA* dst, size_t count) {
+    const __m256i zero = _mm256_setzero_si256();
+    const __m256i gather = _mm256_setr_epi32(0, 4, 0, 0, 0, 0, 0, 0);
+    size_t idx = 0;
+    for (; idx + 2 <= count; idx += 2) {
+        __m256i samples = _mm256_loadu_si256((const __m256i*)&src[idx]);
+        __m256i sum = _mm256_add_epi16(_mm256_unpacklo_epi8(samples, zero), _mm256_unpackhi_epi8(samples, zero));
+        sum = _mm256_add_epi16(sum, _mm256_shuffle_epi32(sum, _MM_SHUFFLE(1, 0, 3, 2)));
+        sum = _mm256_srli_epi16(sum, 2);
+        sum = _mm256_permutevar8x32_epi32(_mm256_packus_epi16(sum, sum), gather);
+        _mm_storel_epi64((__m128i*)&dst[idx], _mm256_castsi256_si128(sum));
+    }
+    resolveColor4xSSE41(src + idx, dst + idx, count - idx);
+}
+
+/*******************************  AVX-512  *********************************/
+SOFTGL_TARGET_AVX512
+static void interpolateBarycentricAVX512(float* varsOut, const float* varsIn[3], size_t elemCnt, const glm::aligned_vec4& bc) {
+    const float* inVar0 = varsIn[0];
+    const float* inVar1 = varsIn[1];
+    const float* inVar2 = varsIn[2];
+
+    size_t idx = 0;
+    size_t end = elemCnt & (~15);
+    if (end > 0) {
+        __m512 bc0 = _mm512_set1_ps(bc[0]);
+        __m512 bc1 = _mm512_set1_ps(bc[1]);
+        __m512 bc2 = _mm512_set1_ps(bc[2]);
+        // varyings只保证32字节对齐
+        for (; idx < end; idx += 16) {
+            __m512 sum = _mm512_mul_ps(_mm512_loadu_ps(inVar0 + idx), bc0);
+            sum = _mm512_fmadd_ps(_mm512_loadu_ps(inVar1 + idx), bc1, sum);
+            sum = _mm512_fmadd_ps(_mm512_loadu_ps(inVar2 + idx), bc2, sum);
+            _mm512_storeu_ps(varsOut + idx, sum);
+        }
+    }
+
+    if (idx < elemCnt) {
+        const float* varsRemain[3] = { inVar0 + idx, inVar1 + idx, inVar2 + idx };
+        interpolateBarycentricAVX2(varsOut + idx, varsRemain, elemCnt - idx, bc);
+    }
+}
+
+SOFTGL_TARGET_AVX512
+static uint64_t edgeCoverageAVX512(const EdgeFunctions& edges, const int32_t* blockValue,
+                                   const int32_t (*laneOffset)[RASTER_MAX_LANES], float (*laneBarycentric)[RASTER_MAX_LANES],
+                                   int laneCnt) {
+    uint64_t mask = 0;
+    int lane = 0;
+    __m512 invArea = _mm512_set1_ps(edges.invArea);
+    for (; lane + 16 <= laneCnt; lane += 16) {
+        __mmask16 inside = 0xFFFF;
+        for (int i = 0; i < 3; i++) {
+            __m512i offset = _mm512_loadu_si512((const void*)&laneOffset[i][lane]);
+            __m512i value = _mm512_add_epi32(_mm512_set1_epi32(blockValue[i]), offset);
+            inside &= _mm512_cmpgt_epi32_mask(value, _mm512_set1_epi32(edges.threshold[i]));
+            _mm512_storeu_ps(&laneBarycentric[i][lane], _mm512_mul_ps(_mm512_maskz_cvtepi32_ps(0xFFFF, value), invArea));
+        }
+        mask |= (uint64_t)inside << lane;
+    }
+    if (lane < laneCnt) {
+        mask |= edgeCoverage8(edges, blockValue, laneOffset, laneBarycentric, lane);
+    }
+    return mask;
+}
+
+// 每次解析4个像素
+SOFTGL_TARGET_AVX512
+static void resolveColor4xAVX512(const glm::tvec4<RGBA>* src, RGBA* dst, size_t count) {
+    // 使用全掩码的maskz形式代替对应的非掩码intrinsic（含cast/extract）：GCC的实现以未定义值作为合并操作数，内联后产生-Wmaybe-uninitialized
+    const __mmask16 all = 0xFFFF;
+    const __m512i zero = _mm512_setzero_si512();
+    const __m512i gather = _mm512_setr_epi32(0, 4, 8, 12, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0);
+    size_t idx = 0;
+    for (; idx + 4 <= count; idx += 4) {
+        __m512i samples = _mm512_loadu_si512((const void*)&src[idx]);
+        __m512i sum = _mm512_add_epi16(_mm512_unpacklo_epi8(samples, zero), _mm512_unpackhi_epi8(samples, zero));
+        sum = _mm512_add_epi16(sum, _mm512_maskz_shuffle_epi32(all, sum, _MM_PERM_BADC));
+        sum = _mm512_srli_epi16(sum, 2);
+        sum = _mm512_maskz_permutexvar_epi32(all, gather, _mm512_packus_epi16(sum, sum));
+        _mm_storeu_si128((__m128i*)&dst[idx], _mm512_maskz_extracti32x4_epi32(0xF, sum, 0));
+    }
+    resolveColor4xAVX2(src + idx, dst + idx, count - idx);
+}
+#endif
+
+/*******************************  分发  *********************************/
+static const SIMDKernels* kernelTable() {
+    static const SIMDKernels table[] = {
+        { SIMDLevel_SCALAR, interpolateBarycentricScalar, edgeCoverageScalar,
+          storeColorScalar, storeColorBlendAlphaScalar, resolveColor4xScalar },
+#ifdef SOFTGL_SIMD_OPT
+        { SIMDLevel_SSE41, interpolateBarycentricSSE41, edgeCoverageSSE41,
+          storeColorSSE41, storeColorBlendAlphaSSE41, resolveColor4xSSE41 },
+        // 单个像素的颜色写入只有4个分量，更宽的级别沿用SSE4.1实现
+        { SIMDLevel_AVX2, interpolateBarycentricAVX2, edgeCoverageAVX2,
+          storeColorSSE41, storeColorBlendAlphaSSE41, resolveColor4xAVX2 },
+        { SIMDLevel_AVX512, interpolateBarycentricAVX512, edgeCoverageAVX512,
+          storeColorSSE41, storeColorBlendAlphaSSE41, resolveColor4xAVX512 },
+#endif
+    };
+    return table;
+}
+
+static std::atomic<const SIMDKernels*>& activeKernels() {
+    static std::atomic<const SIMDKernels*> active([]() {
+        SIMDLevel level = SIMDDispatch::maxLevel();
+        const char* env = getenv("SOFTGL_SIMD");
+        if (env) {
+            SIMDLevel request;
+            if (!CPUFeatures::parseLevel(env, request)) {
+                LOGW("invalid SOFTGL_SIMD: %s", env);
+            }
+            else if (request > level) {
+                LOGW("SOFTGL_SIMD=%s not supported, use %s", env, CPUFeatures::levelName(level));
+            }
+            else {
+                level = request;
+            }
+        }
+        LOGI("software renderer simd: %s", CPUFeatures::levelName(level));
+        return &kernelTable()[level];
+    }());
+    return active;
+}
+
+const SIMDKernels& SIMDDispatch::kernels() {
+    return *activeKernels().load(std::memory_order_acquire);
+}
+
+const SIMDKernels& SIMDDispatch::kernels(SIMDLevel level) {
+    return kernelTable()[std::min(level, maxLevel())];
+}
+
+SIMDLevel SIMDDispatch::setLevel(SIMDLevel level) {
+    const SIMDKernels& ret = kernels(level);
+    activeKernels().store(&ret, std::memory_order_release);
+    return ret.level;
+}
+
+SIMDLevel SIMDDispatch::maxLevel() {
+#ifdef SOFTGL_SIMD_OPT
+    static const SIMDLevel level = CPUFeatures::detect();
+    return level;
+#else
+    return SIMDLevel_SCALAR;
+#endif
+}
+
+}
@@ -1,5 +1,8 @@
 #include "Viewer/Viewer.h"
 #include "Base/hashUtils.h"
+#include "Render/Software/RendererSoft.h"
+#include <algorithm>
+#include <cstring>
 
 
 namespace OpenGL {
@@ -43,7 +46,7 @@ bool Viewer::create(int width, int height, int outTexId) {
 	uniformBlockMaterial_ = CREATE_UNIFORM_BLOCK(UniformsMaterial);
 
 	shadowPlaceholder_ = createTexture2DDefault(1, 1, TextureFormat_FLOAT32, TextureUsage_Sampler);
-	iblPlaceholder_ = createTextureCubeDefault(1, 1, TextureUsage_Sampler);
+	iblPlaceholder_ = createTextureCubeDefault(*renderer_, 1, 1, TextureUsage_Sampler);
 
 	return true;
 }
@@ -71,6 +74,8 @@ void Viewer::cleanup() {
 	shadowPlaceholder_ = nullptr;
 	fxaaFilter_ = nullptr;
 	texColorFxaa_ = nullptr;
+	waitIBLJob();
+	iblFallback_ = {};
 	iblPlaceholder_ = nullptr;
 	iblGenerator_ = nullptr;
 	uniformBlockScene_ = nullptr;
@@ -295,10 +300,9 @@ void Viewer::drawScene(bool shadowPass) {
 	/*绘制顺序：
 		1. 点光源标记
 		2. 世界坐标轴
-		3. 地板
-		4. 不透明物体
-		5. 天空盒
-		6. 透明物体
+		3. 不透明物体（含地板，按绘制列表排序）
+		4. 天空盒
+		5. 透明物体（按绘制列表从远到近）
 	*/
 
 	// update scene uniform
@@ -317,14 +321,20 @@ void Viewer::drawScene(bool shadowPass) {
 		pipelineDraw(scene_->worldAxis);
 	}
 
-	// draw floor
+	// build draw list: floor & model nodes
 	if (!shadowPass && config_.showFloor) {
-		drawModelMesh(scene_->floor, shadowPass, 0.f);
+		pushDrawItem(scene_->floor, glm::mat4(1.0f), 0.f);
 	}
+	collectModelNodes(scene_->model->rootNode, scene_->model->centeredTransform);
+	buildDrawList();
 
-	// draw model nodes opaque
-	ModelNode& modelNode = scene_->model->rootNode;
-	drawModelNodes(modelNode, shadowPass, scene_->model->centeredTransform, Alpha_Opaque);
+	// 不透明项的pass位为0，排在前面
+	auto blendBegin = std::partition_point(drawList_.begin(), drawList_.end(), [](const DrawItem& item) {
+		return (item.sortKey >> 63) == 0;
+	});
+
+	// draw opaque
+	drawItems(drawList_.begin(), blendBegin, shadowPass);
 
 	// draw skybox
 	if (!shadowPass && config_.showSkybox) {
@@ -333,38 +343,103 @@ void Viewer::drawScene(bool shadowPass) {
 		pipelineDraw(scene_->skybox);
 	}
 
-	// draw model nodes blend
-	drawModelNodes(modelNode, shadowPass, scene_->model->centeredTransform, Alpha_Blend);
+	// draw blend
+	drawItems(blendBegin, drawList_.end(), shadowPass);
+
+	drawList_.clear();
 }
 
-// 递归绘制模型节点及其子节点，更新uniformmodel
-void Viewer::drawModelNodes(ModelNode& node, bool shadowPass, glm::mat4& transform, AlphaMode mode, float specular) {
+/*按sortKey排序绘制列表。sortKey布局（低位未列出的bit为0）：
+	bit 63    : pass，0为不透明，1为半透明
+	不透明，软光栅 : 深度（近到远）| program | pipeline，先画近处物体让early-z剔除更多片段，软光栅切换状态几乎没有开销
+	不透明，OpenGL : program | pipeline | 深度（近到远），相同状态的绘制连续提交，减少program与状态切换
+	半透明         : 深度（远到近）| program | pipeline，保证混合结果正确
+  深度为包围盒中心在观察空间的距离，非负float的位模式与数值大小顺序一致，可直接作为整数比较
+*/
+void Viewer::buildDrawList() {
+	const glm::mat4& view = camera_->viewMatrix();
+	bool stateFirst = renderer_->type() == Renderer_OPENGL;
+
+	drawStateIds_.clear();
+	for (auto& item : drawList_) {
+		auto& material = *item.mesh->material;
+		uint64_t programId = getDrawStateId(material.materialObj->shaderProgram.get()) & 0x7FFF;
+		uint64_t pipelineId = getDrawStateId(material.materialObj->pipelineStates.get()) & 0x7FFF;
+		uint64_t stateKey = (programId << 15) | pipelineId;
+
+		BoundingBox bbox = item.mesh->aabb.transform(item.modelMatrix);
+		glm::vec4 center = view * glm::vec4((bbox.min + bbox.max) * 0.5f, 1.f);
+		float depth = std::max(-center.z, 0.f);
+		uint32_t depthBits;
+		memcpy(&depthBits, &depth, sizeof(float));
+
+		if (material.alphaMode == Alpha_Blend) {
+			item.sortKey = (1ull << 63) | ((uint64_t)~depthBits << 30) | stateKey;
+		}
+		else if (stateFirst) {
+			item.sortKey = (stateKey << 32) | depthBits;
+		}
+		else {
+			item.sortKey = ((uint64_t)depthBits << 30) | stateKey;
+		}
+	}
+
+	// 稳定排序，sortKey相同的项保持层级遍历顺序
+	std::stable_sort(drawList_.begin(), drawList_.end(), [](const DrawItem& a, const DrawItem& b) {
+		return a.sortKey < b.sortKey;
+	});
+}
+
+// 递归遍历模型节点，将通过视锥剔除的mesh加入绘制列表
+void Viewer::collectModelNodes(ModelNode& node, const glm::mat4& transform) {
 	//计算当前节点的世界变换矩阵
 	glm::mat4 modelMatrix = transform * node.transform; //transform:父节点累计的model矩阵
 
-	// update model uniform
-	updateUniformModel(modelMatrix, camera_->viewMatrix());
-
-	// draw nodes
 	for (auto& mesh : node.meshes) {
-		if (mesh.material->alphaMode != mode) {
-			continue;
-		}
-
 		// frustum cull
 		if (!checkMeshFrustumCull(mesh, modelMatrix)) {
-			return;
+			continue;
 		}
-
-		drawModelMesh(mesh, shadowPass, specular);
+		pushDrawItem(mesh, modelMatrix, 1.f);
 	}
 
-	// draw child
+	// collect child
 	for (auto& childNode : node.children) {
-		drawModelNodes(childNode, shadowPass, modelMatrix, mode, specular);
+		collectModelNodes(childNode, modelMatrix);
 	}
 }
 
+void Viewer::pushDrawItem(ModelMesh& mesh, const glm::mat4& modelMatrix, float specular) {
+	drawList_.emplace_back();
+	DrawItem& item = drawList_.back();
+	item.mesh = &mesh;
+	item.modelMatrix = modelMatrix;
+	item.specular = specular;
+}
+
+// 按顺序提交绘制列表中的一段，model矩阵与上一项相同时不重复上传
+void Viewer::drawItems(std::vector<DrawItem>::iterator begin, std::vector<DrawItem>::iterator end, bool shadowPass) {
+	const glm::mat4* lastModel = nullptr;
+	for (auto it = begin; it != end; ++it) {
+		if (!lastModel || *lastModel != it->modelMatrix) {
+			updateUniformModel(it->modelMatrix, camera_->viewMatrix());
+			lastModel = &it->modelMatrix;
+		}
+		drawModelMesh(*it->mesh, shadowPass, it->specular);
+	}
+}
+
+// 为本帧出现的program/pipeline分配连续编号，按首次出现的顺序递增
+uint32_t Viewer::getDrawStateId(const void* state) {
+	auto it = drawStateIds_.find(state);
+	if (it != drawStateIds_.end()) {
+		return it->second;
+	}
+	uint32_t id = (uint32_t)drawStateIds_.size();
+	drawStateIds_[state] = id;
+	return id;
+}
+
 //绘制单个mesh，更新material、ibltexture、shadow texture
 void Viewer::drawModelMesh(ModelMesh& mesh, bool shadowPass, float specular) {
 	// update material
@@ -476,7 +551,9 @@ void Viewer::setupShadowMapBuffers() {
 // 初始化主颜色缓冲区纹理，创建空纹理
 void Viewer::setupMainColorBuffer(bool multiSample) {
 	
-	if (!texColorMain_ || texColorMain_->multiSample != multiSample) {
+	int sampleCount = multiSample ? config_.msaaSamples : 1;
+	if (!texColorMain_ || texColorMain_->multiSample != multiSample
+		|| (multiSample && texColorMain_->sampleCount != sampleCount)) {
 		TextureDesc texDesc{}; 
 		texDesc.width = width_;             
 		texDesc.height = height_;           
@@ -485,6 +562,7 @@ void Viewer::setupMainColorBuffer(bool multiSample) {
 		texDesc.usage = TextureUsage_AttachmentColor | TextureUsage_RendererOutput;
 		texDesc.useMipmaps = false;             
 		texDesc.multiSample = multiSample;      
+		texDesc.sampleCount = sampleCount;
 
 		texColorMain_ = renderer_->createTexture(texDesc);
 
@@ -500,7 +578,9 @@ void Viewer::setupMainColorBuffer(bool multiSample) {
 
 //设置主深度缓冲区的纹理对象，分配GPU资源
 void Viewer::setupMainDepthBuffer(bool multiSample) {
-	if (!texDepthMain_ || texDepthMain_->multiSample != multiSample) {
+	int sampleCount = multiSample ? config_.msaaSamples : 1;
+	if (!texDepthMain_ || texDepthMain_->multiSample != multiSample
+		|| (multiSample && texDepthMain_->sampleCount != sampleCount)) {
 		TextureDesc texDesc{};
 		texDesc.width = width_;
 		texDesc.height = height_;
@@ -509,6 +589,7 @@ void Viewer::setupMainDepthBuffer(bool multiSample) {
 		texDesc.usage = TextureUsage_AttachmentDepth;
 		texDesc.useMipmaps = false;
 		texDesc.multiSample = multiSample;
+		texDesc.sampleCount = sampleCount;
 		texDepthMain_ = renderer_->createTexture(texDesc);
 
 		SamplerDesc sampler{};
@@ -753,57 +834,121 @@ void Viewer::updateUniformMaterial(Material& material, float specular) {
 	uniformBlockMaterial_->setData(&uniformsMaterial, sizeof(UniformsMaterial));// 上传到GPU
 }
 
-/*初始化ibl资源，将等距柱状图转化为立方体贴图，生成irradianceMap、prefilterMap*/
+/*初始化ibl资源，将等距柱状图转化为立方体贴图，生成irradianceMap、prefilterMap。
+  软件渲染默认在后台生成，生成完成前沿用上一个天空盒的IBL，没有时只使用环境光*/
 bool Viewer::initSkyboxIBL() {
 	if (!(config_.showSkybox && config_.pbrIbl)) {//检查配置是否启用天空盒和pbribl
 		return false;
 	}
 
+	auto skyboxMaterial = std::dynamic_pointer_cast<SkyboxMaterial>(scene_->skybox.material);
+	if (skyboxMaterial->iblReady) {// 检查是否已经初始化过ibl
+		return true;
+	}
+
+	if (skyboxMaterial->textures.empty()) {// 为材质中纹理分配GPU资源
+		setupTextures(*skyboxMaterial);
+		skyboxMaterial->shaderDefines = generateShaderDefines(*skyboxMaterial);
+	}
+
+	if (renderer_->type() == Renderer_SOFT && config_.iblAsync) {
+		return updateIBLJob(skyboxMaterial);
+	}
+
 	if (!iblGenerator_) {//确保ibl生成器已创建
 		iblGenerator_ = std::make_shared<IBLGenerator>(renderer_);
 	}
 
-	if (getSkyboxMaterial()->iblReady) {// 检查是否已经初始化过ibl
-		return true;
-	}
+	auto& textures = skyboxMaterial->textures;
+	auto texCubeIt = textures.find(MaterialTexType_CUBE);
+	auto texEqIt = textures.find(MaterialTexType_EQUIRECTANGULAR);
+	std::shared_ptr<Texture> texCube = texCubeIt != textures.end() ? texCubeIt->second : nullptr;
+	std::shared_ptr<Texture> texEquirect = texEqIt != textures.end() ? texEqIt->second : nullptr;
 
-	auto& skybox = scene_->skybox;
-	if (skybox.material->textures.empty()) {// 为材质中纹理分配GPU资源
-		setupTextures(*skybox.material);
+	IBLTextures iblTextures;
+	bool success = generateIBL(*iblGenerator_, *renderer_, texCube, texEquirect, config_.iblIrradianceSH, iblTextures);
+	iblGenerator_->clearCaches();// 清理生成器缓存
+	if (!success) {
+		return false;
 	}
 
-	std::shared_ptr<Texture> textureCube = nullptr;
+	applyIBLTextures(*skyboxMaterial, iblTextures);
+	return true;
+}
 
-	// 等距柱状图转立方体贴图处理
-	auto texCubeIt = skybox.material->textures.find(MaterialTexType_CUBE);
-	if (texCubeIt == skybox.material->textures.end()) { // 如果没有立方体贴图则说明是等距柱状贴图
-		// 查找等距柱状图纹理
-		auto texEqIt = skybox.material->textures.find(MaterialTexType_EQUIRECTANGULAR);
-		if (texEqIt != skybox.material->textures.end()) {
-			// 创建目标立方体贴图
-			auto tex2d = std::dynamic_pointer_cast<Texture>(texEqIt->second);
-			auto cubeSize = std::min(tex2d->width, tex2d->height);
-			auto texCvt = createTextureCubeDefault(cubeSize, cubeSize, TextureUsage_AttachmentColor | TextureUsage_Sampler);
-			// 执行转换
-			auto success = iblGenerator_->convertEquirectangular([&](ShaderProgram& program) -> bool {
-															 	 return loadShaders(program, Shading_Skybox);}, 
-																 tex2d, texCvt);
-
-			LOGD("convert equirectangular to cube map: %s.", success ? "success" : "failed");
-			if (success) {
-				textureCube = texCvt;
-				skybox.material->textures[MaterialTexType_CUBE] = texCvt;
-
-				// 更新天空盒材质
-				renderer_->waitIdle();
-				skybox.material->textures.erase(MaterialTexType_EQUIRECTANGULAR);
-				skybox.material->shaderDefines = generateShaderDefines(*skybox.material);
-				skybox.material->materialObj = nullptr;
+// 检查后台任务状态：完成时替换结果，当前天空盒还没有任务时启动新任务。同一时间只运行一个任务
+bool Viewer::updateIBLJob(const std::shared_ptr<SkyboxMaterial>& material) {
+	if (iblJob_) {
+		if (iblJob_->result.valid()) {
+			if (iblJob_->result.wait_for(std::chrono::seconds(0)) != std::future_status::ready) {
+				return false;
+			}
+			if (iblJob_->result.get()) {
+				applyIBLTextures(*iblJob_->material, iblJob_->textures);
+			}
+			else {
+				LOGE("initSkyboxIBL failed: background generation failed");
 			}
 		}
+
+		// 任务已完成（生成失败时不再重试）
+		if (iblJob_->material == material) {
+			return material->iblReady;
+		}
+		iblJob_ = nullptr;
+	}
+
+	// 输入纹理在主线程中取出，后台线程不访问材质
+	auto& textures = material->textures;
+	auto texCubeIt = textures.find(MaterialTexType_CUBE);
+	auto texEqIt = textures.find(MaterialTexType_EQUIRECTANGULAR);
+	std::shared_ptr<Texture> texCube = texCubeIt != textures.end() ? texCubeIt->second : nullptr;
+	std::shared_ptr<Texture> texEquirect = texEqIt != textures.end() ? texEqIt->second : nullptr;
+	bool irradianceSH = config_.iblIrradianceSH;
+
+	auto job = std::make_shared<IBLJob>();
+	job->material = material;
+	job->result = std::async(std::launch::async, [this, job, texCube, texEquirect, irradianceSH]() -> bool {
+		// 留出一个核给前台渲染；渲染器不带线程池，由生成器按面/级别分配线程。
+		// hardware_concurrency()无法获取时返回0，先截断再减1，避免无符号下溢
+		size_t workerCnt = std::max(2u, std::thread::hardware_concurrency()) - 1;
+		auto renderer = std::make_shared<RendererSoft>(0);
+		renderer->create();
+		IBLGenerator generator(renderer, workerCnt);
+		return generateIBL(generator, *renderer, texCube, texEquirect, irradianceSH, job->textures);
+	});
+	iblJob_ = job;
+
+	LOGD("generate ibl in background ...");
+	return false;
+}
+
+// 等待后台任务结束并丢弃结果
+void Viewer::waitIBLJob() {
+	if (iblJob_ && iblJob_->result.valid()) {
+		iblJob_->result.wait();
 	}
-	else {
-		textureCube = std::dynamic_pointer_cast<Texture>(texCubeIt->second);
+	iblJob_ = nullptr;
+}
+
+// 生成天空盒的IBL纹理，不修改材质，可以在后台线程中调用。texCube为空时先将texEquirect转换为立方体贴图
+bool Viewer::generateIBL(IBLGenerator& generator, Renderer& renderer, const std::shared_ptr<Texture>& texCube,
+						 const std::shared_ptr<Texture>& texEquirect, bool irradianceSH, IBLTextures& textures) {
+	std::shared_ptr<Texture> textureCube = texCube;
+
+	// 等距柱状图转立方体贴图处理
+	if (!textureCube && texEquirect) {
+		auto cubeSize = std::min(texEquirect->width, texEquirect->height);
+		auto texCvt = createTextureCubeDefault(renderer, cubeSize, cubeSize, TextureUsage_AttachmentColor | TextureUsage_Sampler);
+		auto success = generator.convertEquirectangular([&](ShaderProgram& program) -> bool {
+															return loadShaders(program, Shading_Skybox);},
+														texEquirect, texCvt);
+
+		LOGD("convert equirectangular to cube map: %s.", success ? "success" : "failed");
+		if (success) {
+			textureCube = texCvt;
+			textures.cubeMap = texCvt;
+		}
 	}
 
 	if (!textureCube) {//检查立方体贴图是否有效
@@ -813,46 +958,65 @@ bool Viewer::initSkyboxIBL() {
 
 	// 生成irradiance map
 	LOGD("generate ibl irradiance map ...");
-	auto texIrradiance = createTextureCubeDefault(kIrradianceMapSize, kIrradianceMapSize, TextureUsage_AttachmentColor | TextureUsage_Sampler);
-	if (iblGenerator_->generateIrradianceMap([&](ShaderProgram& program) -> bool {return loadShaders(program, Shading_IBL_Irradiance);},
-											 textureCube, texIrradiance)) {
-		skybox.material->textures[MaterialTexType_IBL_IRRADIANCE] = std::move(texIrradiance);
-	}
-	else {
+	auto texIrradiance = createTextureCubeDefault(renderer, kIrradianceMapSize, kIrradianceMapSize, TextureUsage_AttachmentColor | TextureUsage_Sampler);
+	bool useSH = irradianceSH && renderer.type() == Renderer_SOFT;
+	bool irradianceReady = useSH
+		? generator.generateIrradianceMapSH(textureCube, texIrradiance)
+		: generator.generateIrradianceMap([&](ShaderProgram& program) -> bool {return loadShaders(program, Shading_IBL_Irradiance);},
+										  textureCube, texIrradiance);
+	if (!irradianceReady) {
 		LOGE("initSkyboxIBL failed: generate irradiance map failed");
 		return false;
 	}
+	textures.irradiance = std::move(texIrradiance);
 	LOGD("generate ibl irradiance map done.");
 
 	// 生成prefilter map
 	LOGD("generate ibl prefilter map ...");
-	auto texPrefilter = createTextureCubeDefault(kPrefilterMapSize, kPrefilterMapSize, TextureUsage_AttachmentColor | TextureUsage_Sampler, true);
-	if (iblGenerator_->generatePrefilterMap([&](ShaderProgram& program) -> bool {return loadShaders(program, Shading_IBL_Prefilter);},
-											textureCube, texPrefilter)) {
-		skybox.material->textures[MaterialTexType_IBL_PREFILTER] = std::move(texPrefilter);
-	}
-	else {
+	auto texPrefilter = createTextureCubeDefault(renderer, kPrefilterMapSize, kPrefilterMapSize, TextureUsage_AttachmentColor | TextureUsage_Sampler, true);
+	if (!generator.generatePrefilterMap([&](ShaderProgram& program) -> bool {return loadShaders(program, Shading_IBL_Prefilter);},
+										textureCube, texPrefilter)) {
 		LOGE("initSkyboxIBL failed: generate prefilter map failed");
 		return false;
 	}
+	textures.prefilter = std::move(texPrefilter);
 	LOGD("generate ibl prefilter map done.");
 
-	//清理和状态更新
-	renderer_->waitIdle();// 确保所有GPU操作完成
-	iblGenerator_->clearCaches();// 清理生成器缓存
-	getSkyboxMaterial()->iblReady = true;// 标记IBL已就绪
+	renderer.waitIdle();// 确保所有GPU操作完成
 	return true;
 }
 
+// 将生成结果替换到天空盒材质上，并作为之后切换天空盒时的过渡光照
+void Viewer::applyIBLTextures(SkyboxMaterial& material, const IBLTextures& textures) {
+	renderer_->waitIdle();
+
+	// 更新天空盒材质
+	if (textures.cubeMap) {
+		material.textures[MaterialTexType_CUBE] = textures.cubeMap;
+		material.textures.erase(MaterialTexType_EQUIRECTANGULAR);
+		material.shaderDefines = generateShaderDefines(material);
+		material.materialObj = nullptr;
+	}
+	material.textures[MaterialTexType_IBL_IRRADIANCE] = textures.irradiance;
+	material.textures[MaterialTexType_IBL_PREFILTER] = textures.prefilter;
+	material.iblReady = true;// 标记IBL已就绪
+
+	iblFallback_ = textures;
+}
+
 bool Viewer::iBLEnabled() {
-	return config_.showSkybox && config_.pbrIbl && getSkyboxMaterial()->iblReady;
+	if (!(config_.showSkybox && config_.pbrIbl)) {
+		return false;
+	}
+	return getSkyboxMaterial()->iblReady || iblFallback_.irradiance != nullptr;
 }
 
 SkyboxMaterial* Viewer::getSkyboxMaterial() {
 	return dynamic_cast<SkyboxMaterial*>(scene_->skybox.material.get());
 }
 
-/*更新材质中的IBL纹理绑定, 根据IBL是否启用，动态切换辐照度贴图和预过滤贴图的绑定目标*/
+/*更新材质中的IBL纹理绑定, 根据IBL是否启用，动态切换辐照度贴图和预过滤贴图的绑定目标。
+  当前天空盒的IBL还在生成时使用上一次生成完成的结果*/
 void Viewer::updateIBLTextures(MaterialObject* materialObj) {
 	if (!materialObj->shaderResources) {
 		return;
@@ -860,9 +1024,15 @@ void Viewer::updateIBLTextures(MaterialObject* materialObj) {
 
 	auto& samplers = materialObj->shaderResources->samplers;
 	if (iBLEnabled()) {
-		auto& skyboxTextures = scene_->skybox.material->textures;
-		samplers[MaterialTexType_IBL_IRRADIANCE]->setTexture(skyboxTextures[MaterialTexType_IBL_IRRADIANCE]);
-		samplers[MaterialTexType_IBL_PREFILTER]->setTexture(skyboxTextures[MaterialTexType_IBL_PREFILTER]);
+		if (getSkyboxMaterial()->iblReady) {
+			auto& skyboxTextures = scene_->skybox.material->textures;
+			samplers[MaterialTexType_IBL_IRRADIANCE]->setTexture(skyboxTextures[MaterialTexType_IBL_IRRADIANCE]);
+			samplers[MaterialTexType_IBL_PREFILTER]->setTexture(skyboxTextures[MaterialTexType_IBL_PREFILTER]);
+		}
+		else {
+			samplers[MaterialTexType_IBL_IRRADIANCE]->setTexture(iblFallback_.irradiance);
+			samplers[MaterialTexType_IBL_PREFILTER]->setTexture(iblFallback_.prefilter);
+		}
 	}
 	else {
 		samplers[MaterialTexType_IBL_IRRADIANCE]->setTexture(iblPlaceholder_);
@@ -909,7 +1079,7 @@ std::shared_ptr<Texture> Viewer::createTexture2DDefault(int width, int height, T
 	return texture2d;
 }
 
-std::shared_ptr<Texture> Viewer::createTextureCubeDefault(int width, int height, uint32_t usage, bool mipmaps) {
+std::shared_ptr<Texture> Viewer::createTextureCubeDefault(Renderer& renderer, int width, int height, uint32_t usage, bool mipmaps) {
 	TextureDesc texDesc{};
 	texDesc.width = width;
 	texDesc.height = height;
@@ -918,7 +1088,7 @@ std::shared_ptr<Texture> Viewer::createTextureCubeDefault(int width, int height,
 	texDesc.usage = usage;
 	texDesc.useMipmaps = mipmaps;
 	texDesc.multiSample = false;
-	auto textureCube = renderer_->createTexture(texDesc);
+	auto textureCube = renderer.createTexture(texDesc);
 	if (!textureCube) {
 		return nullptr;
 	}
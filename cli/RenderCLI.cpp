@@ -0,0 +1,279 @@
+// 离线渲染命令行工具：无窗口加载assets.json中的模型，沿环绕相机路径渲染N帧，输出PNG与逐帧耗时
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+#include "Base/Logger.h"
+#include "Base/ImageUtils.h"
+#include "Viewer/AssetsConfig.h"
+#include "Render/Software/SIMDKernelsSoft.h"
+#include "Viewer/ViewerHeadless.h"
+
+namespace {
+
+struct Options {
+	std::string assetsDir = OpenGL::ASSETS_DIR;
+	std::string model;
+	std::string skybox;
+	std::string outDir = "./output/";
+	int width = 1000;
+	int height = 800;
+	int frames = 1;
+	float orbitDegrees = 360.f;
+	int aaType = OpenGL::AAType_NONE;
+	int msaaSamples = 4;
+	bool pbrIbl = false;
+	bool iblIrradianceSH = true;
+	bool iblAsync = false;
+	bool showSkybox = false;
+	bool wireframe = false;
+	bool shadowMap = true;
+	bool meshStats = false;
+	bool writePng = true;
+	bool setSimd = false;
+	OpenGL::SIMDLevel simdLevel = OpenGL::SIMDLevel_SCALAR;
+};
+
+void printUsage(const char* exe) {
+	printf("usage: %s [options]\n"
+		"  --assets <dir>      assets directory containing assets.json (default ./assets/)\n"
+		"  --model <name>      model name in assets.json (default: first entry)\n"
+		"  --skybox <name>     skybox name in assets.json (default: first entry)\n"
+		"  --frames <n>        number of frames to render (default 1)\n"
+		"  --size <w>x<h>      output size (default 1000x800)\n"
+		"  --orbit <degrees>   camera rotation around the model over all frames (default 360)\n"
+		"  --aa <none|msaa|fxaa>\n"
+		"  --msaa-samples <2|4|8>\n"
+		"                      MSAA sample count (default 4)\n"
+		"  --ibl               enable PBR image based lighting (uses ./cache/IBL/)\n"
+		"  --ibl-convolve      generate the irradiance map by hemisphere convolution instead of SH projection\n"
+		"  --ibl-async         generate IBL in the background, frames before it is ready use ambient lighting only\n"
+		"  --skybox-bg         draw the skybox as background\n"
+		"  --wireframe         draw triangles as lines\n"
+		"  --no-shadow         disable the shadow map pass\n"
+		"  --mesh-stats        log the overdraw of imported meshes before/after optimization (slow)\n"
+		"  --out <dir>         output directory for frames and timings.csv (default ./output/)\n"
+		"  --no-png            only measure, do not write images\n"
+		"  --simd <scalar|sse4.1|avx2|avx512>\n"
+		"                      software rasterizer SIMD kernels (default: best supported, or $SOFTGL_SIMD)\n", exe);
+}
+
+bool parseOptions(int argc, char** argv, Options& opts) {
+	for (int i = 1; i < argc; i++) {
+		std::string arg = argv[i];
+		bool hasValue = i + 1 < argc;
+		if (arg == "--assets" && hasValue) {
+			opts.assetsDir = argv[++i];
+			if (opts.assetsDir.back() != '/') {
+				opts.assetsDir += '/';
+			}
+		}
+		else if (arg == "--model" && hasValue) {
+			opts.model = argv[++i];
+		}
+		else if (arg == "--skybox" && hasValue) {
+			opts.skybox = argv[++i];
+		}
+		else if (arg == "--frames" && hasValue) {
+			opts.frames = std::max(1, atoi(argv[++i]));
+		}
+		else if (arg == "--size" && hasValue) {
+			if (sscanf(argv[++i], "%dx%d", &opts.width, &opts.height) != 2 || opts.width <= 0 || opts.height <= 0) {
+				return false;
+			}
+		}
+		else if (arg == "--orbit" && hasValue) {
+			opts.orbitDegrees = (float)atof(argv[++i]);
+		}
+		else if (arg == "--aa" && hasValue) {
+			std::string aa = argv[++i];
+			if (aa == "none") {
+				opts.aaType = OpenGL::AAType_NONE;
+			}
+			else if (aa == "msaa") {
+				opts.aaType = OpenGL::AAType_MSAA;
+			}
+			else if (aa == "fxaa") {
+				opts.aaType = OpenGL::AAType_FXAA;
+			}
+			else {
+				return false;
+			}
+		}
+		else if (arg == "--msaa-samples" && hasValue) {
+			opts.msaaSamples = atoi(argv[++i]);
+			if (opts.msaaSamples != 2 && opts.msaaSamples != 4 && opts.msaaSamples != 8) {
+				return false;
+			}
+		}
+		else if (arg == "--ibl") {
+			opts.pbrIbl = true;
+		}
+		else if (arg == "--ibl-convolve") {
+			opts.iblIrradianceSH = false;
+		}
+		else if (arg == "--ibl-async") {
+			opts.iblAsync = true;
+		}
+		else if (arg == "--skybox-bg") {
+			opts.showSkybox = true;
+		}
+		else if (arg == "--wireframe") {
+			opts.wireframe = true;
+		}
+		else if (arg == "--no-shadow") {
+			opts.shadowMap = false;
+		}
+		else if (arg == "--mesh-stats") {
+			opts.meshStats = true;
+		}
+		else if (arg == "--out" && hasValue) {
+			opts.outDir = argv[++i];
+			if (opts.outDir.back() != '/') {
+				opts.outDir += '/';
+			}
+		}
+		else if (arg == "--no-png") {
+			opts.writePng = false;
+		}
+		else if (arg == "--simd" && hasValue) {
+			if (!OpenGL::CPUFeatures::parseLevel(argv[++i], opts.simdLevel)) {
+				return false;
+			}
+			opts.setSimd = true;
+		}
+		else {
+			return false;
+		}
+	}
+	return true;
+}
+
+// 在assets.json中查找资源，未指定名称时取第一项
+bool findAsset(const std::unordered_map<std::string, std::string>& paths, std::string& name, std::string& path) {
+	if (paths.empty()) {
+		return false;
+	}
+	auto it = name.empty() ? paths.begin() : paths.find(name);
+	if (it == paths.end()) {
+		return false;
+	}
+	name = it->first;
+	path = it->second;
+	return true;
+}
+
+}
+
+int main(int argc, char** argv) {
+	Options opts;
+	if (!parseOptions(argc, argv, opts)) {
+		printUsage(argv[0]);
+		return 1;
+	}
+
+	OpenGL::AssetsConfig assets;
+	if (!assets.load(opts.assetsDir)) {
+		return 1;
+	}
+	std::string modelPath, skyboxPath;
+	if (!findAsset(assets.modelPaths, opts.model, modelPath)) {
+		LOGE("model not found in assets.json: %s", opts.model.c_str());
+		return 1;
+	}
+	bool hasSkybox = findAsset(assets.skyboxPaths, opts.skybox, skyboxPath);
+
+	if (opts.setSimd) {
+		OpenGL::SIMDDispatch::setLevel(opts.simdLevel);
+	}
+
+	OpenGL::ViewerHeadless viewer;
+	if (!viewer.create(opts.width, opts.height)) {
+		LOGE("create headless viewer failed");
+		return 1;
+	}
+	auto& config = viewer.getConfig();
+	config.aaType = opts.aaType;
+	config.msaaSamples = opts.msaaSamples;
+	config.pbrIbl = opts.pbrIbl;
+	config.iblIrradianceSH = opts.iblIrradianceSH;
+	config.iblAsync = opts.iblAsync;
+	config.showSkybox = opts.showSkybox;
+	config.wireframe = opts.wireframe;
+	config.shadowMap = opts.shadowMap;
+	config.meshOverdrawStats = opts.meshStats;
+
+	if (!viewer.loadModel(opts.model, modelPath)) {
+		LOGE("load model failed: %s", modelPath.c_str());
+		return 1;
+	}
+	if (hasSkybox && !viewer.loadSkybox(opts.skybox, skyboxPath)) {
+		LOGE("load skybox failed: %s", skyboxPath.c_str());
+		return 1;
+	}
+
+	std::error_code ec;
+	std::filesystem::create_directories(opts.outDir, ec);
+	FILE* timingFile = fopen((opts.outDir + "timings.csv").c_str(), "w");
+	if (!timingFile) {
+		LOGE("open timings file failed: %s", opts.outDir.c_str());
+		return 1;
+	}
+	fprintf(timingFile, "frame,render_ms,ibl_ready\n");
+
+	// 相机初始位置与OrbitController一致，绕过center的竖直轴旋转
+	const glm::vec3 center(0.f, 1.f, 0.f);
+	const glm::vec3 initArm = glm::vec3(-1.5f, 3.f, 3.f) - center;
+	std::vector<double> frameTimes;
+	frameTimes.reserve(opts.frames);
+
+	for (int frame = 0; frame < opts.frames; frame++) {
+		float angle = glm::radians(opts.orbitDegrees) * (float)frame / (float)opts.frames;
+		glm::vec3 arm = glm::vec3(glm::rotate(glm::mat4(1.f), angle, glm::vec3(0.f, 1.f, 0.f)) * glm::vec4(initArm, 0.f));
+		viewer.setCamera(center + arm, center);
+
+		auto start = std::chrono::steady_clock::now();
+		viewer.drawFrame();
+		auto end = std::chrono::steady_clock::now();
+		double ms = std::chrono::duration<double, std::milli>(end - start).count();
+		frameTimes.push_back(ms);
+		fprintf(timingFile, "%d,%.3f,%d\n", frame, ms, viewer.isIBLReady() ? 1 : 0);
+
+		if (opts.writePng) {
+			auto buffer = viewer.getColorBuffer();
+			char fileName[64];
+			snprintf(fileName, sizeof(fileName), "frame_%04d.png", frame);
+			OpenGL::ImageUtils::writeImage((opts.outDir + fileName).c_str(),
+				(int)buffer->getWidth(),
+				(int)buffer->getHeight(),
+				4,
+				buffer->getRawDataPtr(),
+				(int)(buffer->getWidth() * sizeof(RGBA)),
+				true);
+		}
+	}
+	fclose(timingFile);
+	viewer.destroy();
+
+	// 第一帧包含纹理上传、IBL生成等一次性开销，单独统计
+	double total = 0.0;
+	double minMs = frameTimes.size() > 1 ? frameTimes[1] : frameTimes[0];
+	double maxMs = minMs;
+	for (size_t i = 1; i < frameTimes.size(); i++) {
+		total += frameTimes[i];
+		minMs = std::min(minMs, frameTimes[i]);
+		maxMs = std::max(maxMs, frameTimes[i]);
+	}
+	size_t steadyCnt = frameTimes.size() - 1;
+	double avgMs = steadyCnt > 0 ? total / (double)steadyCnt : frameTimes[0];
+
+	printf("model: %s, size: %dx%d, frames: %d\n", opts.model.c_str(), opts.width, opts.height, opts.frames);
+	printf("simd: %s\n", OpenGL::CPUFeatures::levelName(OpenGL::SIMDDispatch::kernels().level));
+	printf("first frame: %.3f ms\n", frameTimes[0]);
+	printf("avg: %.3f ms, min: %.3f ms, max: %.3f ms, fps: %.2f\n", avgMs, minMs, maxMs, 1000.0 / avgMs);
+	return 0;
+}
@@ -0,0 +1,216 @@
+// prefilter map生成的质量/耗时基准：对比预计算采样表 + filtered importance sampling（64个采样点）
+// 与原先直接采样源立方体贴图level 0的1024个采样点的结果
+//
+// 用法：IBLPrefilterBenchmark [--equirect <image>] [--size <cube face size>]
+//   不指定--equirect时使用程序生成的环境贴图（天空渐变 + 太阳 + 地面棋盘格）
+//   生成结果按纹理tag缓存到./cache/IBL/，每次运行使用不同的tag，保证两种算法都实际执行
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <string>
+#include "Base/ImageUtils.h"
+#include "Render/Software/RendererSoft.h"
+#include "Render/Software/TextureSoft.h"
+#include "Viewer/Environment.h"
+#include "Viewer/Shader/Software/ShaderSoft.h"
+
+namespace OpenGL {
+namespace ShaderIBLPrefilter {
+
+// 原先的prefilter片段着色器：每个像素1024个采样点，忽略计算出的mip级别（源贴图没有mipmap，总是采样level 0）
+class ReferenceFS : public ShaderIBLPrefilter {
+public:
+	CREATE_SHADER_CLONE(ReferenceFS)
+
+	void shaderMain() override {
+		glm::vec3 N = normalize(v->v_worldPos);
+		glm::vec3 V = N;
+
+		glm::vec3 up = abs(N.z) < 0.999 ? glm::vec3(0.0, 0.0, 1.0) : glm::vec3(1.0, 0.0, 0.0);
+		glm::vec3 tangent = glm::normalize(glm::cross(up, N));
+		glm::vec3 bitangent = glm::cross(N, tangent);
+
+		const uint32_t SAMPLE_COUNT = 1024u;
+		glm::vec3 prefilteredColor = glm::vec3(0.0f);
+		float totalWeight = 0.0f;
+		for (uint32_t i = 0u; i < SAMPLE_COUNT; ++i) {
+			glm::vec3 Ht = FS::ImportanceSampleGGX(FS::Hammersley(i, SAMPLE_COUNT), u->u_roughness);
+			glm::vec3 H = glm::normalize(tangent * Ht.x + bitangent * Ht.y + N * Ht.z);
+			glm::vec3 L = glm::normalize(2.0f * dot(V, H) * H - V);
+
+			float NdotL = glm::max(glm::dot(N, L), 0.0f);
+			if (NdotL > 0.0f) {
+				prefilteredColor += glm::vec3(textureLod(u->u_cubeMap, L, 0.f)) * NdotL;
+				totalWeight += NdotL;
+			}
+		}
+		gl->FragColor = glm::vec4(prefilteredColor / totalWeight, 1.0);
+	}
+};
+
+}
+}
+
+using namespace OpenGL;
+
+namespace {
+
+std::shared_ptr<Texture> createCube(Renderer& renderer, int size, bool mipmaps) {
+	TextureDesc desc{};
+	desc.width = size;
+	desc.height = size;
+	desc.type = TextureType_CUBE;
+	desc.format = TextureFormat_RGBA8;
+	desc.usage = TextureUsage_Sampler | TextureUsage_AttachmentColor;
+	desc.useMipmaps = mipmaps;
+	auto tex = renderer.createTexture(desc);
+
+	SamplerDesc sampler{};
+	sampler.filterMin = mipmaps ? Filter_LINEAR_MIPMAP_LINEAR : Filter_LINEAR;
+	sampler.filterMag = Filter_LINEAR;
+	tex->setSamplerDesc(sampler);
+	tex->initImageData();
+	return tex;
+}
+
+// 程序生成的环境：包含低频的天空渐变、高亮的小面积光源和高频的地面纹理
+std::shared_ptr<Texture> createProceduralCube(Renderer& renderer, int size) {
+	auto tex = createCube(renderer, size, false);
+	auto* cube = dynamic_cast<TextureSoft<RGBA> *>(tex.get());
+	const glm::vec3 sunDir = glm::normalize(glm::vec3(0.4f, 0.6f, -0.7f));
+	for (int face = 0; face < 6; face++) {
+		auto& buffer = cube->getImage((CubeMapFace)face).getBuffer(0)->buffer;
+		for (int y = 0; y < size; y++) {
+			for (int x = 0; x < size; x++) {
+				glm::vec3 dir = glm::normalize(BaseSamplerCube<RGBA>::convertUV2XYZ(face, (x + 0.5f) / size, (y + 0.5f) / size));
+				glm::vec3 color;
+				if (dir.y >= 0.f) {
+					color = glm::mix(glm::vec3(0.75f, 0.85f, 1.0f), glm::vec3(0.2f, 0.4f, 0.85f), dir.y);
+					if (glm::dot(dir, sunDir) > 0.995f) {
+						color = glm::vec3(1.f);
+					}
+				}
+				else {
+					glm::vec2 p = glm::vec2(dir.x, dir.z) / -dir.y;
+					bool checker = ((int)std::floor(p.x * 4.f) + (int)std::floor(p.y * 4.f)) & 1;
+					color = checker ? glm::vec3(0.55f, 0.5f, 0.4f) : glm::vec3(0.15f, 0.12f, 0.1f);
+				}
+				color = color * 255.f + 0.5f;
+				buffer->set(x, y, RGBA((uint8_t)color.r, (uint8_t)color.g, (uint8_t)color.b, 255));
+			}
+		}
+	}
+	return tex;
+}
+
+std::shared_ptr<Texture> loadEquirectCube(const std::shared_ptr<Renderer>& renderer, IBLGenerator& generator,
+                                          const std::string& path, int size) {
+	auto buffer = ImageUtils::readImageRGBA(path);
+	if (!buffer) {
+		return nullptr;
+	}
+
+	TextureDesc desc{};
+	desc.width = (int)buffer->getWidth();
+	desc.height = (int)buffer->getHeight();
+	desc.type = TextureType_2D;
+	desc.format = TextureFormat_RGBA8;
+	desc.usage = TextureUsage_Sampler;
+	auto tex2d = renderer->createTexture(desc);
+	SamplerDesc sampler{};
+	sampler.filterMin = Filter_LINEAR;
+	sampler.filterMag = Filter_LINEAR;
+	tex2d->setSamplerDesc(sampler);
+	tex2d->setImageData({ buffer });
+	tex2d->tag = path;
+
+	auto texCube = createCube(*renderer, size, false);
+	bool success = generator.convertEquirectangular([](ShaderProgram& program) -> bool {
+		auto* programSoft = dynamic_cast<ShaderProgramSoft*>(&program);
+		return programSoft->SetShaders(std::make_shared<ShaderSkybox::VS>(), std::make_shared<ShaderSkybox::FS>());
+	}, tex2d, texCube);
+	return success ? texCube : nullptr;
+}
+
+// 生成时每个工作线程创建自己的着色器程序，reference为true时使用原先的片段着色器
+double generate(IBLGenerator& generator, const std::shared_ptr<Texture>& texIn, std::shared_ptr<Texture>& texOut,
+                bool reference) {
+	auto start = std::chrono::steady_clock::now();
+	generator.generatePrefilterMap([&](ShaderProgram& program) -> bool {
+		auto* programSoft = dynamic_cast<ShaderProgramSoft*>(&program);
+		std::shared_ptr<ShaderSoft> fs = reference ? std::shared_ptr<ShaderSoft>(std::make_shared<ShaderIBLPrefilter::ReferenceFS>())
+		                                           : std::make_shared<ShaderIBLPrefilter::FS>();
+		return programSoft->SetShaders(std::make_shared<ShaderIBLPrefilter::VS>(), fs);
+	}, texIn, texOut);
+	generator.clearCaches();
+	return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+}
+
+int main(int argc, char** argv) {
+	std::string equirectPath;
+	int cubeSize = 256;
+	for (int i = 1; i < argc; i++) {
+		std::string arg = argv[i];
+		if (arg == "--equirect" && i + 1 < argc) {
+			equirectPath = argv[++i];
+		}
+		else if (arg == "--size" && i + 1 < argc) {
+			cubeSize = atoi(argv[++i]);
+		}
+	}
+
+	auto renderer = std::make_shared<RendererSoft>();
+	renderer->create();
+	IBLGenerator generator(renderer);
+
+	auto texEnv = equirectPath.empty() ? createProceduralCube(*renderer, cubeSize)
+	                                   : loadEquirectCube(renderer, generator, equirectPath, cubeSize);
+	if (!texEnv) {
+		printf("create environment cube map failed\n");
+		return 1;
+	}
+	texEnv->tag = "IBLPrefilterBenchmark." + std::to_string(std::chrono::system_clock::now().time_since_epoch().count());
+	printf("environment: %s, %dx%d per face\n", equirectPath.empty() ? "procedural" : equirectPath.c_str(),
+	       texEnv->width, texEnv->height);
+
+	auto texRef = createCube(*renderer, kPrefilterMapSize, true);
+	auto texNew = createCube(*renderer, kPrefilterMapSize, true);
+	double msRef = generate(generator, texEnv, texRef, true);
+	texEnv->tag += ".table";
+	double msNew = generate(generator, texEnv, texNew, false);
+
+	printf("reference (1024 samples, level 0): %9.1f ms\n", msRef);
+	printf("table + FIS (%u samples, mipmap): %9.1f ms  (%.1fx)\n", ShaderIBLPrefilter::kPrefilterSampleCount, msNew, msRef / msNew);
+
+	// 逐级比较：PSNR与最大通道误差（8位）
+	auto* cubeRef = dynamic_cast<TextureSoft<RGBA> *>(texRef.get());
+	auto* cubeNew = dynamic_cast<TextureSoft<RGBA> *>(texNew.get());
+	printf("level  roughness    PSNR(dB)  max diff\n");
+	for (int level = 0; level < kPrefilterMaxMipLevels; level++) {
+		double sqErr = 0.0;
+		size_t count = 0;
+		int maxDiff = 0;
+		for (int face = 0; face < 6; face++) {
+			auto& bufRef = cubeRef->getImage((CubeMapFace)face).getBuffer(level)->buffer;
+			auto& bufNew = cubeNew->getImage((CubeMapFace)face).getBuffer(level)->buffer;
+			for (size_t y = 0; y < bufRef->getHeight(); y++) {
+				for (size_t x = 0; x < bufRef->getWidth(); x++) {
+					RGBA* a = bufRef->get(x, y);
+					RGBA* b = bufNew->get(x, y);
+					for (int c = 0; c < 3; c++) {
+						int diff = std::abs((int)(*a)[c] - (int)(*b)[c]);
+						sqErr += (double)diff * diff;
+						maxDiff = std::max(maxDiff, diff);
+						count++;
+					}
+				}
+			}
+		}
+		double mse = sqErr / (double)count;
+		double psnr = mse > 0.0 ? 10.0 * std::log10(255.0 * 255.0 / mse) : INFINITY;
+		printf("%5d  %9.2f  %10.2f  %8d\n", level, (float)level / (float)(kPrefilterMaxMipLevels - 1), psnr, maxDiff);
+	}
+	return 0;
+}
@@ -0,0 +1,232 @@
+// IBL生成的精度测试，任一检查失败时返回1
+//  - 球谐irradiance map与逐像素半球卷积（generateIrradianceMap）的结果在误差范围内一致
+//  - 软件渲染逐texel直接执行着色器的立方体贴图生成与逐面光栅化的结果在误差范围内一致
+// 不读写./cache/IBL/，每次都实际生成
+#include <cmath>
+#include <cstdio>
+#include <functional>
+#include "Render/Software/RendererSoft.h"
+#include "Render/Software/TextureSoft.h"
+#include "Viewer/Environment.h"
+#include "Viewer/Shader/Software/ShaderSoft.h"
+
+using namespace OpenGL;
+
+namespace {
+
+int failedCnt = 0;
+
+void check(bool condition, const char* name) {
+	printf("[%s] %s\n", condition ? "PASS" : "FAIL", name);
+	if (!condition) {
+		failedCnt++;
+	}
+}
+
+std::shared_ptr<Texture> createCube(Renderer& renderer, int size, bool mipmaps) {
+	TextureDesc desc{};
+	desc.width = size;
+	desc.height = size;
+	desc.type = TextureType_CUBE;
+	desc.format = TextureFormat_RGBA8;
+	desc.usage = TextureUsage_Sampler | TextureUsage_AttachmentColor;
+	desc.useMipmaps = mipmaps;
+	auto tex = renderer.createTexture(desc);
+
+	SamplerDesc sampler{};
+	sampler.filterMin = mipmaps ? Filter_LINEAR_MIPMAP_LINEAR : Filter_LINEAR;
+	sampler.filterMag = Filter_LINEAR;
+	tex->setSamplerDesc(sampler);
+	tex->initImageData();
+	return tex;
+}
+
+// 合成的环境：天空渐变、一块较亮但不饱和的光源区域和暗色地面，颜色各通道不同
+glm::vec3 environmentColor(const glm::vec3& dir) {
+	const glm::vec3 lightDir = glm::normalize(glm::vec3(0.5f, 0.6f, -0.6f));
+	glm::vec3 color = dir.y >= 0.f ? glm::mix(glm::vec3(0.6f, 0.7f, 0.8f), glm::vec3(0.15f, 0.3f, 0.7f), dir.y)
+	                               : glm::vec3(0.3f, 0.22f, 0.12f);
+	if (glm::dot(dir, lightDir) > 0.9f) {
+		color = glm::vec3(0.95f, 0.9f, 0.75f);
+	}
+	return color;
+}
+
+std::shared_ptr<Texture> createEnvironmentCube(Renderer& renderer, int size) {
+	auto tex = createCube(renderer, size, false);
+	auto* cube = dynamic_cast<TextureSoft<RGBA> *>(tex.get());
+	for (int face = 0; face < 6; face++) {
+		auto& buffer = cube->getImage((CubeMapFace)face).getBuffer(0)->buffer;
+		for (int y = 0; y < size; y++) {
+			for (int x = 0; x < size; x++) {
+				glm::vec3 dir = glm::normalize(BaseSamplerCube<RGBA>::convertUV2XYZ(face, (x + 0.5f) / size, (y + 0.5f) / size));
+				glm::vec3 color = environmentColor(dir) * 255.f + 0.5f;
+				buffer->set(x, y, RGBA((uint8_t)color.r, (uint8_t)color.g, (uint8_t)color.b, 255));
+			}
+		}
+	}
+	tex->tag = "IBLTest.environment";
+	return tex;
+}
+
+struct CubeDiff {
+	int maxDiff = 0;
+	double meanDiff = 0.0;
+};
+
+// 比较两个立方体贴图第level级的所有面，返回RGB通道的最大与平均差值（8位）
+CubeDiff compareCube(const std::shared_ptr<Texture>& a, const std::shared_ptr<Texture>& b, int level = 0) {
+	auto* cubeA = dynamic_cast<TextureSoft<RGBA> *>(a.get());
+	auto* cubeB = dynamic_cast<TextureSoft<RGBA> *>(b.get());
+	CubeDiff diff;
+	size_t count = 0;
+	for (int face = 0; face < 6; face++) {
+		auto& bufA = cubeA->getImage((CubeMapFace)face).getBuffer(level)->buffer;
+		auto& bufB = cubeB->getImage((CubeMapFace)face).getBuffer(level)->buffer;
+		for (size_t y = 0; y < bufA->getHeight(); y++) {
+			for (size_t x = 0; x < bufA->getWidth(); x++) {
+				RGBA* ca = bufA->get(x, y);
+				RGBA* cb = bufB->get(x, y);
+				for (int c = 0; c < 3; c++) {
+					int d = std::abs((int)(*ca)[c] - (int)(*cb)[c]);
+					diff.maxDiff = std::max(diff.maxDiff, d);
+					diff.meanDiff += d;
+					count++;
+				}
+			}
+		}
+	}
+	diff.meanDiff /= (double)count;
+	return diff;
+}
+
+bool shaderIrradiance(ShaderProgram& program) {
+	auto* programSoft = dynamic_cast<ShaderProgramSoft*>(&program);
+	return programSoft->SetShaders(std::make_shared<ShaderIBLIrradiance::VS>(), std::make_shared<ShaderIBLIrradiance::FS>());
+}
+
+// 二阶球谐对余弦卷积的截断误差理论上不超过辐照度的约3%，参考结果的半球积分步长也有一定误差，
+// 这里允许单个texel最多相差6（8位），平均不超过1.5
+void testIrradianceSH(const std::shared_ptr<RendererSoft>& renderer, IBLGenerator& generator,
+                      const std::shared_ptr<Texture>& texEnv) {
+	auto texReference = createCube(*renderer, 16, false);
+	auto texSH = createCube(*renderer, 16, false);
+	bool success = generator.generateIrradianceMap(shaderIrradiance, texEnv, texReference)
+		&& generator.generateIrradianceMapSH(texEnv, texSH);
+	check(success, "generate irradiance maps");
+	if (!success) {
+		return;
+	}
+
+	CubeDiff diff = compareCube(texSH, texReference);
+	printf("irradiance SH vs convolution: max diff %d, mean diff %.3f\n", diff.maxDiff, diff.meanDiff);
+	check(diff.maxDiff <= 6 && diff.meanDiff <= 1.5, "SH irradiance matches convolution");
+}
+
+// 等距柱状投影的环境贴图，与createEnvironmentCube使用相同的合成环境
+std::shared_ptr<Texture> createEnvironmentEquirect(Renderer& renderer, int width, int height) {
+	auto buffer = Buffer<RGBA>::makeDefault(width, height);
+	for (int y = 0; y < height; y++) {
+		for (int x = 0; x < width; x++) {
+			float phi = ((x + 0.5f) / width - 0.5f) * 2.f * glm::pi<float>();
+			float theta = ((y + 0.5f) / height - 0.5f) * glm::pi<float>();
+			glm::vec3 dir(std::cos(theta) * std::cos(phi), std::sin(theta), std::cos(theta) * std::sin(phi));
+			glm::vec3 color = environmentColor(dir) * 255.f + 0.5f;
+			buffer->set(x, y, RGBA((uint8_t)color.r, (uint8_t)color.g, (uint8_t)color.b, 255));
+		}
+	}
+
+	TextureDesc desc{};
+	desc.width = width;
+	desc.height = height;
+	desc.type = TextureType_2D;
+	desc.format = TextureFormat_RGBA8;
+	desc.usage = TextureUsage_Sampler;
+	auto tex = renderer.createTexture(desc);
+	SamplerDesc sampler{};
+	sampler.filterMin = Filter_LINEAR;
+	sampler.filterMag = Filter_LINEAR;
+	tex->setSamplerDesc(sampler);
+	tex->setImageData({ buffer });
+	tex->tag = "IBLTest.equirect";
+	return tex;
+}
+
+bool shaderSkybox(ShaderProgram& program) {
+	auto* programSoft = dynamic_cast<ShaderProgramSoft*>(&program);
+	return programSoft->SetShaders(std::make_shared<ShaderSkybox::VS>(), std::make_shared<ShaderSkybox::FS>());
+}
+
+bool shaderPrefilter(ShaderProgram& program) {
+	auto* programSoft = dynamic_cast<ShaderProgramSoft*>(&program);
+	return programSoft->SetShaders(std::make_shared<ShaderIBLPrefilter::VS>(), std::make_shared<ShaderIBLPrefilter::FS>());
+}
+
+// 直接计算的方向为texel中心，光栅化时由三角形顶点插值得到，二者只有浮点舍入差异。
+// 目前两条路径的结果完全相同，容差只为舍入改变个别texel的取整留出余量
+void testDirectSoft(const std::shared_ptr<RendererSoft>& renderer, IBLGenerator& generator,
+                    const std::shared_ptr<Texture>& texEnv) {
+	using Generate = std::function<bool(IBLGenerator& generator, std::shared_ptr<Texture>& texOut)>;
+	struct Case {
+		const char* name;
+		int size;
+		bool mipmaps;
+		Generate generate;
+	};
+	auto texEquirect = createEnvironmentEquirect(*renderer, 128, 64);
+	const Case cases[] = {
+		{ "equirect to cube", 32, false, [&](IBLGenerator& g, std::shared_ptr<Texture>& texOut) {
+			return g.convertEquirectangular(shaderSkybox, texEquirect, texOut);
+		} },
+		{ "irradiance", 16, false, [&](IBLGenerator& g, std::shared_ptr<Texture>& texOut) {
+			return g.generateIrradianceMap(shaderIrradiance, texEnv, texOut);
+		} },
+		{ "prefilter", 32, true, [&](IBLGenerator& g, std::shared_ptr<Texture>& texOut) {
+			return g.generatePrefilterMap(shaderPrefilter, texEnv, texOut);
+		} },
+	};
+
+	for (auto& c : cases) {
+		auto texDirect = createCube(*renderer, c.size, c.mipmaps);
+		auto texRaster = createCube(*renderer, c.size, c.mipmaps);
+		generator.setEnableDirectSoft(true);
+		bool success = c.generate(generator, texDirect);
+		generator.setEnableDirectSoft(false);
+		success = c.generate(generator, texRaster) && success;
+		generator.setEnableDirectSoft(true);
+		generator.clearCaches();
+
+		char name[64];
+		snprintf(name, sizeof(name), "generate %s", c.name);
+		check(success, name);
+		if (!success) {
+			continue;
+		}
+		int levelCnt = c.mipmaps ? kPrefilterMaxMipLevels : 1;
+		for (int level = 0; level < levelCnt; level++) {
+			CubeDiff diff = compareCube(texDirect, texRaster, level);
+			printf("%s level %d direct vs raster: max diff %d, mean diff %.3f\n", c.name, level, diff.maxDiff, diff.meanDiff);
+			snprintf(name, sizeof(name), "%s level %d direct matches raster", c.name, level);
+			check(diff.maxDiff <= 2 && diff.meanDiff <= 0.1, name);
+		}
+	}
+}
+}
+
+int main() {
+	auto renderer = std::make_shared<RendererSoft>();
+	renderer->create();
+	IBLGenerator generator(renderer);
+	generator.setEnableCache(false);
+
+	auto texEnv = createEnvironmentCube(*renderer, 32);
+	testIrradianceSH(renderer, generator, texEnv);
+	testDirectSoft(renderer, generator, texEnv);
+
+	if (failedCnt > 0) {
+		printf("%d check(s) failed\n", failedCnt);
+		return 1;
+	}
+	printf("all checks passed\n");
+	return 0;
+}
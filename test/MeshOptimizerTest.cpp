@@ -0,0 +1,174 @@
+// 网格优化测试，任一检查失败时返回1
+//  - 焊接、Tipsify、overdraw排序、顶点读取重排后三角形集合（含绕序）不变
+//  - 焊接重复顶点后顶点数等于不同顶点数，优化后ACMR不高于焊接后的原始顺序
+//  - overdraw只在显式请求时统计
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdio>
+#include <random>
+#include "Viewer/MeshOptimizer.h"
+
+using namespace OpenGL;
+
+namespace {
+
+int failedCnt = 0;
+
+void check(bool condition, const char* name) {
+	printf("[%s] %s\n", condition ? "PASS" : "FAIL", name);
+	if (!condition) {
+		failedCnt++;
+	}
+}
+
+// 经纬度球面的三角形列表，每个三角形使用独立的3个顶点（与未焊接的导入结果一样），三角形顺序随机打乱。
+// 经度接缝和两极处的顶点位置相同但纹理坐标不同，不应被焊接
+void createSphereSoup(int rings, int segments, std::vector<Vertex>& vertexes, std::vector<int32_t>& indices,
+                      size_t& uniqueCnt) {
+	auto gridVertex = [&](int ring, int segment) {
+		float theta = glm::pi<float>() * (float)ring / (float)rings;
+		float phi = 2.f * glm::pi<float>() * (float)segment / (float)segments;
+		Vertex vertex{};
+		vertex.a_position = glm::vec3(std::sin(theta) * std::cos(phi), std::cos(theta), std::sin(theta) * std::sin(phi));
+		vertex.a_normal = vertex.a_position;
+		vertex.a_texCoord = glm::vec2((float)segment / (float)segments, (float)ring / (float)rings);
+		return vertex;
+	};
+
+	std::vector<std::array<Vertex, 3>> triangles;
+	for (int ring = 0; ring < rings; ring++) {
+		for (int segment = 0; segment < segments; segment++) {
+			Vertex v00 = gridVertex(ring, segment);
+			Vertex v01 = gridVertex(ring, segment + 1);
+			Vertex v10 = gridVertex(ring + 1, segment);
+			Vertex v11 = gridVertex(ring + 1, segment + 1);
+			if (ring > 0) {
+				triangles.push_back({ v00, v01, v10 });
+			}
+			if (ring < rings - 1) {
+				triangles.push_back({ v01, v11, v10 });
+			}
+		}
+	}
+	std::mt19937 rng(25);
+	std::shuffle(triangles.begin(), triangles.end(), rng);
+
+	vertexes.clear();
+	indices.clear();
+	for (auto& triangle : triangles) {
+		for (auto& vertex : triangle) {
+			indices.push_back((int32_t)vertexes.size());
+			vertexes.push_back(vertex);
+		}
+	}
+	// 两极各有segments个顶点，中间rings - 1圈各有segments + 1个顶点（接缝处重复）
+	uniqueCnt = 2 * (size_t)segments + (size_t)(rings - 1) * (segments + 1);
+}
+
+using VertexKey = std::array<float, 8>;
+using TriangleKey = std::array<VertexKey, 3>;
+
+VertexKey vertexKey(const Vertex& v) {
+	return { v.a_position.x, v.a_position.y, v.a_position.z, v.a_normal.x, v.a_normal.y, v.a_normal.z,
+	         v.a_texCoord.x, v.a_texCoord.y };
+}
+
+// 所有三角形按顶点属性排序后的列表，每个三角形轮换为最小的顶点在前（保持绕序）
+std::vector<TriangleKey> triangleSet(const std::vector<Vertex>& vertexes, const std::vector<int32_t>& indices) {
+	std::vector<TriangleKey> triangles;
+	for (size_t i = 0; i + 2 < indices.size(); i += 3) {
+		TriangleKey key = { vertexKey(vertexes[indices[i]]), vertexKey(vertexes[indices[i + 1]]),
+		                    vertexKey(vertexes[indices[i + 2]]) };
+		std::rotate(key.begin(), std::min_element(key.begin(), key.end()), key.end());
+		triangles.push_back(key);
+	}
+	std::sort(triangles.begin(), triangles.end());
+	return triangles;
+}
+
+void testWeld() {
+	std::vector<Vertex> vertexes;
+	std::vector<int32_t> indices;
+	size_t uniqueCnt = 0;
+	createSphereSoup(12, 16, vertexes, indices, uniqueCnt);
+	auto trianglesBefore = triangleSet(vertexes, indices);
+
+	size_t weldedCnt = MeshOptimizer::weldVertexes(vertexes, indices);
+	check(weldedCnt == uniqueCnt && vertexes.size() == uniqueCnt, "weld merges duplicated vertexes");
+	check(triangleSet(vertexes, indices) == trianglesBefore, "weld preserves triangles");
+}
+
+// 每一步单独执行，三角形集合都不变；焊接后的原始顺序（随机）作为ACMR的对照
+void testOptimizeSteps() {
+	std::vector<Vertex> vertexes;
+	std::vector<int32_t> indices;
+	size_t uniqueCnt = 0;
+	createSphereSoup(12, 16, vertexes, indices, uniqueCnt);
+	auto trianglesBefore = triangleSet(vertexes, indices);
+	MeshOptimizer::weldVertexes(vertexes, indices);
+	float acmrWelded = MeshOptimizer::analyzeVertexCache(indices, vertexes.size());
+
+	MeshOptimizer::optimizeVertexCache(indices, vertexes.size());
+	float acmrCache = MeshOptimizer::analyzeVertexCache(indices, vertexes.size());
+	check(triangleSet(vertexes, indices) == trianglesBefore, "vertex cache order preserves triangles");
+	printf("ACMR: welded %.3f, tipsify %.3f\n", acmrWelded, acmrCache);
+	check(acmrCache <= acmrWelded, "vertex cache order does not increase ACMR");
+
+	MeshOptimizer::optimizeOverdraw(indices, vertexes);
+	check(triangleSet(vertexes, indices) == trianglesBefore, "overdraw order preserves triangles");
+
+	MeshOptimizer::optimizeVertexFetch(vertexes, indices);
+	check(triangleSet(vertexes, indices) == trianglesBefore, "vertex fetch order preserves triangles");
+	int32_t nextIdx = 0;
+	bool firstUseOrder = vertexes.size() == uniqueCnt;
+	for (int32_t idx : indices) {
+		if (idx == nextIdx) {
+			nextIdx++;
+		}
+		firstUseOrder = firstUseOrder && idx < nextIdx;
+	}
+	check(firstUseOrder && nextIdx == (int32_t)vertexes.size(), "vertex fetch order follows first use");
+}
+
+void testOptimize() {
+	std::vector<Vertex> vertexes;
+	std::vector<int32_t> indices;
+	size_t uniqueCnt = 0;
+	createSphereSoup(12, 16, vertexes, indices, uniqueCnt);
+	auto trianglesBefore = triangleSet(vertexes, indices);
+
+	// 焊接后原始顺序的ACMR，优化结果不应比它更差
+	std::vector<Vertex> weldedVertexes = vertexes;
+	std::vector<int32_t> weldedIndices = indices;
+	MeshOptimizer::weldVertexes(weldedVertexes, weldedIndices);
+	float acmrWelded = MeshOptimizer::analyzeVertexCache(weldedIndices, weldedVertexes.size());
+
+	MeshOptimizeStats stats;
+	MeshOptimizer::optimize(vertexes, indices, &stats);
+	check(triangleSet(vertexes, indices) == trianglesBefore, "optimize preserves triangles");
+	check(stats.triangleCnt == trianglesBefore.size() && stats.vertexCntAfter == uniqueCnt, "optimize stats counts");
+	printf("ACMR: input %.3f, welded %.3f, optimized %.3f\n", stats.acmrBefore, acmrWelded, stats.acmrAfter);
+	check(stats.acmrAfter <= stats.acmrBefore && stats.acmrAfter <= acmrWelded, "optimize does not increase ACMR");
+	check(stats.overdrawBefore == 0.f && stats.overdrawAfter == 0.f, "overdraw not analyzed by default");
+
+	createSphereSoup(12, 16, vertexes, indices, uniqueCnt);
+	MeshOptimizeStats statsOverdraw;
+	MeshOptimizer::optimize(vertexes, indices, &statsOverdraw, true);
+	check(statsOverdraw.overdrawBefore >= 1.f && statsOverdraw.overdrawAfter >= 1.f, "overdraw analyzed on request");
+}
+
+}
+
+int main() {
+	testWeld();
+	testOptimizeSteps();
+	testOptimize();
+
+	if (failedCnt > 0) {
+		printf("%d check(s) failed\n", failedCnt);
+		return 1;
+	}
+	printf("all checks passed\n");
+	return 0;
+}
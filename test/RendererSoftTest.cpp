@@ -0,0 +1,634 @@
+// 软件渲染器行为测试，任一检查失败时返回1
+//  - 光栅化：共享边的相邻三角形不重复、不遗漏采样点（watertight），恰好落在边上的采样点按top-left规则归属
+//  - SIMD：各指令集级别的内核渲染同一帧，结果与标量内核一致（只允许FMA带来的舍入差异）。
+//    ctest中另以SOFTGL_SIMD=scalar运行一次，检查强制的级别生效，且不依赖AVX2的路径能完整渲染一帧
+//  - 多重采样：2x/4x/8x下开关采样点压缩的解析结果完全一致
+//  - 延迟清除：开关延迟清除的颜色、深度完全一致
+//  - early z与分层深度剔除：各深度比较函数、深度清除为0和1时开关结果完全一致
+//  - 线框/点模式：共享边和共享顶点只绘制一次，开关MSAA结果相同
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <set>
+#include "Render/Software/RendererSoft.h"
+#include "Render/Software/SIMDKernelsSoft.h"
+#include "Render/Software/TextureSoft.h"
+#include "Viewer/Model.h"
+
+namespace OpenGL {
+namespace ShaderTestColor {
+
+struct ShaderDefines {
+};
+
+// 与Vertex的布局一致，a_normal作为顶点颜色
+struct ShaderAttributes {
+	glm::vec3 a_position;
+	glm::vec2 a_texCoord;
+	glm::vec3 a_normal;
+	glm::vec3 a_tangent;
+};
+
+struct ShaderUniforms {
+	glm::vec4 u_color;
+};
+
+struct ShaderVaryings {
+	glm::vec3 v_color;
+};
+
+class ShaderTestColor : public ShaderSoft {
+public:
+	CREATE_SHADER_OVERRIDE
+
+	std::vector<std::string>& getDefines() override {
+		static std::vector<std::string> defines;
+		return defines;
+	}
+
+	std::vector<UniformDesc>& getUniformsDesc() override {
+		static std::vector<UniformDesc> desc = {
+			{"UniformsTestColor", offsetof(ShaderUniforms, u_color)},
+		};
+		return desc;
+	}
+};
+
+// 顶点坐标直接作为NDC坐标
+class VS : public ShaderTestColor {
+public:
+	CREATE_SHADER_CLONE(VS)
+
+	void shaderMain() override {
+		gl->Position = glm::vec4(a->a_position, 1.0);
+		v->v_color = a->a_normal;
+	}
+};
+
+class FS : public ShaderTestColor {
+public:
+	CREATE_SHADER_CLONE(FS)
+
+	void shaderMain() override {
+		gl->FragColor = glm::vec4(v->v_color, 1.0) * u->u_color;
+	}
+};
+
+}
+}
+
+using namespace OpenGL;
+
+namespace {
+
+int failedCnt = 0;
+
+void check(bool condition, const char* name) {
+	printf("[%s] %s\n", condition ? "PASS" : "FAIL", name);
+	if (!condition) {
+		failedCnt++;
+	}
+}
+
+struct DrawCall {
+	ModelMesh mesh;
+	glm::vec4 color = glm::vec4(1.f);
+	RenderStates states;
+};
+
+// 只清除颜色缓冲（清除为0）
+ClearStates colorClearStates() {
+	ClearStates clearStates{};
+	clearStates.colorFlag = true;
+	return clearStates;
+}
+
+// 以单位变换绘制若干网格，返回解析后的颜色缓冲区（第0行为图像底部）。
+// clearStates.depthFlag为true时附加与颜色缓冲采样数相同的深度缓冲，单采样时可通过depthOut取回深度值
+std::shared_ptr<Buffer<RGBA>> renderFrame(RendererSoft& renderer, int width, int height, int samples,
+                                          std::vector<DrawCall>& draws,
+                                          const ClearStates& clearStates = colorClearStates(),
+                                          std::shared_ptr<Buffer<float>>* depthOut = nullptr) {
+	TextureDesc desc{};
+	desc.width = width;
+	desc.height = height;
+	desc.type = TextureType_2D;
+	desc.format = TextureFormat_RGBA8;
+	desc.usage = TextureUsage_AttachmentColor | TextureUsage_RendererOutput;
+	desc.multiSample = samples > 1;
+	desc.sampleCount = samples;
+	auto texColor = renderer.createTexture(desc);
+	texColor->initImageData();
+
+	auto fbo = renderer.createFrameBuffer(true);
+	fbo->setColorAttachment(texColor, 0);
+
+	std::shared_ptr<Texture> texDepth;
+	if (clearStates.depthFlag) {
+		desc.format = TextureFormat_FLOAT32;
+		desc.usage = TextureUsage_AttachmentDepth;
+		texDepth = renderer.createTexture(desc);
+		texDepth->initImageData();
+		fbo->setDepthAttachment(texDepth);
+	}
+
+	auto program = renderer.createShaderProgram();
+	dynamic_cast<ShaderProgramSoft*>(program.get())->SetShaders(std::make_shared<ShaderTestColor::VS>(),
+	                                                            std::make_shared<ShaderTestColor::FS>());
+
+	renderer.beginRenderPass(fbo, clearStates);
+	renderer.setViewPort(0, 0, width, height);
+	for (auto& draw : draws) {
+		draw.mesh.InitVertexes();
+		auto vao = renderer.createVertexArrayObject(draw.mesh);
+		auto uniformBlock = renderer.createUniformBlock("UniformsTestColor", sizeof(ShaderTestColor::ShaderUniforms));
+		uniformBlock->setData(&draw.color, sizeof(glm::vec4));
+		auto resources = std::make_shared<ShaderResources>();
+		resources->blocks[0] = uniformBlock;
+		auto pipelineStates = renderer.createPipelineStates(draw.states);
+
+		renderer.setVertexArrayObject(vao);
+		renderer.setShaderProgram(program);
+		renderer.setShaderResources(resources);
+		renderer.setPipelineStates(pipelineStates);
+		renderer.draw();
+	}
+	renderer.endRenderPass();
+
+	if (depthOut && texDepth && samples == 1) {
+		*depthOut = dynamic_cast<TextureSoft<float> *>(texDepth.get())->getImage().getBuffer()->buffer;
+	}
+	return dynamic_cast<TextureSoft<RGBA> *>(texColor.get())->getImage().getBuffer()->buffer;
+}
+
+// 返回两个颜色缓冲区各通道的最大差值
+int maxColorDiff(const std::shared_ptr<Buffer<RGBA>>& a, const std::shared_ptr<Buffer<RGBA>>& b) {
+	int maxDiff = 0;
+	for (size_t y = 0; y < a->getHeight(); y++) {
+		for (size_t x = 0; x < a->getWidth(); x++) {
+			RGBA* ca = a->get(x, y);
+			RGBA* cb = b->get(x, y);
+			for (int c = 0; c < 4; c++) {
+				maxDiff = std::max(maxDiff, std::abs((int)(*ca)[c] - (int)(*cb)[c]));
+			}
+		}
+	}
+	return maxDiff;
+}
+
+// 随机三角形：不透明一批，alpha混合一批，覆盖插值、颜色写入、混合与MSAA解析等SIMD内核
+std::vector<DrawCall> createRandomScene() {
+	std::mt19937 rng(20261017);
+	std::uniform_real_distribution<float> pos(-1.2f, 1.2f);
+	std::uniform_real_distribution<float> color(0.f, 1.f);
+
+	std::vector<DrawCall> draws(2);
+	for (auto& draw : draws) {
+		draw.mesh.primitiveType = Primitive_TRIANGLE;
+		draw.mesh.primitiveCnt = 64;
+		for (size_t i = 0; i < draw.mesh.primitiveCnt * 3; i++) {
+			Vertex vertex{};
+			vertex.a_position = glm::vec3(pos(rng), pos(rng), 0.f);
+			vertex.a_normal = glm::vec3(color(rng), color(rng), color(rng));
+			draw.mesh.vertexes.push_back(vertex);
+			draw.mesh.indices.push_back((int32_t)i);
+		}
+	}
+	draws[1].color = glm::vec4(1.f, 1.f, 1.f, 0.5f);
+	draws[1].states.blend = true;
+	draws[1].states.blendParams.SetBlendFactor(BlendFactor_SRC_ALPHA, BlendFactor_ONE_MINUS_SRC_ALPHA);
+	return draws;
+}
+
+// 在NDC坐标中添加一个顶点颜色相同的三角形
+void addColorTriangle(ModelMesh& mesh, glm::vec3 p0, glm::vec3 p1, glm::vec3 p2, glm::vec3 color) {
+	for (auto& pos : { p0, p1, p2 }) {
+		Vertex vertex{};
+		vertex.a_position = pos;
+		vertex.a_normal = color;
+		mesh.indices.push_back((int32_t)mesh.vertexes.size());
+		mesh.vertexes.push_back(vertex);
+	}
+	mesh.primitiveType = Primitive_TRIANGLE;
+	mesh.primitiveCnt++;
+}
+
+// 两个斜边交叉的大三角形：不透明三角形的斜边使边缘像素部分覆盖，半透明三角形在其上混合，
+// 交叉处的像素既部分覆盖又经过混合
+std::vector<DrawCall> createEdgeScene() {
+	std::vector<DrawCall> draws(2);
+	addColorTriangle(draws[0].mesh, { -0.8f, -0.7f, 0.f }, { 0.7f, -0.3f, 0.f }, { -0.2f, 0.85f, 0.f },
+	                 { 1.f, 0.2f, 0.1f });
+	addColorTriangle(draws[1].mesh, { -0.9f, 0.6f, 0.f }, { 0.2f, -0.9f, 0.f }, { 0.9f, 0.1f, 0.f },
+	                 { 0.1f, 0.8f, 0.4f });
+	draws[1].color = glm::vec4(1.f, 1.f, 1.f, 0.5f);
+	draws[1].states.blend = true;
+	draws[1].states.blendParams.SetBlendFactor(BlendFactor_SRC_ALPHA, BlendFactor_ONE_MINUS_SRC_ALPHA);
+	return draws;
+}
+
+// NDC坐标中的点或线段图元，每个图元顶点数为primitiveType对应的数量
+DrawCall createPrimitiveDraw(PrimitiveType type, const std::vector<glm::vec3>& positions, glm::vec3 color) {
+	DrawCall draw;
+	draw.mesh.primitiveType = type;
+	for (auto& pos : positions) {
+		Vertex vertex{};
+		vertex.a_position = pos;
+		vertex.a_normal = color;
+		draw.mesh.indices.push_back((int32_t)draw.mesh.vertexes.size());
+		draw.mesh.vertexes.push_back(vertex);
+	}
+	draw.mesh.primitiveCnt = positions.size() / (type == Primitive_LINE ? 2 : 1);
+	draw.states.primitiveType = type;
+	return draw;
+}
+
+// 屏幕坐标（像素，原点在左下角）转换为NDC坐标的顶点
+Vertex screenVertex(float x, float y, int width, int height) {
+	Vertex vertex{};
+	vertex.a_position = glm::vec3(x / (float)width * 2.f - 1.f, y / (float)height * 2.f - 1.f, 0.f);
+	vertex.a_normal = glm::vec3(1.f);
+	return vertex;
+}
+
+// 加法混合，每次覆盖使颜色增加0.25：覆盖1次的像素为63，0次为0，多次覆盖或MSAA部分遗漏时为其他值
+DrawCall createCountingDraw() {
+	DrawCall draw;
+	draw.mesh.primitiveType = Primitive_TRIANGLE;
+	draw.color = glm::vec4(0.25f);
+	draw.states.blend = true;
+	draw.states.blendParams.SetBlendFactor(BlendFactor_ONE, BlendFactor_ONE);
+	return draw;
+}
+
+constexpr int kCoveredOnce = 63;
+
+void addTriangle(DrawCall& draw, const Vertex& v0, const Vertex& v1, const Vertex& v2) {
+	for (auto& vertex : { v0, v1, v2 }) {
+		draw.mesh.indices.push_back((int32_t)draw.mesh.vertexes.size());
+		draw.mesh.vertexes.push_back(vertex);
+	}
+	draw.mesh.primitiveCnt++;
+}
+
+// 网格铺满整个视口，内部顶点随机偏移半像素的整数倍（落在像素中心或像素角上），大量边恰好经过像素中心。
+// 每个格子的对角线方向和三角形绕序随机，每个像素（MSAA时每个采样点）都应恰好被覆盖一次
+void testWatertight(RendererSoft& renderer) {
+	const int size = 64;
+	const int cells = 8;
+	const float cellSize = (float)size / (float)cells;
+	std::mt19937 rng(5);
+	std::uniform_int_distribution<int> jitter(-6, 6);
+	std::uniform_int_distribution<int> coin(0, 1);
+
+	glm::vec2 grid[cells + 1][cells + 1];
+	for (int y = 0; y <= cells; y++) {
+		for (int x = 0; x <= cells; x++) {
+			grid[y][x] = glm::vec2(x, y) * cellSize;
+			if (x > 0 && x < cells && y > 0 && y < cells) {
+				grid[y][x] += glm::vec2(jitter(rng), jitter(rng)) * 0.5f;
+			}
+		}
+	}
+
+	std::vector<DrawCall> draws = { createCountingDraw() };
+	auto& draw = draws[0];
+	auto addGridTriangle = [&](glm::vec2 p0, glm::vec2 p1, glm::vec2 p2) {
+		if (coin(rng)) {
+			std::swap(p1, p2);
+		}
+		addTriangle(draw, screenVertex(p0.x, p0.y, size, size), screenVertex(p1.x, p1.y, size, size),
+		            screenVertex(p2.x, p2.y, size, size));
+	};
+	for (int y = 0; y < cells; y++) {
+		for (int x = 0; x < cells; x++) {
+			glm::vec2 p00 = grid[y][x], p10 = grid[y][x + 1], p01 = grid[y + 1][x], p11 = grid[y + 1][x + 1];
+			if (coin(rng)) {
+				addGridTriangle(p00, p10, p11);
+				addGridTriangle(p00, p11, p01);
+			}
+			else {
+				addGridTriangle(p00, p10, p01);
+				addGridTriangle(p10, p11, p01);
+			}
+		}
+	}
+
+	for (int samples : { 1, 4 }) {
+		auto frame = renderFrame(renderer, size, size, samples, draws);
+		int wrongCnt = 0;
+		for (int y = 0; y < size; y++) {
+			for (int x = 0; x < size; x++) {
+				if ((*frame->get(x, y))[0] != kCoveredOnce) {
+					wrongCnt++;
+				}
+			}
+		}
+		char name[64];
+		snprintf(name, sizeof(name), "shared edges are watertight (%dx, %d wrong pixels)", samples, wrongCnt);
+		check(wrongCnt == 0, name);
+	}
+}
+
+// 四个角都在像素中心上的矩形（两个三角形）：左边和下边（y较小的一边，即光栅化坐标中的上边）上的像素中心属于矩形，
+// 右边和上边上的不属于，两种绕序结果相同
+void testTopLeftRule(RendererSoft& renderer) {
+	const int size = 16;
+	const int x0 = 3, y0 = 5, x1 = 9, y1 = 8;
+	for (bool reverse : { false, true }) {
+		std::vector<DrawCall> draws = { createCountingDraw() };
+		Vertex v00 = screenVertex(x0 + 0.5f, y0 + 0.5f, size, size);
+		Vertex v10 = screenVertex(x1 + 0.5f, y0 + 0.5f, size, size);
+		Vertex v01 = screenVertex(x0 + 0.5f, y1 + 0.5f, size, size);
+		Vertex v11 = screenVertex(x1 + 0.5f, y1 + 0.5f, size, size);
+		if (reverse) {
+			addTriangle(draws[0], v00, v11, v10);
+			addTriangle(draws[0], v00, v01, v11);
+		}
+		else {
+			addTriangle(draws[0], v00, v10, v11);
+			addTriangle(draws[0], v00, v11, v01);
+		}
+
+		auto frame = renderFrame(renderer, size, size, 1, draws);
+		int wrongCnt = 0;
+		for (int y = 0; y < size; y++) {
+			for (int x = 0; x < size; x++) {
+				bool expected = x >= x0 && x < x1 && y >= y0 && y < y1;
+				if ((*frame->get(x, y))[0] != (expected ? kCoveredOnce : 0)) {
+					wrongCnt++;
+				}
+			}
+		}
+		check(wrongCnt == 0, reverse ? "top-left rule (clockwise)" : "top-left rule (counter-clockwise)");
+	}
+}
+
+void testSIMDLevels(RendererSoft& renderer) {
+	const char* env = getenv("SOFTGL_SIMD");
+	SIMDLevel active = SIMDDispatch::kernels().level;
+	SIMDLevel request;
+	if (env && CPUFeatures::parseLevel(env, request) && request <= SIMDDispatch::maxLevel()) {
+		check(active == request, "SOFTGL_SIMD selects the kernel level");
+	}
+	printf("simd: active %s, max %s\n", CPUFeatures::levelName(active), CPUFeatures::levelName(SIMDDispatch::maxLevel()));
+
+	for (int samples : { 1, 4 }) {
+		auto draws = createRandomScene();
+		auto frameActive = renderFrame(renderer, 96, 64, samples, draws);
+		bool covered = false;
+		for (size_t i = 0; i < frameActive->getWidth() * frameActive->getHeight() && !covered; i++) {
+			covered = frameActive->getRawDataPtr()[i] != RGBA(0);
+		}
+		check(covered, samples > 1 ? "active level renders a frame (4x MSAA)" : "active level renders a frame");
+
+		SIMDDispatch::setLevel(SIMDLevel_SCALAR);
+		auto frameScalar = renderFrame(renderer, 96, 64, samples, draws);
+		for (int level = SIMDLevel_SSE41; level <= SIMDDispatch::maxLevel(); level++) {
+			SIMDDispatch::setLevel((SIMDLevel)level);
+			auto frame = renderFrame(renderer, 96, 64, samples, draws);
+			char name[64];
+			snprintf(name, sizeof(name), "%s matches scalar (%dx)", CPUFeatures::levelName((SIMDLevel)level), samples);
+			check(maxColorDiff(frame, frameScalar) <= 1, name);
+		}
+		SIMDDispatch::setLevel(active);
+	}
+}
+
+
+// 采样点压缩只改变多重采样颜色的存储与解析方式：同一场景开关压缩、使用特化内核或通用实现，解析结果都必须完全一致
+void testSampleCompression(RendererSoft& renderer) {
+	auto draws = createEdgeScene();
+	auto randomDraws = createRandomScene();
+	draws.insert(draws.end(), randomDraws.begin(), randomDraws.end());
+	ClearStates clearStates = colorClearStates();
+	clearStates.clearColor = glm::vec4(0.2f, 0.3f, 0.4f, 1.f);
+
+	auto frame1x = renderFrame(renderer, 96, 64, 1, draws, clearStates);
+	for (int samples : { 2, 4, 8 }) {
+		auto frameCompressed = renderFrame(renderer, 96, 64, samples, draws, clearStates);
+		renderer.setEnableSampleCompression(false);
+		auto frameUncompressed = renderFrame(renderer, 96, 64, samples, draws, clearStates);
+		renderer.setEnableSampleCompression(true);
+		renderer.setEnableRasterKernels(false);
+		auto frameGeneric = renderFrame(renderer, 96, 64, samples, draws, clearStates);
+		renderer.setEnableRasterKernels(true);
+
+		char name[64];
+		snprintf(name, sizeof(name), "%dx MSAA resolves partially covered pixels", samples);
+		check(maxColorDiff(frameCompressed, frame1x) > 0, name);
+		snprintf(name, sizeof(name), "sample compression on/off identical (%dx)", samples);
+		check(maxColorDiff(frameCompressed, frameUncompressed) == 0, name);
+		snprintf(name, sizeof(name), "generic raster path identical (%dx)", samples);
+		check(maxColorDiff(frameCompressed, frameGeneric) == 0, name);
+	}
+}
+
+// 返回两个深度缓冲中值不相同的像素数
+int depthDiffCnt(const std::shared_ptr<Buffer<float>>& a, const std::shared_ptr<Buffer<float>>& b) {
+	int diffCnt = 0;
+	for (size_t y = 0; y < a->getHeight(); y++) {
+		for (size_t x = 0; x < a->getWidth(); x++) {
+			if (*a->get(x, y) != *b->get(x, y)) {
+				diffCnt++;
+			}
+		}
+	}
+	return diffCnt;
+}
+
+// 延迟清除：只覆盖屏幕左下角的一帧（视口不是tile大小的整数倍），大部分tile从未被写入，
+// 结果需与立即清除一致，单采样时比较颜色和深度，多重采样时比较解析后的颜色。点和线段也经过待清除的tile
+void testFastClear(RendererSoft& renderer) {
+	std::vector<DrawCall> draws(1);
+	addColorTriangle(draws[0].mesh, { -0.9f, -0.95f, 0.2f }, { -0.3f, -0.8f, -0.4f }, { -0.7f, -0.2f, 0.5f },
+	                 { 0.9f, 0.6f, 0.1f });
+	draws[0].states.depthTest = true;
+	draws.push_back(createPrimitiveDraw(Primitive_LINE, { { -0.95f, 0.9f, 0.f }, { 0.1f, 0.3f, 0.f },
+	                                                      { 0.6f, -0.9f, 0.f }, { 0.95f, -0.6f, 0.f } },
+	                                    { 0.2f, 1.f, 0.3f }));
+	draws.push_back(createPrimitiveDraw(Primitive_POINT, { { 0.5f, 0.5f, 0.f }, { 0.9f, 0.95f, 0.f },
+	                                                       { -0.5f, 0.1f, 0.f } },
+	                                    { 0.1f, 0.4f, 1.f }));
+
+	ClearStates clearStates = colorClearStates();
+	clearStates.clearColor = glm::vec4(0.2f, 0.3f, 0.4f, 1.f);
+	clearStates.depthFlag = true;
+	clearStates.clearDepth = 1.f;
+
+	for (int samples : { 1, 4 }) {
+		std::shared_ptr<Buffer<float>> depthFast, depthFull;
+		auto frameFast = renderFrame(renderer, 100, 70, samples, draws, clearStates, &depthFast);
+		renderer.setEnableFastClear(false);
+		auto frameFull = renderFrame(renderer, 100, 70, samples, draws, clearStates, &depthFull);
+		renderer.setEnableFastClear(true);
+
+		char name[64];
+		snprintf(name, sizeof(name), "fast clear color identical (%dx)", samples);
+		check(maxColorDiff(frameFast, frameFull) == 0, name);
+		if (samples == 1) {
+			check(depthDiffCnt(depthFast, depthFull) == 0, "fast clear depth identical");
+		}
+	}
+}
+
+// 深度测试场景：先绘制覆盖半个屏幕的遮挡三角形，再两次绘制同一批深度倾斜的随机三角形（第二次颜色不同，
+// 用于EQUAL/LEQUAL/GEQUAL），部分三角形在遮挡物前方、部分在后方，整块剔除与逐像素测试的结果都会出现
+std::vector<DrawCall> createDepthScene(DepthFunction depthFunc) {
+	std::mt19937 rng(12);
+	std::uniform_real_distribution<float> pos(-1.1f, 1.1f);
+	std::uniform_real_distribution<float> depth(-1.f, 1.f);
+	std::uniform_real_distribution<float> color(0.f, 1.f);
+
+	std::vector<DrawCall> draws(3);
+	addColorTriangle(draws[0].mesh, { -1.f, -1.f, 0.f }, { 1.f, -1.f, 0.f }, { -1.f, 1.f, 0.f }, { 0.5f, 0.5f, 0.5f });
+	for (int i = 0; i < 48; i++) {
+		glm::vec3 p[3];
+		for (auto& v : p) {
+			v = glm::vec3(pos(rng), pos(rng), depth(rng));
+		}
+		addColorTriangle(draws[1].mesh, p[0], p[1], p[2], { color(rng), color(rng), color(rng) });
+	}
+	draws[2] = draws[1];
+	draws[2].color = glm::vec4(0.5f, 1.f, 0.5f, 1.f);
+	for (auto& draw : draws) {
+		draw.states.depthTest = true;
+		draw.states.depthFunc = depthFunc;
+	}
+	return draws;
+}
+
+// early z与分层深度剔除只是提前执行深度测试，对所有深度比较函数、深度清除为0（reverse-Z）和1时，
+// 开关后的颜色与深度都必须完全一致
+void testEarlyZ(RendererSoft& renderer) {
+	const std::pair<DepthFunction, const char*> funcs[] = {
+		{ DepthFunc_LESS, "LESS" },
+		{ DepthFunc_LEQUAL, "LEQUAL" },
+		{ DepthFunc_GREATER, "GREATER" },
+		{ DepthFunc_GEQUAL, "GEQUAL" },
+		{ DepthFunc_EQUAL, "EQUAL" },
+	};
+	for (auto& func : funcs) {
+		auto draws = createDepthScene(func.first);
+		for (float clearDepth : { 0.f, 1.f }) {
+			ClearStates clearStates = colorClearStates();
+			clearStates.depthFlag = true;
+			clearStates.clearDepth = clearDepth;
+
+			for (int samples : { 1, 4 }) {
+				std::shared_ptr<Buffer<float>> depthEarly, depthLate;
+				auto frameEarly = renderFrame(renderer, 96, 64, samples, draws, clearStates, &depthEarly);
+				renderer.setEnableEarlyZ(false);
+				auto frameLate = renderFrame(renderer, 96, 64, samples, draws, clearStates, &depthLate);
+				renderer.setEnableEarlyZ(true);
+
+				char name[80];
+				snprintf(name, sizeof(name), "early z %s, depth cleared to %g (%dx)", func.second, clearDepth, samples);
+				check(maxColorDiff(frameEarly, frameLate) == 0 && (samples > 1 || depthDiffCnt(depthEarly, depthLate) == 0),
+				      name);
+			}
+		}
+	}
+}
+
+// 线框与点模式：相邻三角形共享顶点下标，共享边（点）只应绘制一次。参考结果为按第一次出现的顺序和方向
+// 去重后的线段（点）图元，加法混合下重复绘制会使像素值不同。线段和点不做多重采样，开关MSAA结果相同
+void testWireframe(RendererSoft& renderer) {
+	const int size = 64;
+	const int cells = 4;
+	std::mt19937 rng(19);
+	std::uniform_real_distribution<float> jitter(-0.08f, 0.08f);
+
+	DrawCall mesh = createCountingDraw();
+	for (int y = 0; y <= cells; y++) {
+		for (int x = 0; x <= cells; x++) {
+			Vertex vertex{};
+			vertex.a_position = glm::vec3(-0.8f + 1.6f * (float)x / cells + jitter(rng),
+			                              -0.8f + 1.6f * (float)y / cells + jitter(rng), 0.f);
+			vertex.a_normal = glm::vec3(1.f);
+			mesh.mesh.vertexes.push_back(vertex);
+		}
+	}
+	for (int y = 0; y < cells; y++) {
+		for (int x = 0; x < cells; x++) {
+			int32_t i00 = y * (cells + 1) + x, i10 = i00 + 1, i01 = i00 + cells + 1, i11 = i01 + 1;
+			for (int32_t idx : { i00, i10, i11, i00, i11, i01 }) {
+				mesh.mesh.indices.push_back(idx);
+			}
+			mesh.mesh.primitiveCnt += 2;
+		}
+	}
+
+	DrawCall lines = createCountingDraw();
+	DrawCall points = createCountingDraw();
+	lines.mesh.primitiveType = lines.states.primitiveType = Primitive_LINE;
+	points.mesh.primitiveType = points.states.primitiveType = Primitive_POINT;
+	std::set<std::pair<int32_t, int32_t>> edges;
+	std::set<int32_t> vertexes;
+	for (size_t i = 0; i < mesh.mesh.indices.size(); i += 3) {
+		for (size_t j = 0; j < 3; j++) {
+			int32_t idx0 = mesh.mesh.indices[i + j];
+			int32_t idx1 = mesh.mesh.indices[i + (j + 1) % 3];
+			if (edges.insert({ std::min(idx0, idx1), std::max(idx0, idx1) }).second) {
+				lines.mesh.vertexes.push_back(mesh.mesh.vertexes[idx0]);
+				lines.mesh.vertexes.push_back(mesh.mesh.vertexes[idx1]);
+				lines.mesh.primitiveCnt++;
+			}
+			if (vertexes.insert(idx0).second) {
+				points.mesh.vertexes.push_back(mesh.mesh.vertexes[idx0]);
+				points.mesh.primitiveCnt++;
+			}
+		}
+	}
+	for (auto* draw : { &lines, &points }) {
+		for (size_t i = 0; i < draw->mesh.vertexes.size(); i++) {
+			draw->mesh.indices.push_back((int32_t)i);
+		}
+	}
+
+	const std::pair<PolygonMode, DrawCall*> modes[] = {
+		{ PolygonMode_LINE, &lines },
+		{ PolygonMode_POINT, &points },
+	};
+	for (auto& mode : modes) {
+		const char* modeName = mode.first == PolygonMode_LINE ? "wireframe" : "point mode";
+		std::vector<DrawCall> draws = { mesh };
+		draws[0].states.polygonMode = mode.first;
+		std::vector<DrawCall> reference = { *mode.second };
+
+		auto frame = renderFrame(renderer, size, size, 1, draws);
+		auto frameMs = renderFrame(renderer, size, size, 4, draws);
+		auto frameReference = renderFrame(renderer, size, size, 1, reference);
+		int coveredCnt = 0;
+		for (size_t i = 0; i < (size_t)size * size; i++) {
+			coveredCnt += frame->getRawDataPtr()[i][0] > 0;
+		}
+
+		char name[64];
+		snprintf(name, sizeof(name), "%s draws shared primitives once", modeName);
+		check(coveredCnt > 0 && maxColorDiff(frame, frameReference) == 0, name);
+		snprintf(name, sizeof(name), "%s unchanged with MSAA", modeName);
+		check(maxColorDiff(frame, frameMs) == 0, name);
+	}
+}
+}
+
+int main() {
+	RendererSoft renderer;
+	renderer.create();
+
+	testWatertight(renderer);
+	testTopLeftRule(renderer);
+	testSIMDLevels(renderer);
+	testSampleCompression(renderer);
+	testFastClear(renderer);
+	testEarlyZ(renderer);
+	testWireframe(renderer);
+
+	if (failedCnt > 0) {
+		printf("%d check(s) failed\n", failedCnt);
+		return 1;
+	}
+	printf("all checks passed\n");
+	return 0;
+}
@@ -0,0 +1,194 @@
+// ThreadPool任务吞吐量微基准：对比工作窃取线程池与原先单锁队列线程池
+// 基准之前先做正确性检查，失败时返回1；--check只做正确性检查
+#include <cstdio>
+#include <cstring>
+#include <vector>
+#include "../OpenGLRender/include/Base/ThreadPool.h"
+
+namespace {
+
+// 原先的实现：一个互斥锁保护一个任务队列，空闲线程yield自旋
+class LegacyThreadPool {
+public:
+	explicit LegacyThreadPool(const size_t threadCnt = std::thread::hardware_concurrency())
+		: threadCnt_(threadCnt), threads_(new std::thread[threadCnt]) {
+		for (size_t i = 0; i < threadCnt_; i++) {
+			threads_[i] = std::thread(&LegacyThreadPool::taskWorker, this, i);
+		}
+	}
+
+	~LegacyThreadPool() {
+		waitTasksFinish();
+		running_ = false;
+		for (size_t i = 0; i < threadCnt_; i++) {
+			threads_[i].join();
+		}
+	}
+
+	size_t getThreadCnt() const {
+		return threadCnt_;
+	}
+
+	template<class F>
+	void pushTask(const F& task) {
+		{
+			const std::lock_guard<std::mutex> lock(mutex_);
+			tasks_.push(std::function<void(size_t)>(task));
+		}
+		tasksCnt_++;
+	}
+
+	void waitTasksFinish() const {
+		while (tasksCnt_ != 0) {
+			std::this_thread::yield();
+		}
+	}
+
+private:
+	bool popTask(std::function<void(size_t)>& task) {
+		const std::lock_guard<std::mutex> lock(mutex_);
+		if (tasks_.empty()) {
+			return false;
+		}
+		task = std::move(tasks_.front());
+		tasks_.pop();
+		return true;
+	}
+
+	void taskWorker(size_t threadId) {
+		while (running_) {
+			std::function<void(size_t)> task;
+			if (popTask(task)) {
+				task(threadId);
+				tasksCnt_--;
+			}
+			else {
+				std::this_thread::yield();
+			}
+		}
+	}
+
+private:
+	mutable std::mutex mutex_;
+	std::atomic<bool> running_{ true };
+	size_t threadCnt_ = 0;
+	std::unique_ptr<std::thread[]> threads_;
+	std::queue<std::function<void(size_t)>> tasks_;
+	std::atomic<size_t> tasksCnt_{ 0 };
+};
+
+// 每个任务做workLoad次简单运算，workLoad=0时只衡量调度开销
+template<class Pool>
+double runBenchmark(Pool& pool, size_t taskCnt, size_t workLoad, size_t rounds) {
+	std::vector<size_t> results(pool.getThreadCnt() * 16, 0); // 每线程间隔16个元素，避免伪共享
+	auto start = std::chrono::steady_clock::now();
+	for (size_t r = 0; r < rounds; r++) {
+		for (size_t i = 0; i < taskCnt; i++) {
+			pool.pushTask([&results, i, workLoad](size_t threadId) {
+				size_t acc = i;
+				for (size_t k = 0; k < workLoad; k++) {
+					acc = acc * 1664525u + 1013904223u;
+				}
+				results[threadId * 16] += acc;
+				});
+		}
+		pool.waitTasksFinish();
+	}
+	auto end = std::chrono::steady_clock::now();
+	double seconds = std::chrono::duration<double>(end - start).count();
+	return (double)(taskCnt * rounds) / seconds;
+}
+
+// 多个线程同时提交任务，部分任务在工作线程中再提交子任务，总数超过各工作线程队列容量之和（走溢出队列）。
+// 检查每个任务恰好执行一次、线程编号有效，并且waitTasksFinish返回时所有任务都已完成
+bool checkTasksRunOnce(size_t threadCnt) {
+	const size_t producerCnt = 4;
+	const size_t tasksPerProducer = 20000;
+	const size_t nestedPerTask = 1; // 编号为偶数的任务再提交一个子任务
+	const size_t rootCnt = producerCnt * tasksPerProducer;
+	const size_t totalCnt = rootCnt + rootCnt / 2 * nestedPerTask;
+
+	std::unique_ptr<std::atomic<uint32_t>[]> runCnt(new std::atomic<uint32_t>[totalCnt]);
+	for (size_t i = 0; i < totalCnt; i++) {
+		runCnt[i] = 0;
+	}
+	std::atomic<size_t> badThreadId{ 0 };
+
+	OpenGL::ThreadPool pool(threadCnt);
+	std::vector<std::thread> producers;
+	for (size_t p = 0; p < producerCnt; p++) {
+		producers.emplace_back([&, p]() {
+			for (size_t k = 0; k < tasksPerProducer; k++) {
+				size_t id = p * tasksPerProducer + k;
+				pool.pushTask([&, id](size_t threadId) {
+					if (threadId >= threadCnt) {
+						badThreadId++;
+					}
+					runCnt[id]++;
+					if (id % 2 == 0) {
+						pool.pushTask([&, id](size_t threadId) {
+							if (threadId >= threadCnt) {
+								badThreadId++;
+							}
+							runCnt[rootCnt + id / 2]++;
+						});
+					}
+				});
+			}
+		});
+	}
+	for (auto& producer : producers) {
+		producer.join();
+	}
+	pool.waitTasksFinish();
+
+	size_t wrongCnt = 0;
+	for (size_t i = 0; i < totalCnt; i++) {
+		if (runCnt[i] != 1) {
+			wrongCnt++;
+		}
+	}
+	printf("[%s] %zu tasks on %zu threads: %zu not run exactly once, %zu bad thread ids\n",
+	       (wrongCnt == 0 && badThreadId == 0) ? "PASS" : "FAIL", totalCnt, threadCnt, wrongCnt, badThreadId.load());
+	return wrongCnt == 0 && badThreadId == 0;
+}
+
+}
+
+int main(int argc, char** argv) {
+	bool checkOnly = argc > 1 && strcmp(argv[1], "--check") == 0;
+
+	// 至少4个工作线程，单核机器上也有线程间的竞争
+	bool passed = true;
+	for (size_t threadCnt : { (size_t)1, (size_t)4, (size_t)std::max(4u, std::thread::hardware_concurrency()) }) {
+		passed = checkTasksRunOnce(threadCnt) && passed;
+	}
+	if (!passed) {
+		return 1;
+	}
+	if (checkOnly) {
+		return 0;
+	}
+
+	const size_t threadCnt = std::max(1u, std::thread::hardware_concurrency());
+	const size_t taskCnt = 100000;
+	const size_t rounds = 10;
+	const size_t workLoads[] = { 0, 64, 1024 };
+
+	printf("threads: %zu, tasks per round: %zu, rounds: %zu\n", threadCnt, taskCnt, rounds);
+	printf("%-10s %20s %20s %10s\n", "workload", "legacy (tasks/s)", "stealing (tasks/s)", "speedup");
+	for (size_t workLoad : workLoads) {
+		double legacy = 0.0;
+		double stealing = 0.0;
+		{
+			LegacyThreadPool pool(threadCnt);
+			legacy = runBenchmark(pool, taskCnt, workLoad, rounds);
+		}
+		{
+			OpenGL::ThreadPool pool(threadCnt);
+			stealing = runBenchmark(pool, taskCnt, workLoad, rounds);
+		}
+		printf("%-10zu %20.0f %20.0f %9.2fx\n", workLoad, legacy, stealing, stealing / legacy);
+	}
+	return 0;
+}